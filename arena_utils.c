@@ -0,0 +1,135 @@
+#include "arena_utils.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct arena_chunk {
+    arena_chunk *prev;
+    size_t size;
+    size_t used;
+    _Alignas(ARENA_ALIGN) char data[];
+};
+
+// Initializes an empty arena
+void arena_init(arena *a, size_t chunk_size) {
+    a->head = NULL;
+    a->spare = NULL;
+    a->chunk_size = chunk_size ? chunk_size : ARENA_DEFAULT_CHUNK;
+}
+
+// Releases every chunk owned by the arena
+void arena_free(arena *a) {
+    arena_reset_to(a, (arena_mark){NULL, 0});
+    free(a->spare);
+    a->spare = NULL;
+}
+
+// Internal helper: pushes a chunk with at least min_size bytes of room
+static arena_chunk *arena_new_chunk(arena *a, size_t min_size) {
+    arena_chunk *c;
+    if (a->spare && a->spare->size >= min_size) {
+        c = a->spare;
+        a->spare = NULL;
+    } else {
+        size_t size = min_size > a->chunk_size ? min_size : a->chunk_size;
+        if (size > SIZE_MAX - sizeof(arena_chunk)) return NULL;
+        c = malloc(sizeof(arena_chunk) + size);
+        if (!c) return NULL;
+        c->size = size;
+    }
+    c->used = 0;
+    c->prev = a->head;
+    a->head = c;
+    return c;
+}
+
+// Internal helper: offset of the first align-aligned address at or after used
+static size_t arena_aligned_offset(const arena_chunk *c, size_t align) {
+    uintptr_t addr = (uintptr_t)(c->data + c->used);
+    return c->used + ((align - addr % align) & (align - 1));
+}
+
+// Returns size bytes aligned to align, or NULL on error
+void *arena_alloc_aligned(arena *a, size_t size, size_t align) {
+    arena_chunk *c = a->head;
+    if (c) {
+        size_t start = arena_aligned_offset(c, align);
+        if (start <= c->size && size <= c->size - start) {
+            c->used = start + size;
+            return c->data + start;
+        }
+    }
+    if (size > SIZE_MAX - align) return NULL;
+    c = arena_new_chunk(a, size + align);
+    if (!c) return NULL;
+    size_t start = arena_aligned_offset(c, align);
+    c->used = start + size;
+    return c->data + start;
+}
+
+// Returns size bytes aligned to ARENA_ALIGN, or NULL on error
+void *arena_alloc(arena *a, size_t size) {
+    return arena_alloc_aligned(a, size, ARENA_ALIGN);
+}
+
+// Resizes a block with no alignment requirement
+void *arena_realloc(arena *a, void *ptr, size_t old_size, size_t new_size) {
+    return arena_realloc_aligned(a, ptr, old_size, new_size, 1);
+}
+
+// Resizes the most recent block in place when possible, otherwise copies
+// it to a new block at an align boundary
+void *arena_realloc_aligned(arena *a, void *ptr, size_t old_size, size_t new_size, size_t align) {
+    arena_chunk *c = a->head;
+    if (ptr && c && (char *)ptr + old_size == c->data + c->used) {
+        size_t start = (size_t)((char *)ptr - c->data);
+        if (new_size <= c->size - start) {
+            c->used = start + new_size;
+            return ptr;
+        }
+    }
+    if (ptr && new_size <= old_size) return ptr;
+    void *p = arena_alloc_aligned(a, new_size, align);
+    if (p && ptr) memcpy(p, ptr, old_size < new_size ? old_size : new_size);
+    return p;
+}
+
+// Returns the current allocation position
+arena_mark arena_mark_get(const arena *a) {
+    arena_mark m = {a->head, a->head ? a->head->used : 0};
+    return m;
+}
+
+// Pops chunks newer than the mark, keeping the largest one as a spare
+void arena_reset_to(arena *a, arena_mark m) {
+    while (a->head && a->head != m.chunk) {
+        arena_chunk *c = a->head;
+        a->head = c->prev;
+        if (!a->spare || c->size > a->spare->size) {
+            free(a->spare);
+            a->spare = c;
+        } else {
+            free(c);
+        }
+    }
+    if (a->head) a->head->used = m.used;
+}
+
+// Releases every allocation but keeps one chunk for reuse
+void arena_reset(arena *a) {
+    arena_reset_to(a, (arena_mark){NULL, 0});
+}
+
+// Returns the number of bytes handed out
+size_t arena_bytes_used(const arena *a) {
+    size_t total = 0;
+    for (const arena_chunk *c = a->head; c; c = c->prev) total += c->used;
+    return total;
+}
+
+// Returns the number of bytes reserved from malloc
+size_t arena_bytes_reserved(const arena *a) {
+    size_t total = a->spare ? a->spare->size : 0;
+    for (const arena_chunk *c = a->head; c; c = c->prev) total += c->size;
+    return total;
+}
@@ -0,0 +1,64 @@
+#ifndef ARENA_UTILS_H
+#define ARENA_UTILS_H
+
+#include <stddef.h>
+
+// Default chunk size used when arena_init is given 0
+#define ARENA_DEFAULT_CHUNK (64 * 1024)
+
+// Alignment of arena_alloc results
+#define ARENA_ALIGN 16
+
+typedef struct arena_chunk arena_chunk;
+
+// A bump allocator: allocations are carved from large chunks and released
+// all at once with arena_reset/arena_free or back to a mark. Not thread-safe.
+typedef struct {
+    arena_chunk *head;
+    arena_chunk *spare;
+    size_t chunk_size;
+} arena;
+
+// A saved allocation position, see arena_mark_get/arena_reset_to
+typedef struct {
+    arena_chunk *chunk;
+    size_t used;
+} arena_mark;
+
+// Initializes an empty arena; chunk_size 0 selects ARENA_DEFAULT_CHUNK
+void arena_init(arena *a, size_t chunk_size);
+
+// Releases every chunk owned by the arena
+void arena_free(arena *a);
+
+// Returns size bytes aligned to ARENA_ALIGN, or NULL on error
+void *arena_alloc(arena *a, size_t size);
+
+// Returns size bytes aligned to align (a power of two), or NULL on error
+void *arena_alloc_aligned(arena *a, size_t size, size_t align);
+
+// Resizes the block at ptr (old_size bytes, 1-aligned). Grows in place when
+// ptr is the most recent allocation and the chunk has room, otherwise copies
+// into a new block; shrinking never moves. Returns the block or NULL on error.
+void *arena_realloc(arena *a, void *ptr, size_t old_size, size_t new_size);
+
+// arena_realloc for blocks that need alignment align (a power of two): a
+// block that has to move is placed at an align boundary
+void *arena_realloc_aligned(arena *a, void *ptr, size_t old_size, size_t new_size, size_t align);
+
+// Returns the current allocation position
+arena_mark arena_mark_get(const arena *a);
+
+// Releases everything allocated after mark m
+void arena_reset_to(arena *a, arena_mark m);
+
+// Releases every allocation but keeps one chunk for reuse
+void arena_reset(arena *a);
+
+// Returns the number of bytes handed out (including alignment padding)
+size_t arena_bytes_used(const arena *a);
+
+// Returns the number of bytes reserved from malloc
+size_t arena_bytes_reserved(const arena *a);
+
+#endif // ARENA_UTILS_H
@@ -1,42 +1,1798 @@
 #include "array_utils.h"
+#include "thread_utils.h"
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 // Array utility function implementations will go here
 
-int array_sum(const int *arr, int len) {
-    int sum = 0;
-    for (int i = 0; i < len; ++i) {
-        sum += arr[i];
+// The kernels below pick AVX2 or SSE4.1 at run time, so a default build
+// still uses the widest unit the CPU has. Each has a scalar equivalent that
+// handles tails and other architectures.
+static int array_simd_limit = ARRAY_SIMD_AVX2;
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ARRAY_X86 1
+#define ARRAY_HAS_AVX2() (array_simd_limit >= ARRAY_SIMD_AVX2 && __builtin_cpu_supports("avx2"))
+#define ARRAY_HAS_SSE41() (array_simd_limit >= ARRAY_SIMD_SSE41 && __builtin_cpu_supports("sse4.1"))
+#endif
+
+// Caps the instruction set the kernels may use
+void array_set_simd_limit(int level) {
+    array_simd_limit = level;
+}
+
+// Elements per inner block of the stats pass: small enough that no 64-bit
+// lane accumulator can overflow before it is flushed
+#define ARRAY_STATS_BLOCK ((size_t)1 << 30)
+
+// Running totals of the stats pass; the squares are summed exactly
+typedef struct {
+    __int128 sum;
+    unsigned __int128 sumsq;
+    int min;
+    int max;
+} array_accum;
+
+// Internal helper: scalar wrapping sum
+static uint32_t array_sum32_scalar(const int *arr, size_t len) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < len; ++i) sum += (uint32_t)arr[i];
+    return sum;
+}
+
+// Internal helper: scalar stats pass, adding into *acc
+static void array_stats_scalar(const int *arr, size_t len, array_accum *acc) {
+    for (size_t i = 0; i < len; ++i) {
+        int64_t x = arr[i];
+        acc->sum += x;
+        acc->sumsq += (uint64_t)(x * x);
+        if (arr[i] < acc->min) acc->min = arr[i];
+        if (arr[i] > acc->max) acc->max = arr[i];
+    }
+}
+
+#ifdef ARRAY_X86
+// Internal helper: adds the four 64-bit lanes of v, wrapping around
+__attribute__((target("avx2")))
+static int64_t array_hsum64_avx2(__m256i v) {
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    return (int64_t)((uint64_t)_mm_cvtsi128_si64(s) + (uint64_t)_mm_extract_epi64(s, 1));
+}
+
+__attribute__((target("avx2")))
+static uint32_t array_sum32_avx2(const int *arr, size_t len) {
+    __m256i a0 = _mm256_setzero_si256(), a1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        a0 = _mm256_add_epi32(a0, _mm256_loadu_si256((const __m256i *)(arr + i)));
+        a1 = _mm256_add_epi32(a1, _mm256_loadu_si256((const __m256i *)(arr + i + 8)));
     }
+    __m256i a = _mm256_add_epi32(a0, a1);
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4e));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xb1));
+    return (uint32_t)_mm_cvtsi128_si32(s) + array_sum32_scalar(arr + i, len - i);
+}
+
+__attribute__((target("avx2")))
+static int64_t array_sum64_avx2(const int *arr, size_t len) {
+    __m256i a0 = _mm256_setzero_si256(), a1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(arr + i));
+        a0 = _mm256_add_epi64(a0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+        a1 = _mm256_add_epi64(a1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+    }
+    int64_t sum = array_hsum64_avx2(_mm256_add_epi64(a0, a1));
+    for (; i < len; i++) sum += arr[i];
     return sum;
 }
 
+__attribute__((target("avx2")))
+static void array_minmax_avx2(const int *arr, size_t len, int *min, int *max) {
+    __m256i vmin = _mm256_set1_epi32(*min), vmax = _mm256_set1_epi32(*max);
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(arr + i));
+        vmin = _mm256_min_epi32(vmin, x);
+        vmax = _mm256_max_epi32(vmax, x);
+    }
+    int lanes[16];
+    _mm256_storeu_si256((__m256i *)lanes, vmin);
+    _mm256_storeu_si256((__m256i *)(lanes + 8), vmax);
+    for (int k = 0; k < 8; k++) {
+        if (lanes[k] < *min) *min = lanes[k];
+        if (lanes[k + 8] > *max) *max = lanes[k + 8];
+    }
+    for (; i < len; i++) {
+        if (arr[i] < *min) *min = arr[i];
+        if (arr[i] > *max) *max = arr[i];
+    }
+}
+
+// Internal helper: the stats pass, 8 elements per step. Squares come from
+// _mm256_mul_epi32 on even and odd lanes as exact 64-bit products, whose
+// high and low halves are summed separately so neither can overflow.
+__attribute__((target("avx2")))
+static void array_stats_avx2(const int *arr, size_t len, array_accum *acc) {
+    __m256i vmin = _mm256_set1_epi32(acc->min), vmax = _mm256_set1_epi32(acc->max);
+    const __m256i low32 = _mm256_set1_epi64x(0xffffffff);
+    size_t i = 0;
+    while (i + 8 <= len) {
+        size_t end = len - (len - i) % 8;
+        if (end - i > ARRAY_STATS_BLOCK) end = i + ARRAY_STATS_BLOCK;
+        __m256i sum = _mm256_setzero_si256();
+        __m256i sq_hi = _mm256_setzero_si256(), sq_lo = _mm256_setzero_si256();
+        for (; i < end; i += 8) {
+            __m256i x = _mm256_loadu_si256((const __m256i *)(arr + i));
+            vmin = _mm256_min_epi32(vmin, x);
+            vmax = _mm256_max_epi32(vmax, x);
+            sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+            sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+            __m256i odd = _mm256_srli_epi64(x, 32);
+            __m256i pe = _mm256_mul_epi32(x, x);
+            __m256i po = _mm256_mul_epi32(odd, odd);
+            sq_hi = _mm256_add_epi64(sq_hi, _mm256_add_epi64(_mm256_srli_epi64(pe, 32), _mm256_srli_epi64(po, 32)));
+            sq_lo = _mm256_add_epi64(sq_lo, _mm256_add_epi64(_mm256_and_si256(pe, low32), _mm256_and_si256(po, low32)));
+        }
+        acc->sum += array_hsum64_avx2(sum);
+        acc->sumsq += ((unsigned __int128)(uint64_t)array_hsum64_avx2(sq_hi) << 32) +
+                      (uint64_t)array_hsum64_avx2(sq_lo);
+    }
+    int lanes[16];
+    _mm256_storeu_si256((__m256i *)lanes, vmin);
+    _mm256_storeu_si256((__m256i *)(lanes + 8), vmax);
+    for (int k = 0; k < 8; k++) {
+        if (lanes[k] < acc->min) acc->min = lanes[k];
+        if (lanes[k + 8] > acc->max) acc->max = lanes[k + 8];
+    }
+    array_stats_scalar(arr + i, len - i, acc);
+}
+
+// Internal helper: swaps lo[k] with hi[-1 - k] for 32-bit elements, 8 at a
+// time, and returns how many pairs it swapped; the ranges must not overlap
+__attribute__((target("avx2")))
+static size_t array_swap_mirror32_avx2(void *lo, void *hi, size_t count) {
+    const __m256i rev = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    char *a = lo, *b = hi;
+    size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + 4 * k));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b - 4 * (k + 8)));
+        _mm256_storeu_si256((__m256i *)(a + 4 * k), _mm256_permutevar8x32_epi32(y, rev));
+        _mm256_storeu_si256((__m256i *)(b - 4 * (k + 8)), _mm256_permutevar8x32_epi32(x, rev));
+    }
+    return k;
+}
+
+// Internal helper: the same for 64-bit elements, 4 at a time
+__attribute__((target("avx2")))
+static size_t array_swap_mirror64_avx2(void *lo, void *hi, size_t count) {
+    char *a = lo, *b = hi;
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + 8 * k));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b - 8 * (k + 4)));
+        _mm256_storeu_si256((__m256i *)(a + 8 * k), _mm256_permute4x64_epi64(y, 0x1b));
+        _mm256_storeu_si256((__m256i *)(b - 8 * (k + 4)), _mm256_permute4x64_epi64(x, 0x1b));
+    }
+    return k;
+}
+
+// SSE4.1 versions of the same kernels, 4 elements per step
+__attribute__((target("sse4.1")))
+static int64_t array_hsum64_sse41(__m128i v) {
+    return (int64_t)((uint64_t)_mm_cvtsi128_si64(v) + (uint64_t)_mm_extract_epi64(v, 1));
+}
+
+__attribute__((target("sse4.1")))
+static uint32_t array_sum32_sse41(const int *arr, size_t len) {
+    __m128i a0 = _mm_setzero_si128(), a1 = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        a0 = _mm_add_epi32(a0, _mm_loadu_si128((const __m128i *)(arr + i)));
+        a1 = _mm_add_epi32(a1, _mm_loadu_si128((const __m128i *)(arr + i + 4)));
+    }
+    __m128i s = _mm_add_epi32(a0, a1);
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4e));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xb1));
+    return (uint32_t)_mm_cvtsi128_si32(s) + array_sum32_scalar(arr + i, len - i);
+}
+
+__attribute__((target("sse4.1")))
+static int64_t array_sum64_sse41(const int *arr, size_t len) {
+    __m128i a0 = _mm_setzero_si128(), a1 = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(arr + i));
+        a0 = _mm_add_epi64(a0, _mm_cvtepi32_epi64(x));
+        a1 = _mm_add_epi64(a1, _mm_cvtepi32_epi64(_mm_unpackhi_epi64(x, x)));
+    }
+    int64_t sum = array_hsum64_sse41(_mm_add_epi64(a0, a1));
+    for (; i < len; i++) sum += arr[i];
+    return sum;
+}
+
+__attribute__((target("sse4.1")))
+static void array_minmax_sse41(const int *arr, size_t len, int *min, int *max) {
+    __m128i vmin = _mm_set1_epi32(*min), vmax = _mm_set1_epi32(*max);
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(arr + i));
+        vmin = _mm_min_epi32(vmin, x);
+        vmax = _mm_max_epi32(vmax, x);
+    }
+    int lanes[8];
+    _mm_storeu_si128((__m128i *)lanes, vmin);
+    _mm_storeu_si128((__m128i *)(lanes + 4), vmax);
+    for (int k = 0; k < 4; k++) {
+        if (lanes[k] < *min) *min = lanes[k];
+        if (lanes[k + 4] > *max) *max = lanes[k + 4];
+    }
+    for (; i < len; i++) {
+        if (arr[i] < *min) *min = arr[i];
+        if (arr[i] > *max) *max = arr[i];
+    }
+}
+
+__attribute__((target("sse4.1")))
+static void array_stats_sse41(const int *arr, size_t len, array_accum *acc) {
+    __m128i vmin = _mm_set1_epi32(acc->min), vmax = _mm_set1_epi32(acc->max);
+    const __m128i low32 = _mm_set1_epi64x(0xffffffff);
+    size_t i = 0;
+    while (i + 4 <= len) {
+        size_t end = len - (len - i) % 4;
+        if (end - i > ARRAY_STATS_BLOCK) end = i + ARRAY_STATS_BLOCK;
+        __m128i sum = _mm_setzero_si128();
+        __m128i sq_hi = _mm_setzero_si128(), sq_lo = _mm_setzero_si128();
+        for (; i < end; i += 4) {
+            __m128i x = _mm_loadu_si128((const __m128i *)(arr + i));
+            vmin = _mm_min_epi32(vmin, x);
+            vmax = _mm_max_epi32(vmax, x);
+            sum = _mm_add_epi64(sum, _mm_cvtepi32_epi64(x));
+            sum = _mm_add_epi64(sum, _mm_cvtepi32_epi64(_mm_unpackhi_epi64(x, x)));
+            __m128i odd = _mm_srli_epi64(x, 32);
+            __m128i pe = _mm_mul_epi32(x, x);
+            __m128i po = _mm_mul_epi32(odd, odd);
+            sq_hi = _mm_add_epi64(sq_hi, _mm_add_epi64(_mm_srli_epi64(pe, 32), _mm_srli_epi64(po, 32)));
+            sq_lo = _mm_add_epi64(sq_lo, _mm_add_epi64(_mm_and_si128(pe, low32), _mm_and_si128(po, low32)));
+        }
+        acc->sum += array_hsum64_sse41(sum);
+        acc->sumsq += ((unsigned __int128)(uint64_t)array_hsum64_sse41(sq_hi) << 32) +
+                      (uint64_t)array_hsum64_sse41(sq_lo);
+    }
+    int lanes[8];
+    _mm_storeu_si128((__m128i *)lanes, vmin);
+    _mm_storeu_si128((__m128i *)(lanes + 4), vmax);
+    for (int k = 0; k < 4; k++) {
+        if (lanes[k] < acc->min) acc->min = lanes[k];
+        if (lanes[k + 4] > acc->max) acc->max = lanes[k + 4];
+    }
+    array_stats_scalar(arr + i, len - i, acc);
+}
+#endif
+
+// Internal helper: wrapping sum with the best kernel available
+static uint32_t array_sum32(const int *arr, size_t len) {
+#ifdef ARRAY_X86
+    if (ARRAY_HAS_AVX2()) return array_sum32_avx2(arr, len);
+    if (ARRAY_HAS_SSE41()) return array_sum32_sse41(arr, len);
+#endif
+    return array_sum32_scalar(arr, len);
+}
+
+// Internal helper: min and max with the best kernel available
+static void array_minmax(const int *arr, size_t len, int *min, int *max) {
+#ifdef ARRAY_X86
+    if (ARRAY_HAS_AVX2()) {
+        array_minmax_avx2(arr, len, min, max);
+        return;
+    }
+    if (ARRAY_HAS_SSE41()) {
+        array_minmax_sse41(arr, len, min, max);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < len; ++i) {
+        if (arr[i] < *min) *min = arr[i];
+        if (arr[i] > *max) *max = arr[i];
+    }
+}
+
+// Internal helper: stats pass with the best kernel available
+static void array_accumulate(const int *arr, size_t len, array_accum *acc) {
+#ifdef ARRAY_X86
+    if (ARRAY_HAS_AVX2()) {
+        array_stats_avx2(arr, len, acc);
+        return;
+    }
+    if (ARRAY_HAS_SSE41()) {
+        array_stats_sse41(arr, len, acc);
+        return;
+    }
+#endif
+    array_stats_scalar(arr, len, acc);
+}
+
+int array_sum(const int *arr, int len) {
+    if (len <= 0) return 0;
+    return (int)array_sum32(arr, (size_t)len);
+}
+
 double array_average(const int *arr, int len) {
-    if (len == 0) return 0.0;
-    return (double)array_sum(arr, len) / len;
+    if (len <= 0) return 0.0;
+    return (double)array_sum64(arr, (size_t)len) / len;
 }
 
 int array_min(const int *arr, int len) {
-    if (len == 0) return 0;
-    int min = arr[0];
-    for (int i = 1; i < len; ++i) {
-        if (arr[i] < min) min = arr[i];
-    }
+    if (len <= 0) return 0;
+    int min = arr[0], max = arr[0];
+    array_minmax(arr, (size_t)len, &min, &max);
     return min;
 }
 
 int array_max(const int *arr, int len) {
-    if (len == 0) return 0;
-    int max = arr[0];
-    for (int i = 1; i < len; ++i) {
-        if (arr[i] > max) max = arr[i];
-    }
+    if (len <= 0) return 0;
+    int min = arr[0], max = arr[0];
+    array_minmax(arr, (size_t)len, &min, &max);
     return max;
 }
 
+// Vector part of a mirrored swap: pairs done by the widest kernel available
+#ifdef ARRAY_X86
+#define ARRAY_SWAP_MIRROR_VEC(bits, lo, hi, count) \
+    (ARRAY_HAS_AVX2() ? array_swap_mirror##bits##_avx2(lo, hi, count) : 0)
+#else
+#define ARRAY_SWAP_MIRROR_VEC(bits, lo, hi, count) ((size_t)0)
+#endif
+
+// Internal helper: generates name(lo, hi, count), which swaps lo[k] with
+// hi[-1 - k] for k < count on elements of type T
+#define ARRAY_DEFINE_SWAP_MIRROR(T, bits, name)                  \
+    static void name(T *lo, T *hi, size_t count) {               \
+        size_t k = ARRAY_SWAP_MIRROR_VEC(bits, lo, hi, count);   \
+        for (; k < count; k++) {                                 \
+            T tmp = lo[k];                                       \
+            lo[k] = *(hi - 1 - k);                               \
+            *(hi - 1 - k) = tmp;                                 \
+        }                                                        \
+    }
+
+ARRAY_DEFINE_SWAP_MIRROR(int, 32, array_swap_mirror)
+ARRAY_DEFINE_SWAP_MIRROR(float, 32, array_swap_mirror_f32)
+ARRAY_DEFINE_SWAP_MIRROR(int64_t, 64, array_swap_mirror_i64)
+ARRAY_DEFINE_SWAP_MIRROR(uint64_t, 64, array_swap_mirror_u64)
+ARRAY_DEFINE_SWAP_MIRROR(double, 64, array_swap_mirror_f64)
+
 void array_reverse(int *arr, int len) {
-    for (int i = 0; i < len / 2; ++i) {
-        int tmp = arr[i];
-        arr[i] = arr[len - 1 - i];
-        arr[len - 1 - i] = tmp;
+    if (len <= 1) return;
+    array_swap_mirror(arr, arr + len, (size_t)len / 2);
+}
+
+// Returns the sum of arr as a 64-bit integer
+long long array_sum64(const int *arr, size_t len) {
+#ifdef ARRAY_X86
+    if (ARRAY_HAS_AVX2()) return array_sum64_avx2(arr, len);
+    if (ARRAY_HAS_SSE41()) return array_sum64_sse41(arr, len);
+#endif
+    int64_t sum = 0;
+    for (size_t i = 0; i < len; ++i) sum += arr[i];
+    return sum;
+}
+
+// Internal helper: fills *out from the totals of len elements
+static void array_stats_finish(const array_accum *acc, size_t len, array_stats_result *out) {
+    out->sum = (long long)acc->sum;
+    out->min = acc->min;
+    out->max = acc->max;
+    out->mean = (double)acc->sum / (double)len;
+    if (len < ((size_t)1 << 31)) {
+        // n * sumsq - sum^2 fits in 128 bits here and is exact
+        __int128 num = (__int128)len * (__int128)acc->sumsq - acc->sum * acc->sum;
+        out->variance = (double)num / ((double)len * (double)len);
+    } else {
+        long double mean = (long double)acc->sum / len;
+        long double var = (long double)acc->sumsq / len - mean * mean;
+        out->variance = var > 0 ? (double)var : 0.0;
+    }
+}
+
+// Computes sum, min, max, mean and variance in a single pass
+int array_stats(const int *arr, size_t len, array_stats_result *out) {
+    memset(out, 0, sizeof(*out));
+    if (len == 0) return -1;
+    array_accum acc = {0, 0, INT_MAX, INT_MIN};
+    array_accumulate(arr, len, &acc);
+    array_stats_finish(&acc, len, out);
+    return 0;
+}
+
+// Typed kernels. The scalar min/max loops are generated from one macro;
+// the SIMD kernels are written per element type and return how many
+// leading elements they covered, leaving the tail to the scalar loop.
+
+// Internal helper: generates name(arr, len, min, max), which folds arr into
+// *min and *max. Comparisons with NaN are false, so NaNs are skipped.
+#define ARRAY_DEFINE_MINMAX_SCALAR(T, name)                          \
+    static void name(const T *arr, size_t len, T *min, T *max) {     \
+        for (size_t i = 0; i < len; ++i) {                           \
+            if (arr[i] < *min) *min = arr[i];                        \
+            if (arr[i] > *max) *max = arr[i];                        \
+        }                                                            \
+    }
+
+ARRAY_DEFINE_MINMAX_SCALAR(int64_t, array_minmax_i64_scalar)
+ARRAY_DEFINE_MINMAX_SCALAR(uint64_t, array_minmax_u64_scalar)
+ARRAY_DEFINE_MINMAX_SCALAR(float, array_minmax_f32_scalar)
+ARRAY_DEFINE_MINMAX_SCALAR(double, array_minmax_f64_scalar)
+
+#ifdef ARRAY_X86
+// Internal helper: wrapping sum of 64-bit lanes
+__attribute__((target("avx2")))
+static size_t array_sum_u64_avx2(const uint64_t *arr, size_t len, uint64_t *sum) {
+    __m256i s0 = _mm256_setzero_si256(), s1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        s0 = _mm256_add_epi64(s0, _mm256_loadu_si256((const __m256i *)(arr + i)));
+        s1 = _mm256_add_epi64(s1, _mm256_loadu_si256((const __m256i *)(arr + i + 4)));
+    }
+    *sum += (uint64_t)array_hsum64_avx2(_mm256_add_epi64(s0, s1));
+    return i;
+}
+
+// Internal helper: sum of floats, widened to double lanes
+__attribute__((target("avx2")))
+static size_t array_sum_f32_avx2(const float *arr, size_t len, double *sum) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        __m256 x = _mm256_loadu_ps(arr + i);
+        s0 = _mm256_add_pd(s0, _mm256_cvtps_pd(_mm256_castps256_ps128(x)));
+        s1 = _mm256_add_pd(s1, _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(s0, s1));
+    *sum += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t array_sum_f64_avx2(const double *arr, size_t len, double *sum) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        s0 = _mm256_add_pd(s0, _mm256_loadu_pd(arr + i));
+        s1 = _mm256_add_pd(s1, _mm256_loadu_pd(arr + i + 4));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(s0, s1));
+    *sum += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    return i;
+}
+
+// Internal helper: min and max of 64-bit lanes, compared as signed after
+// xor with bias (0, or the sign bit to order unsigned values)
+__attribute__((target("avx2")))
+static size_t array_minmax64_avx2(const void *arr, size_t len, int64_t *min, int64_t *max,
+                                  uint64_t bias) {
+    const __m256i vbias = _mm256_set1_epi64x((int64_t)bias);
+    __m256i vmin = _mm256_set1_epi64x(*min), vmax = _mm256_set1_epi64x(*max);
+    const char *p = arr;
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(p + 8 * i)), vbias);
+        vmin = _mm256_blendv_epi8(vmin, x, _mm256_cmpgt_epi64(vmin, x));
+        vmax = _mm256_blendv_epi8(vmax, x, _mm256_cmpgt_epi64(x, vmax));
+    }
+    int64_t lo[4], hi[4];
+    _mm256_storeu_si256((__m256i *)lo, vmin);
+    _mm256_storeu_si256((__m256i *)hi, vmax);
+    for (int j = 0; j < 4; j++) {
+        if (lo[j] < *min) *min = lo[j];
+        if (hi[j] > *max) *max = hi[j];
+    }
+    return i;
+}
+
+// Internal helper: float min and max; *min and *max must not be NaN. minps
+// returns its second operand when either is NaN, so NaN inputs are skipped.
+__attribute__((target("avx2")))
+static size_t array_minmax_f32_avx2(const float *arr, size_t len, float *min, float *max) {
+    __m256 vmin = _mm256_set1_ps(*min), vmax = _mm256_set1_ps(*max);
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        __m256 x = _mm256_loadu_ps(arr + i);
+        vmin = _mm256_min_ps(x, vmin);
+        vmax = _mm256_max_ps(x, vmax);
+    }
+    float lo[8], hi[8];
+    _mm256_storeu_ps(lo, vmin);
+    _mm256_storeu_ps(hi, vmax);
+    array_minmax_f32_scalar(lo, 8, min, max);
+    array_minmax_f32_scalar(hi, 8, min, max);
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t array_minmax_f64_avx2(const double *arr, size_t len, double *min, double *max) {
+    __m256d vmin = _mm256_set1_pd(*min), vmax = _mm256_set1_pd(*max);
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        __m256d x = _mm256_loadu_pd(arr + i);
+        vmin = _mm256_min_pd(x, vmin);
+        vmax = _mm256_max_pd(x, vmax);
+    }
+    double lo[4], hi[4];
+    _mm256_storeu_pd(lo, vmin);
+    _mm256_storeu_pd(hi, vmax);
+    array_minmax_f64_scalar(lo, 4, min, max);
+    array_minmax_f64_scalar(hi, 4, min, max);
+    return i;
+}
+
+// SSE4.1 versions. There is no 64-bit integer compare before SSE4.2, so
+// int64 and uint64 min/max use AVX2 or the scalar loop.
+__attribute__((target("sse4.1")))
+static size_t array_sum_u64_sse41(const uint64_t *arr, size_t len, uint64_t *sum) {
+    __m128i s0 = _mm_setzero_si128(), s1 = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        s0 = _mm_add_epi64(s0, _mm_loadu_si128((const __m128i *)(arr + i)));
+        s1 = _mm_add_epi64(s1, _mm_loadu_si128((const __m128i *)(arr + i + 2)));
+    }
+    *sum += (uint64_t)array_hsum64_sse41(_mm_add_epi64(s0, s1));
+    return i;
+}
+
+__attribute__((target("sse4.1")))
+static size_t array_sum_f32_sse41(const float *arr, size_t len, double *sum) {
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        __m128 x = _mm_loadu_ps(arr + i);
+        s0 = _mm_add_pd(s0, _mm_cvtps_pd(x));
+        s1 = _mm_add_pd(s1, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(s0, s1));
+    *sum += lanes[0] + lanes[1];
+    return i;
+}
+
+__attribute__((target("sse4.1")))
+static size_t array_sum_f64_sse41(const double *arr, size_t len, double *sum) {
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        s0 = _mm_add_pd(s0, _mm_loadu_pd(arr + i));
+        s1 = _mm_add_pd(s1, _mm_loadu_pd(arr + i + 2));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(s0, s1));
+    *sum += lanes[0] + lanes[1];
+    return i;
+}
+
+__attribute__((target("sse4.1")))
+static size_t array_minmax_f32_sse41(const float *arr, size_t len, float *min, float *max) {
+    __m128 vmin = _mm_set1_ps(*min), vmax = _mm_set1_ps(*max);
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        __m128 x = _mm_loadu_ps(arr + i);
+        vmin = _mm_min_ps(x, vmin);
+        vmax = _mm_max_ps(x, vmax);
+    }
+    float lo[4], hi[4];
+    _mm_storeu_ps(lo, vmin);
+    _mm_storeu_ps(hi, vmax);
+    array_minmax_f32_scalar(lo, 4, min, max);
+    array_minmax_f32_scalar(hi, 4, min, max);
+    return i;
+}
+
+__attribute__((target("sse4.1")))
+static size_t array_minmax_f64_sse41(const double *arr, size_t len, double *min, double *max) {
+    __m128d vmin = _mm_set1_pd(*min), vmax = _mm_set1_pd(*max);
+    size_t i = 0;
+    for (; i + 2 <= len; i += 2) {
+        __m128d x = _mm_loadu_pd(arr + i);
+        vmin = _mm_min_pd(x, vmin);
+        vmax = _mm_max_pd(x, vmax);
+    }
+    double lo[2], hi[2];
+    _mm_storeu_pd(lo, vmin);
+    _mm_storeu_pd(hi, vmax);
+    array_minmax_f64_scalar(lo, 2, min, max);
+    array_minmax_f64_scalar(hi, 2, min, max);
+    return i;
+}
+#endif
+
+// Vector part of a typed kernel: elements covered by the widest kernel
+// available; pass array_none for a type without an SSE version
+#ifdef ARRAY_X86
+#define ARRAY_TYPED_VEC(avx2, sse41, ...)                \
+    (ARRAY_HAS_AVX2()    ? avx2(__VA_ARGS__)             \
+     : ARRAY_HAS_SSE41() ? sse41(__VA_ARGS__)            \
+                         : 0)
+#define array_none(...) ((size_t)0)
+#else
+#define ARRAY_TYPED_VEC(avx2, sse41, ...) ((size_t)0)
+#endif
+
+int64_t array_sum_i32(const int32_t *arr, size_t len) {
+    return array_sum64(arr, len);
+}
+
+int64_t array_sum_i64(const int64_t *arr, size_t len) {
+    // Same bits as the unsigned sum; the conversion back wraps
+    return (int64_t)array_sum_u64((const uint64_t *)arr, len);
+}
+
+uint64_t array_sum_u64(const uint64_t *arr, size_t len) {
+    uint64_t sum = 0;
+    size_t i = ARRAY_TYPED_VEC(array_sum_u64_avx2, array_sum_u64_sse41, arr, len, &sum);
+    for (; i < len; ++i) sum += arr[i];
+    return sum;
+}
+
+double array_sum_f32(const float *arr, size_t len) {
+    double sum = 0;
+    size_t i = ARRAY_TYPED_VEC(array_sum_f32_avx2, array_sum_f32_sse41, arr, len, &sum);
+    for (; i < len; ++i) sum += arr[i];
+    return sum;
+}
+
+double array_sum_f64(const double *arr, size_t len) {
+    double sum = 0;
+    size_t i = ARRAY_TYPED_VEC(array_sum_f64_avx2, array_sum_f64_sse41, arr, len, &sum);
+    for (; i < len; ++i) sum += arr[i];
+    return sum;
+}
+
+int array_minmax_i32(const int32_t *arr, size_t len, int32_t *min, int32_t *max) {
+    if (len == 0) return -1;
+    *min = *max = arr[0];
+    array_minmax(arr, len, min, max);
+    return 0;
+}
+
+int array_minmax_i64(const int64_t *arr, size_t len, int64_t *min, int64_t *max) {
+    if (len == 0) return -1;
+    *min = *max = arr[0];
+    size_t i = ARRAY_TYPED_VEC(array_minmax64_avx2, array_none, arr, len, min, max, 0);
+    array_minmax_i64_scalar(arr + i, len - i, min, max);
+    return 0;
+}
+
+int array_minmax_u64(const uint64_t *arr, size_t len, uint64_t *min, uint64_t *max) {
+    if (len == 0) return -1;
+    const uint64_t bias = (uint64_t)1 << 63;
+    int64_t lo = (int64_t)(arr[0] ^ bias), hi = lo;
+    size_t i = ARRAY_TYPED_VEC(array_minmax64_avx2, array_none, arr, len, &lo, &hi, bias);
+    *min = (uint64_t)lo ^ bias;
+    *max = (uint64_t)hi ^ bias;
+    array_minmax_u64_scalar(arr + i, len - i, min, max);
+    return 0;
+}
+
+// Internal helper: index of the first non-NaN element, or len
+#define ARRAY_FIRST_NUMBER(arr, len, i) \
+    while ((i) < (len) && (arr)[i] != (arr)[i]) (i)++
+
+int array_minmax_f32(const float *arr, size_t len, float *min, float *max) {
+    if (len == 0) return -1;
+    size_t start = 0;
+    ARRAY_FIRST_NUMBER(arr, len, start);
+    if (start == len) {
+        *min = *max = arr[0];
+        return 0;
+    }
+    arr += start;
+    len -= start;
+    *min = *max = arr[0];
+    size_t i = ARRAY_TYPED_VEC(array_minmax_f32_avx2, array_minmax_f32_sse41, arr, len, min, max);
+    array_minmax_f32_scalar(arr + i, len - i, min, max);
+    return 0;
+}
+
+int array_minmax_f64(const double *arr, size_t len, double *min, double *max) {
+    if (len == 0) return -1;
+    size_t start = 0;
+    ARRAY_FIRST_NUMBER(arr, len, start);
+    if (start == len) {
+        *min = *max = arr[0];
+        return 0;
+    }
+    arr += start;
+    len -= start;
+    *min = *max = arr[0];
+    size_t i = ARRAY_TYPED_VEC(array_minmax_f64_avx2, array_minmax_f64_sse41, arr, len, min, max);
+    array_minmax_f64_scalar(arr + i, len - i, min, max);
+    return 0;
+}
+
+void array_reverse_i32(int32_t *arr, size_t len) {
+    if (len > 1) array_swap_mirror(arr, arr + len, len / 2);
+}
+
+void array_reverse_i64(int64_t *arr, size_t len) {
+    if (len > 1) array_swap_mirror_i64(arr, arr + len, len / 2);
+}
+
+void array_reverse_u64(uint64_t *arr, size_t len) {
+    if (len > 1) array_swap_mirror_u64(arr, arr + len, len / 2);
+}
+
+void array_reverse_f32(float *arr, size_t len) {
+    if (len > 1) array_swap_mirror_f32(arr, arr + len, len / 2);
+}
+
+void array_reverse_f64(double *arr, size_t len) {
+    if (len > 1) array_swap_mirror_f64(arr, arr + len, len / 2);
+}
+
+// Parallel variants. The input is cut into chunks of a fixed size that does
+// not depend on the thread count; each task reduces one chunk into its own
+// slot and the caller folds the slots in chunk order, so results are the
+// same however the chunks were scheduled.
+#define ARRAY_PAR_CHUNK ((size_t)1 << 18)
+
+static size_t array_par_threshold = (size_t)1 << 22;
+
+// Sets the length from which the parallel variants use the thread pool
+void array_set_parallel_threshold(size_t len) {
+    array_par_threshold = len;
+}
+
+// Returns the current parallel threshold
+size_t array_parallel_threshold(void) {
+    return array_par_threshold;
+}
+
+// Shared state of one parallel reduction
+typedef struct {
+    const int *arr;
+    int *dst;           // array_reverse_parallel: the array being reversed
+    size_t len;         // elements in the array
+    size_t count;       // elements split into chunks (len, or len / 2 pairs)
+    array_accum *parts; // one slot per chunk
+} array_par_job;
+
+// Internal helper: number of chunks for count items of a len-element array,
+// or 0 when the call should run serially
+static size_t array_par_chunks(size_t len, size_t count) {
+    if (len < array_par_threshold || count <= ARRAY_PAR_CHUNK || thread_pool_size() < 2) return 0;
+    return (count + ARRAY_PAR_CHUNK - 1) / ARRAY_PAR_CHUNK;
+}
+
+// Internal helper: bounds of chunk i
+static size_t array_par_span(const array_par_job *job, size_t i, size_t *start) {
+    *start = i * ARRAY_PAR_CHUNK;
+    size_t n = job->count - *start;
+    return n < ARRAY_PAR_CHUNK ? n : ARRAY_PAR_CHUNK;
+}
+
+// Internal helper: task summing one chunk
+static void array_par_sum_task(void *ctx, size_t i) {
+    array_par_job *job = ctx;
+    size_t start, n = array_par_span(job, i, &start);
+    job->parts[i].sum = array_sum64(job->arr + start, n);
+}
+
+// Internal helper: task finding the min and max of one chunk
+static void array_par_minmax_task(void *ctx, size_t i) {
+    array_par_job *job = ctx;
+    size_t start, n = array_par_span(job, i, &start);
+    array_accum *part = &job->parts[i];
+    part->min = part->max = job->arr[start];
+    array_minmax(job->arr + start, n, &part->min, &part->max);
+}
+
+// Internal helper: task running the stats pass over one chunk
+static void array_par_stats_task(void *ctx, size_t i) {
+    array_par_job *job = ctx;
+    size_t start, n = array_par_span(job, i, &start);
+    array_accum *part = &job->parts[i];
+    *part = (array_accum){0, 0, INT_MAX, INT_MIN};
+    array_accumulate(job->arr + start, n, part);
+}
+
+// Internal helper: task swapping one chunk of the first half with its mirror
+static void array_par_reverse_task(void *ctx, size_t i) {
+    array_par_job *job = ctx;
+    size_t start, n = array_par_span(job, i, &start);
+    array_swap_mirror(job->dst + start, job->dst + job->len - start, n);
+}
+
+// Internal helper: runs fn over all chunks and returns the per-chunk slots,
+// or NULL (having done nothing) when the call should run serially
+static array_accum *array_par_run(const int *arr, size_t len, void (*fn)(void *, size_t)) {
+    size_t chunks = array_par_chunks(len, len);
+    if (chunks == 0) return NULL;
+    array_accum *parts = malloc(chunks * sizeof(*parts));
+    if (!parts) return NULL;
+    array_par_job job = {arr, NULL, len, len, parts};
+    thread_parallel_for(chunks, fn, &job);
+    return parts;
+}
+
+// Returns the 64-bit sum, splitting large arrays across the thread pool
+long long array_sum64_parallel(const int *arr, size_t len) {
+    array_accum *parts = array_par_run(arr, len, array_par_sum_task);
+    if (!parts) return array_sum64(arr, len);
+    __int128 sum = 0;
+    for (size_t i = 0, chunks = array_par_chunks(len, len); i < chunks; i++) sum += parts[i].sum;
+    free(parts);
+    return (long long)sum;
+}
+
+// Finds min and max, splitting large arrays across the thread pool
+int array_minmax_parallel(const int *arr, size_t len, int *min, int *max) {
+    if (len == 0) return -1;
+    int lo = arr[0], hi = arr[0];
+    array_accum *parts = array_par_run(arr, len, array_par_minmax_task);
+    if (!parts) {
+        array_minmax(arr, len, &lo, &hi);
+    } else {
+        for (size_t i = 0, chunks = array_par_chunks(len, len); i < chunks; i++) {
+            if (parts[i].min < lo) lo = parts[i].min;
+            if (parts[i].max > hi) hi = parts[i].max;
+        }
+        free(parts);
+    }
+    *min = lo;
+    *max = hi;
+    return 0;
+}
+
+// array_stats, splitting large arrays across the thread pool
+int array_stats_parallel(const int *arr, size_t len, array_stats_result *out) {
+    array_accum *parts = array_par_run(arr, len, array_par_stats_task);
+    if (!parts) return array_stats(arr, len, out);
+    array_accum acc = {0, 0, INT_MAX, INT_MIN};
+    for (size_t i = 0, chunks = array_par_chunks(len, len); i < chunks; i++) {
+        acc.sum += parts[i].sum;
+        acc.sumsq += parts[i].sumsq;
+        if (parts[i].min < acc.min) acc.min = parts[i].min;
+        if (parts[i].max > acc.max) acc.max = parts[i].max;
+    }
+    free(parts);
+    memset(out, 0, sizeof(*out));
+    array_stats_finish(&acc, len, out);
+    return 0;
+}
+
+// Reverses arr in place, splitting large arrays across the thread pool
+void array_reverse_parallel(int *arr, size_t len) {
+    size_t chunks = array_par_chunks(len, len / 2);
+    if (chunks == 0) {
+        if (len > 1) array_swap_mirror(arr, arr + len, len / 2);
+        return;
+    }
+    array_par_job job = {arr, arr, len, len / 2, NULL};
+    thread_parallel_for(chunks, array_par_reverse_task, &job);
+}
+
+// Sorting. The radix sorts are LSD with 11-bit digits (3 passes for 32-bit
+// keys, 6 for 64-bit). Signed keys flip the sign bit while extracting
+// digits, so no separate transform pass is needed. All digit histograms
+// come from one read of the input, and a pass whose digit is the same for
+// every key is skipped.
+#define ARRAY_RADIX_BITS 11
+#define ARRAY_RADIX_SIZE (1 << ARRAY_RADIX_BITS)
+#define ARRAY_RADIX_SMALL 64
+
+// Internal helper: generates name(arr, len, bias), an LSD radix sort of
+// unsigned T keys ordered as key ^ bias. Returns 0, or -1 if out of memory.
+#define ARRAY_DEFINE_RADIX_SORT(T, passes, name)                                  \
+    static int name(T *arr, size_t len, T bias) {                                 \
+        const T mask = ARRAY_RADIX_SIZE - 1;                                      \
+        if (len < ARRAY_RADIX_SMALL) {                                            \
+            for (size_t i = 1; i < len; i++) {                                    \
+                T x = arr[i];                                                     \
+                size_t j = i;                                                     \
+                for (; j > 0 && (arr[j - 1] ^ bias) > (x ^ bias); j--)            \
+                    arr[j] = arr[j - 1];                                          \
+                arr[j] = x;                                                       \
+            }                                                                     \
+            return 0;                                                             \
+        }                                                                         \
+        T *tmp = malloc(len * sizeof(T));                                         \
+        size_t (*count)[ARRAY_RADIX_SIZE] = calloc(passes, sizeof(*count));       \
+        if (!tmp || !count) {                                                     \
+            free(tmp);                                                            \
+            free(count);                                                          \
+            return -1;                                                            \
+        }                                                                         \
+        for (size_t i = 0; i < len; i++) {                                        \
+            T k = arr[i] ^ bias;                                                  \
+            for (int p = 0; p < (passes); p++)                                    \
+                count[p][(k >> (p * ARRAY_RADIX_BITS)) & mask]++;                 \
+        }                                                                         \
+        T *src = arr, *dst = tmp;                                                 \
+        for (int p = 0; p < (passes); p++) {                                      \
+            int shift = p * ARRAY_RADIX_BITS;                                     \
+            size_t *c = count[p];                                                 \
+            if (c[((src[0] ^ bias) >> shift) & mask] == len) continue;            \
+            size_t off = 0;                                                       \
+            for (size_t d = 0; d < ARRAY_RADIX_SIZE; d++) {                       \
+                size_t n = c[d];                                                  \
+                c[d] = off;                                                       \
+                off += n;                                                         \
+            }                                                                     \
+            for (size_t i = 0; i < len; i++)                                      \
+                dst[c[((src[i] ^ bias) >> shift) & mask]++] = src[i];             \
+            T *t = src;                                                           \
+            src = dst;                                                            \
+            dst = t;                                                              \
+        }                                                                         \
+        if (src != arr) memcpy(arr, src, len * sizeof(T));                        \
+        free(tmp);                                                                \
+        free(count);                                                              \
+        return 0;                                                                 \
+    }
+
+ARRAY_DEFINE_RADIX_SORT(uint32_t, 3, array_radix_sort32)
+ARRAY_DEFINE_RADIX_SORT(uint64_t, 6, array_radix_sort64)
+
+int array_radix_sort_i32(int32_t *arr, size_t len) {
+    return array_radix_sort32((uint32_t *)arr, len, (uint32_t)1 << 31);
+}
+
+int array_radix_sort_u32(uint32_t *arr, size_t len) {
+    return array_radix_sort32(arr, len, 0);
+}
+
+int array_radix_sort_i64(int64_t *arr, size_t len) {
+    return array_radix_sort64((uint64_t *)arr, len, (uint64_t)1 << 63);
+}
+
+int array_radix_sort_u64(uint64_t *arr, size_t len) {
+    return array_radix_sort64(arr, len, 0);
+}
+
+// Pattern-defeating quicksort (after Orson Peters' pdqsort): median-of-3
+// pivots (ninther above 128 elements), insertion sort for small ranges, a
+// partition that groups runs of equal keys, an early exit for ranges that
+// are already sorted, and heapsort once too many partitions come out badly
+// unbalanced, which bounds the worst case at O(n log n).
+#define ARRAY_PDQ_INSERTION 24
+#define ARRAY_PDQ_NINTHER 128
+#define ARRAY_PDQ_PARTIAL_LIMIT 8
+
+// State shared by one array_sort call
+typedef struct {
+    size_t size;
+    int (*cmp)(const void *, const void *);
+    char *pivot;    // copy of the current pivot
+    char *tmp;      // element being inserted
+} array_pdq;
+
+// Internal helper: swaps two elements
+static inline void array_pdq_swap(char *a, char *b, size_t size) {
+    if (size == 4) {
+        uint32_t t;
+        memcpy(&t, a, 4);
+        memcpy(a, b, 4);
+        memcpy(b, &t, 4);
+    } else if (size == 8) {
+        uint64_t t;
+        memcpy(&t, a, 8);
+        memcpy(a, b, 8);
+        memcpy(b, &t, 8);
+    } else {
+        char t[64];
+        while (size > 0) {
+            size_t n = size < sizeof(t) ? size : sizeof(t);
+            memcpy(t, a, n);
+            memcpy(a, b, n);
+            memcpy(b, t, n);
+            a += n;
+            b += n;
+            size -= n;
+        }
+    }
+}
+
+// Internal helper: cmp(a, b) < 0
+static inline int array_pdq_less(const array_pdq *s, const char *a, const char *b) {
+    return s->cmp(a, b) < 0;
+}
+
+// Internal helper: insertion sort of [begin, end); with a limit, gives up
+// and returns 0 once more than limit elements have been moved
+static int array_pdq_insertion(const array_pdq *s, char *begin, char *end, size_t limit) {
+    size_t size = s->size, moved = 0;
+    if (begin == end) return 1;
+    for (char *cur = begin + size; cur < end; cur += size) {
+        if (!array_pdq_less(s, cur, cur - size)) continue;
+        char *hole = cur;
+        memcpy(s->tmp, cur, size);
+        do {
+            memcpy(hole, hole - size, size);
+            hole -= size;
+        } while (hole > begin && array_pdq_less(s, s->tmp, hole - size));
+        memcpy(hole, s->tmp, size);
+        moved += (size_t)(cur - hole) / size;
+        if (limit && moved > limit) return 0;
+    }
+    return 1;
+}
+
+// Internal helper: orders *a <= *b
+static inline void array_pdq_sort2(const array_pdq *s, char *a, char *b) {
+    if (array_pdq_less(s, b, a)) array_pdq_swap(a, b, s->size);
+}
+
+// Internal helper: orders *a <= *b <= *c
+static void array_pdq_sort3(const array_pdq *s, char *a, char *b, char *c) {
+    array_pdq_sort2(s, a, b);
+    array_pdq_sort2(s, b, c);
+    array_pdq_sort2(s, a, b);
+}
+
+// Internal helper: heapsort fallback for [begin, begin + n)
+static void array_pdq_heapsort(const array_pdq *s, char *begin, size_t n) {
+    size_t size = s->size;
+    for (size_t end = n, start = n / 2;;) {
+        if (start > 0) {
+            start--;
+        } else {
+            if (--end == 0) return;
+            array_pdq_swap(begin, begin + end * size, size);
+        }
+        size_t root = start;
+        for (size_t child; (child = 2 * root + 1) < end; root = child) {
+            if (child + 1 < end && array_pdq_less(s, begin + child * size, begin + (child + 1) * size))
+                child++;
+            if (!array_pdq_less(s, begin + root * size, begin + child * size)) break;
+            array_pdq_swap(begin + root * size, begin + child * size, size);
+        }
+    }
+}
+
+// Internal helper: partitions [begin, end) around the pivot at *begin, with
+// elements equal to it going right. Needs an element >= pivot at the end.
+// Returns the pivot's final position; *sorted is set if nothing moved.
+static char *array_pdq_partition_right(const array_pdq *s, char *begin, char *end, int *sorted) {
+    size_t size = s->size;
+    memcpy(s->pivot, begin, size);
+    char *first = begin, *last = end;
+    do first += size; while (array_pdq_less(s, first, s->pivot));
+    if (first - size == begin) {
+        while (first < last) {
+            last -= size;
+            if (array_pdq_less(s, last, s->pivot)) break;
+        }
+    } else {
+        do last -= size; while (!array_pdq_less(s, last, s->pivot));
+    }
+    *sorted = first >= last;
+    while (first < last) {
+        array_pdq_swap(first, last, size);
+        do first += size; while (array_pdq_less(s, first, s->pivot));
+        do last -= size; while (!array_pdq_less(s, last, s->pivot));
+    }
+    char *pivot_pos = first - size;
+    memcpy(begin, pivot_pos, size);
+    memcpy(pivot_pos, s->pivot, size);
+    return pivot_pos;
+}
+
+// Internal helper: partitions with elements equal to the pivot going left;
+// used when the pivot equals the element before the range, so the whole
+// run of equal keys is finished in one step
+static char *array_pdq_partition_left(const array_pdq *s, char *begin, char *end) {
+    size_t size = s->size;
+    memcpy(s->pivot, begin, size);
+    char *first = begin, *last = end;
+    do last -= size; while (array_pdq_less(s, s->pivot, last));
+    if (last + size == end) {
+        while (first < last) {
+            first += size;
+            if (array_pdq_less(s, s->pivot, first)) break;
+        }
+    } else {
+        do first += size; while (!array_pdq_less(s, s->pivot, first));
+    }
+    while (first < last) {
+        array_pdq_swap(first, last, size);
+        do last -= size; while (array_pdq_less(s, s->pivot, last));
+        do first += size; while (!array_pdq_less(s, s->pivot, first));
+    }
+    memcpy(begin, last, size);
+    memcpy(last, s->pivot, size);
+    return last;
+}
+
+// Internal helper: sorts [begin, end); leftmost is false when the element
+// before begin exists and is <= every element of the range
+static void array_pdq_loop(const array_pdq *s, char *begin, char *end, int bad_allowed, int leftmost) {
+    size_t size = s->size;
+    for (;;) {
+        size_t n = (size_t)(end - begin) / size;
+        if (n < ARRAY_PDQ_INSERTION) {
+            array_pdq_insertion(s, begin, end, 0);
+            return;
+        }
+        size_t half = n / 2;
+        char *mid = begin + half * size;
+        if (n > ARRAY_PDQ_NINTHER) {
+            array_pdq_sort3(s, begin, mid, end - size);
+            array_pdq_sort3(s, begin + size, mid - size, end - 2 * size);
+            array_pdq_sort3(s, begin + 2 * size, mid + size, end - 3 * size);
+            array_pdq_sort3(s, mid - size, mid, mid + size);
+            array_pdq_swap(begin, mid, size);
+        } else {
+            array_pdq_sort3(s, mid, begin, end - size);
+        }
+        if (!leftmost && !array_pdq_less(s, begin - size, begin)) {
+            begin = array_pdq_partition_left(s, begin, end) + size;
+            continue;
+        }
+        int sorted;
+        char *pivot_pos = array_pdq_partition_right(s, begin, end, &sorted);
+        size_t l = (size_t)(pivot_pos - begin) / size;
+        size_t r = n - l - 1;
+        if (l < n / 8 || r < n / 8) {
+            if (--bad_allowed == 0) {
+                array_pdq_heapsort(s, begin, n);
+                return;
+            }
+            // Shuffle a few elements to break the pattern that caused it
+            if (l >= ARRAY_PDQ_INSERTION) {
+                array_pdq_swap(begin, begin + l / 4 * size, size);
+                array_pdq_swap(pivot_pos - size, pivot_pos - l / 4 * size, size);
+                if (l > ARRAY_PDQ_NINTHER) {
+                    array_pdq_swap(begin + size, begin + (l / 4 + 1) * size, size);
+                    array_pdq_swap(begin + 2 * size, begin + (l / 4 + 2) * size, size);
+                    array_pdq_swap(pivot_pos - 2 * size, pivot_pos - (l / 4 + 1) * size, size);
+                    array_pdq_swap(pivot_pos - 3 * size, pivot_pos - (l / 4 + 2) * size, size);
+                }
+            }
+            if (r >= ARRAY_PDQ_INSERTION) {
+                array_pdq_swap(pivot_pos + size, pivot_pos + (1 + r / 4) * size, size);
+                array_pdq_swap(end - size, end - r / 4 * size, size);
+                if (r > ARRAY_PDQ_NINTHER) {
+                    array_pdq_swap(pivot_pos + 2 * size, pivot_pos + (2 + r / 4) * size, size);
+                    array_pdq_swap(pivot_pos + 3 * size, pivot_pos + (3 + r / 4) * size, size);
+                    array_pdq_swap(end - 2 * size, end - (1 + r / 4) * size, size);
+                    array_pdq_swap(end - 3 * size, end - (2 + r / 4) * size, size);
+                }
+            }
+        } else if (sorted &&
+                   array_pdq_insertion(s, begin, pivot_pos, ARRAY_PDQ_PARTIAL_LIMIT) &&
+                   array_pdq_insertion(s, pivot_pos + size, end, ARRAY_PDQ_PARTIAL_LIMIT)) {
+            return;
+        }
+        array_pdq_loop(s, begin, pivot_pos, bad_allowed, leftmost);
+        begin = pivot_pos + size;
+        leftmost = 0;
+    }
+}
+
+// Sorts n elements of the given size with a qsort-style comparator
+int array_sort(void *base, size_t n, size_t size, int (*cmp)(const void *, const void *)) {
+    if (n < 2 || size == 0) return 0;
+    char stack_buf[2 * 128];
+    char *buf = size <= 128 ? stack_buf : malloc(2 * size);
+    if (!buf) return -1;
+    array_pdq s = {size, cmp, buf, buf + size};
+    int bad_allowed = 1;
+    while (n >> bad_allowed) bad_allowed++;
+    array_pdq_loop(&s, base, (char *)base + n * size, bad_allowed, 1);
+    if (buf != stack_buf) free(buf);
+    return 0;
+}
+
+// Searching. The bounds keep the loop free of unpredictable branches: the
+// range halves every step and a conditional move picks the half, so the
+// cost is log2(len) dependent loads with no mispredictions.
+#define ARRAY_DEFINE_BOUND(T, name, less)                          \
+    size_t name(const T *arr, size_t len, T key) {                 \
+        if (len == 0) return 0;                                    \
+        const T *base = arr;                                       \
+        while (len > 1) {                                          \
+            size_t half = len / 2;                                 \
+            base = less(base[half], key) ? base + half : base;     \
+            len -= half;                                           \
+        }                                                          \
+        return (size_t)(base - arr) + less(*base, key);            \
+    }
+
+#define ARRAY_LESS(a, b) ((a) < (b))
+#define ARRAY_NOT_GREATER(a, b) (!((b) < (a)))
+
+ARRAY_DEFINE_BOUND(int32_t, array_lower_bound_i32, ARRAY_LESS)
+ARRAY_DEFINE_BOUND(int32_t, array_upper_bound_i32, ARRAY_NOT_GREATER)
+ARRAY_DEFINE_BOUND(int64_t, array_lower_bound_i64, ARRAY_LESS)
+ARRAY_DEFINE_BOUND(int64_t, array_upper_bound_i64, ARRAY_NOT_GREATER)
+
+// Internal helper: writes sorted[*i...] into the Eytzinger slots below k
+// in order, returning the next sorted index
+static size_t array_eytz_fill(array_eytz *t, const int32_t *sorted, size_t i, size_t k) {
+    if (k <= t->len) {
+        i = array_eytz_fill(t, sorted, i, 2 * k);
+        t->keys[k] = sorted[i];
+        t->rank[k] = i++;
+        i = array_eytz_fill(t, sorted, i, 2 * k + 1);
+    }
+    return i;
+}
+
+// Builds an Eytzinger layout of a sorted array
+int array_eytz_init(array_eytz *t, const int32_t *sorted, size_t len) {
+    t->len = len;
+    t->keys = aligned_alloc(64, ((len + 1) * sizeof(int32_t) + 63) & ~(size_t)63);
+    t->rank = malloc((len + 1) * sizeof(size_t));
+    if (!t->keys || !t->rank) {
+        array_eytz_free(t);
+        return -1;
+    }
+    t->keys[0] = 0;
+    t->rank[0] = len;
+    array_eytz_fill(t, sorted, 0, 1);
+    return 0;
+}
+
+// Releases the layout
+void array_eytz_free(array_eytz *t) {
+    free(t->keys);
+    free(t->rank);
+    t->keys = NULL;
+    t->rank = NULL;
+    t->len = 0;
+}
+
+// Returns the index in the sorted array of the first element >= key
+size_t array_eytz_lower_bound(const array_eytz *t, int32_t key) {
+    size_t k = 1;
+    while (k <= t->len) {
+        // The descendants four levels down share one cache line
+        __builtin_prefetch(t->keys + 16 * k);
+        k = 2 * k + (t->keys[k] < key);
+    }
+    // Drop the trailing right turns and the left turn above them
+    k >>= __builtin_ffsll((long long)~k);
+    return t->rank[k];
+}
+
+// Scans and partitions. Each has an AVX2 kernel and a scalar loop; above
+// the parallel threshold the input is cut into ARRAY_PAR_CHUNK blocks and
+// processed in two passes: one computing per-block totals (sums or match
+// counts), then, after a serial prefix over the blocks, one writing every
+// block at its final offset.
+
+#ifdef ARRAY_X86
+// Lane indices that move the set lanes of an 8-bit mask to the front, one
+// byte per lane
+static const uint64_t array_compress_perm[256] = {
+    0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000001ULL, 0x0000000000000100ULL,
+    0x0000000000000002ULL, 0x0000000000000200ULL, 0x0000000000000201ULL, 0x0000000000020100ULL,
+    0x0000000000000003ULL, 0x0000000000000300ULL, 0x0000000000000301ULL, 0x0000000000030100ULL,
+    0x0000000000000302ULL, 0x0000000000030200ULL, 0x0000000000030201ULL, 0x0000000003020100ULL,
+    0x0000000000000004ULL, 0x0000000000000400ULL, 0x0000000000000401ULL, 0x0000000000040100ULL,
+    0x0000000000000402ULL, 0x0000000000040200ULL, 0x0000000000040201ULL, 0x0000000004020100ULL,
+    0x0000000000000403ULL, 0x0000000000040300ULL, 0x0000000000040301ULL, 0x0000000004030100ULL,
+    0x0000000000040302ULL, 0x0000000004030200ULL, 0x0000000004030201ULL, 0x0000000403020100ULL,
+    0x0000000000000005ULL, 0x0000000000000500ULL, 0x0000000000000501ULL, 0x0000000000050100ULL,
+    0x0000000000000502ULL, 0x0000000000050200ULL, 0x0000000000050201ULL, 0x0000000005020100ULL,
+    0x0000000000000503ULL, 0x0000000000050300ULL, 0x0000000000050301ULL, 0x0000000005030100ULL,
+    0x0000000000050302ULL, 0x0000000005030200ULL, 0x0000000005030201ULL, 0x0000000503020100ULL,
+    0x0000000000000504ULL, 0x0000000000050400ULL, 0x0000000000050401ULL, 0x0000000005040100ULL,
+    0x0000000000050402ULL, 0x0000000005040200ULL, 0x0000000005040201ULL, 0x0000000504020100ULL,
+    0x0000000000050403ULL, 0x0000000005040300ULL, 0x0000000005040301ULL, 0x0000000504030100ULL,
+    0x0000000005040302ULL, 0x0000000504030200ULL, 0x0000000504030201ULL, 0x0000050403020100ULL,
+    0x0000000000000006ULL, 0x0000000000000600ULL, 0x0000000000000601ULL, 0x0000000000060100ULL,
+    0x0000000000000602ULL, 0x0000000000060200ULL, 0x0000000000060201ULL, 0x0000000006020100ULL,
+    0x0000000000000603ULL, 0x0000000000060300ULL, 0x0000000000060301ULL, 0x0000000006030100ULL,
+    0x0000000000060302ULL, 0x0000000006030200ULL, 0x0000000006030201ULL, 0x0000000603020100ULL,
+    0x0000000000000604ULL, 0x0000000000060400ULL, 0x0000000000060401ULL, 0x0000000006040100ULL,
+    0x0000000000060402ULL, 0x0000000006040200ULL, 0x0000000006040201ULL, 0x0000000604020100ULL,
+    0x0000000000060403ULL, 0x0000000006040300ULL, 0x0000000006040301ULL, 0x0000000604030100ULL,
+    0x0000000006040302ULL, 0x0000000604030200ULL, 0x0000000604030201ULL, 0x0000060403020100ULL,
+    0x0000000000000605ULL, 0x0000000000060500ULL, 0x0000000000060501ULL, 0x0000000006050100ULL,
+    0x0000000000060502ULL, 0x0000000006050200ULL, 0x0000000006050201ULL, 0x0000000605020100ULL,
+    0x0000000000060503ULL, 0x0000000006050300ULL, 0x0000000006050301ULL, 0x0000000605030100ULL,
+    0x0000000006050302ULL, 0x0000000605030200ULL, 0x0000000605030201ULL, 0x0000060503020100ULL,
+    0x0000000000060504ULL, 0x0000000006050400ULL, 0x0000000006050401ULL, 0x0000000605040100ULL,
+    0x0000000006050402ULL, 0x0000000605040200ULL, 0x0000000605040201ULL, 0x0000060504020100ULL,
+    0x0000000006050403ULL, 0x0000000605040300ULL, 0x0000000605040301ULL, 0x0000060504030100ULL,
+    0x0000000605040302ULL, 0x0000060504030200ULL, 0x0000060504030201ULL, 0x0006050403020100ULL,
+    0x0000000000000007ULL, 0x0000000000000700ULL, 0x0000000000000701ULL, 0x0000000000070100ULL,
+    0x0000000000000702ULL, 0x0000000000070200ULL, 0x0000000000070201ULL, 0x0000000007020100ULL,
+    0x0000000000000703ULL, 0x0000000000070300ULL, 0x0000000000070301ULL, 0x0000000007030100ULL,
+    0x0000000000070302ULL, 0x0000000007030200ULL, 0x0000000007030201ULL, 0x0000000703020100ULL,
+    0x0000000000000704ULL, 0x0000000000070400ULL, 0x0000000000070401ULL, 0x0000000007040100ULL,
+    0x0000000000070402ULL, 0x0000000007040200ULL, 0x0000000007040201ULL, 0x0000000704020100ULL,
+    0x0000000000070403ULL, 0x0000000007040300ULL, 0x0000000007040301ULL, 0x0000000704030100ULL,
+    0x0000000007040302ULL, 0x0000000704030200ULL, 0x0000000704030201ULL, 0x0000070403020100ULL,
+    0x0000000000000705ULL, 0x0000000000070500ULL, 0x0000000000070501ULL, 0x0000000007050100ULL,
+    0x0000000000070502ULL, 0x0000000007050200ULL, 0x0000000007050201ULL, 0x0000000705020100ULL,
+    0x0000000000070503ULL, 0x0000000007050300ULL, 0x0000000007050301ULL, 0x0000000705030100ULL,
+    0x0000000007050302ULL, 0x0000000705030200ULL, 0x0000000705030201ULL, 0x0000070503020100ULL,
+    0x0000000000070504ULL, 0x0000000007050400ULL, 0x0000000007050401ULL, 0x0000000705040100ULL,
+    0x0000000007050402ULL, 0x0000000705040200ULL, 0x0000000705040201ULL, 0x0000070504020100ULL,
+    0x0000000007050403ULL, 0x0000000705040300ULL, 0x0000000705040301ULL, 0x0000070504030100ULL,
+    0x0000000705040302ULL, 0x0000070504030200ULL, 0x0000070504030201ULL, 0x0007050403020100ULL,
+    0x0000000000000706ULL, 0x0000000000070600ULL, 0x0000000000070601ULL, 0x0000000007060100ULL,
+    0x0000000000070602ULL, 0x0000000007060200ULL, 0x0000000007060201ULL, 0x0000000706020100ULL,
+    0x0000000000070603ULL, 0x0000000007060300ULL, 0x0000000007060301ULL, 0x0000000706030100ULL,
+    0x0000000007060302ULL, 0x0000000706030200ULL, 0x0000000706030201ULL, 0x0000070603020100ULL,
+    0x0000000000070604ULL, 0x0000000007060400ULL, 0x0000000007060401ULL, 0x0000000706040100ULL,
+    0x0000000007060402ULL, 0x0000000706040200ULL, 0x0000000706040201ULL, 0x0000070604020100ULL,
+    0x0000000007060403ULL, 0x0000000706040300ULL, 0x0000000706040301ULL, 0x0000070604030100ULL,
+    0x0000000706040302ULL, 0x0000070604030200ULL, 0x0000070604030201ULL, 0x0007060403020100ULL,
+    0x0000000000070605ULL, 0x0000000007060500ULL, 0x0000000007060501ULL, 0x0000000706050100ULL,
+    0x0000000007060502ULL, 0x0000000706050200ULL, 0x0000000706050201ULL, 0x0000070605020100ULL,
+    0x0000000007060503ULL, 0x0000000706050300ULL, 0x0000000706050301ULL, 0x0000070605030100ULL,
+    0x0000000706050302ULL, 0x0000070605030200ULL, 0x0000070605030201ULL, 0x0007060503020100ULL,
+    0x0000000007060504ULL, 0x0000000706050400ULL, 0x0000000706050401ULL, 0x0000070605040100ULL,
+    0x0000000706050402ULL, 0x0000070605040200ULL, 0x0000070605040201ULL, 0x0007060504020100ULL,
+    0x0000000706050403ULL, 0x0000070605040300ULL, 0x0000070605040301ULL, 0x0007060504030100ULL,
+    0x0000070605040302ULL, 0x0007060504030200ULL, 0x0007060504030201ULL, 0x0706050403020100ULL,
+};
+
+// Internal helper: stores the lanes of x selected by mask contiguously at
+// dst, writing nothing else; returns how many were stored
+__attribute__((target("avx2,popcnt")))
+static inline size_t array_store_compressed(int32_t *dst, __m256i x, unsigned mask) {
+    __m256i perm = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128((long long)array_compress_perm[mask]));
+    int n = __builtin_popcount(mask);
+    __m256i lanes = _mm256_cmpgt_epi32(_mm256_set1_epi32(n), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    _mm256_maskstore_epi32((int *)dst, lanes, _mm256_permutevar8x32_epi32(x, perm));
+    return (size_t)n;
+}
+
+// Internal helper: 8-bit mask of the lanes of x inside [lo, hi]
+__attribute__((target("avx2")))
+static inline unsigned array_range_mask(__m256i x, __m256i lo, __m256i hi) {
+    __m256i out = _mm256_or_si256(_mm256_cmpgt_epi32(lo, x), _mm256_cmpgt_epi32(x, hi));
+    return ~(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(out)) & 0xff;
+}
+
+// Internal helper: scan of 32-bit lanes continuing from *carry
+__attribute__((target("avx2")))
+static size_t array_scan32_avx2(const int32_t *src, int32_t *dst, size_t len, uint32_t *carry,
+                                int inclusive) {
+    __m256i c = _mm256_set1_epi32((int)*carry);
+    const __m256i last = _mm256_set1_epi32(7);
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i s = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+        s = _mm256_add_epi32(s, _mm256_slli_si256(s, 8));
+        // Carry the low half's total into the high half
+        __m256i t = _mm256_shuffle_epi32(s, 0xff);
+        s = _mm256_add_epi32(s, _mm256_permute2x128_si256(t, t, 0x08));
+        s = _mm256_add_epi32(s, c);
+        _mm256_storeu_si256((__m256i *)(dst + i), inclusive ? s : _mm256_sub_epi32(s, x));
+        c = _mm256_permutevar8x32_epi32(s, last);
+    }
+    *carry = (uint32_t)_mm_cvtsi128_si32(_mm256_castsi256_si128(c));
+    return i;
+}
+
+// Internal helper: scan of 64-bit lanes continuing from *carry
+__attribute__((target("avx2")))
+static size_t array_scan64_avx2(const int64_t *src, int64_t *dst, size_t len, uint64_t *carry,
+                                int inclusive) {
+    __m256i c = _mm256_set1_epi64x((int64_t)*carry);
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i s = _mm256_add_epi64(x, _mm256_slli_si256(x, 8));
+        __m256i t = _mm256_permute4x64_epi64(s, 0x50);
+        s = _mm256_add_epi64(s, _mm256_blend_epi32(_mm256_setzero_si256(), t, 0xf0));
+        s = _mm256_add_epi64(s, c);
+        _mm256_storeu_si256((__m256i *)(dst + i), inclusive ? s : _mm256_sub_epi64(s, x));
+        c = _mm256_permute4x64_epi64(s, 0xff);
+    }
+    *carry = (uint64_t)_mm_cvtsi128_si64(_mm256_castsi256_si128(c));
+    return i;
+}
+
+// Internal helper: number of elements inside [lo, hi]
+__attribute__((target("avx2")))
+static size_t array_count_range_avx2(const int32_t *arr, size_t len, int32_t lo, int32_t hi,
+                                     size_t *count) {
+    const __m256i vlo = _mm256_set1_epi32(lo), vhi = _mm256_set1_epi32(hi);
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0, n = 0;
+    while (i + 8 <= len) {
+        // Lane counters are flushed before they can overflow
+        size_t stop = len - i > ((size_t)1 << 34) ? i + ((size_t)1 << 34) : len;
+        for (; i + 8 <= stop; i += 8) {
+            __m256i x = _mm256_loadu_si256((const __m256i *)(arr + i));
+            __m256i out = _mm256_or_si256(_mm256_cmpgt_epi32(vlo, x), _mm256_cmpgt_epi32(x, vhi));
+            acc = _mm256_sub_epi32(acc, out);
+        }
+        uint32_t lanes[8];
+        _mm256_storeu_si256((__m256i *)lanes, acc);
+        for (int j = 0; j < 8; j++) n += lanes[j];
+        acc = _mm256_setzero_si256();
+    }
+    // acc counted the elements outside the range
+    *count += i - n;
+    return i;
+}
+
+// Internal helper: copies the elements inside [lo, hi] to keep and, if
+// rest is not NULL, the others to rest, both in order
+__attribute__((target("avx2,popcnt")))
+static size_t array_split_range_avx2(const int32_t *src, size_t len, int32_t lo, int32_t hi,
+                                     int32_t *keep, int32_t *rest, size_t *nkeep, size_t *nrest) {
+    const __m256i vlo = _mm256_set1_epi32(lo), vhi = _mm256_set1_epi32(hi);
+    size_t i = 0, k = *nkeep, r = *nrest;
+    for (; i + 8 <= len; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(src + i));
+        unsigned mask = array_range_mask(x, vlo, vhi);
+        k += array_store_compressed(keep + k, x, mask);
+        if (rest) r += array_store_compressed(rest + r, x, ~mask & 0xff);
+    }
+    *nkeep = k;
+    *nrest = r;
+    return i;
+}
+#endif
+
+// Internal helper: scan continuing from carry; returns carry plus the sum
+static uint32_t array_scan32(const int32_t *src, int32_t *dst, size_t len, uint32_t carry, int inclusive) {
+    size_t i = 0;
+#ifdef ARRAY_X86
+    if (ARRAY_HAS_AVX2()) i = array_scan32_avx2(src, dst, len, &carry, inclusive);
+#endif
+    for (; i < len; i++) {
+        uint32_t x = (uint32_t)src[i];
+        dst[i] = (int32_t)(inclusive ? carry + x : carry);
+        carry += x;
+    }
+    return carry;
+}
+
+static uint64_t array_scan64(const int64_t *src, int64_t *dst, size_t len, uint64_t carry, int inclusive) {
+    size_t i = 0;
+#ifdef ARRAY_X86
+    if (ARRAY_HAS_AVX2()) i = array_scan64_avx2(src, dst, len, &carry, inclusive);
+#endif
+    for (; i < len; i++) {
+        uint64_t x = (uint64_t)src[i];
+        dst[i] = (int64_t)(inclusive ? carry + x : carry);
+        carry += x;
+    }
+    return carry;
+}
+
+// Internal helper: splits src by [lo, hi] into keep and rest (may be NULL),
+// adding to the counts
+static void array_split_range(const int32_t *src, size_t len, int32_t lo, int32_t hi,
+                              int32_t *keep, int32_t *rest, size_t *nkeep, size_t *nrest) {
+    size_t i = 0, k = *nkeep, r = *nrest;
+#ifdef ARRAY_X86
+    if (ARRAY_HAS_AVX2()) {
+        i = array_split_range_avx2(src, len, lo, hi, keep, rest, &k, &r);
+    }
+#endif
+    for (; i < len; i++) {
+        int32_t x = src[i];
+        if (x >= lo && x <= hi) {
+            keep[k++] = x;
+        } else if (rest) {
+            rest[r++] = x;
+        }
+    }
+    *nkeep = k;
+    *nrest = r;
+}
+
+// Counts the elements of arr inside [lo, hi]
+size_t array_count_range_i32(const int32_t *arr, size_t len, int32_t lo, int32_t hi) {
+    size_t n = 0, i = 0;
+#ifdef ARRAY_X86
+    if (ARRAY_HAS_AVX2()) i = array_count_range_avx2(arr, len, lo, hi, &n);
+#endif
+    for (; i < len; i++) n += arr[i] >= lo && arr[i] <= hi;
+    return n;
+}
+
+// Shared state of one blocked scan or split
+typedef struct {
+    const void *src;
+    void *dst;
+    size_t len;
+    int inclusive;          // scans: inclusive or exclusive
+    int32_t lo, hi;         // splits: the range kept
+    int partition;          // splits: also write the rest after the matches
+    uint64_t *offsets;      // per block: total before it (pass 2) or of it (pass 1)
+} array_block_job;
+
+// Internal helper: bounds of block i
+static size_t array_block_span(const array_block_job *job, size_t i, size_t *start) {
+    *start = i * ARRAY_PAR_CHUNK;
+    size_t n = job->len - *start;
+    return n < ARRAY_PAR_CHUNK ? n : ARRAY_PAR_CHUNK;
+}
+
+// Internal helper: pass 1 tasks, the total of one block
+static void array_sum32_block_task(void *ctx, size_t i) {
+    array_block_job *job = ctx;
+    size_t start, n = array_block_span(job, i, &start);
+    job->offsets[i] = array_sum32((const int32_t *)job->src + start, n);
+}
+
+static void array_sum64_block_task(void *ctx, size_t i) {
+    array_block_job *job = ctx;
+    size_t start, n = array_block_span(job, i, &start);
+    job->offsets[i] = array_sum_u64((const uint64_t *)job->src + start, n);
+}
+
+static void array_count_block_task(void *ctx, size_t i) {
+    array_block_job *job = ctx;
+    size_t start, n = array_block_span(job, i, &start);
+    job->offsets[i] = array_count_range_i32((const int32_t *)job->src + start, n, job->lo, job->hi);
+}
+
+// Internal helper: pass 2 tasks, one block written at its offset
+static void array_scan32_block_task(void *ctx, size_t i) {
+    array_block_job *job = ctx;
+    size_t start, n = array_block_span(job, i, &start);
+    array_scan32((const int32_t *)job->src + start, (int32_t *)job->dst + start, n,
+                 (uint32_t)job->offsets[i], job->inclusive);
+}
+
+static void array_scan64_block_task(void *ctx, size_t i) {
+    array_block_job *job = ctx;
+    size_t start, n = array_block_span(job, i, &start);
+    array_scan64((const int64_t *)job->src + start, (int64_t *)job->dst + start, n,
+                 job->offsets[i], job->inclusive);
+}
+
+static void array_split_block_task(void *ctx, size_t i) {
+    array_block_job *job = ctx;
+    size_t start, n = array_block_span(job, i, &start);
+    size_t kept = job->offsets[i], total = job->offsets[(job->len - 1) / ARRAY_PAR_CHUNK + 1];
+    size_t nkeep = 0, nrest = 0;
+    int32_t *dst = job->dst;
+    // Everything before this block that was not kept precedes its rest
+    int32_t *rest = job->partition ? dst + total + (start - kept) : NULL;
+    array_split_range((const int32_t *)job->src + start, n, job->lo, job->hi, dst + kept, rest,
+                      &nkeep, &nrest);
+}
+
+// Internal helper: runs both passes over the blocks of job; offsets[blocks]
+// receives the grand total. Returns -1 (having done nothing) when the call
+// should run serially.
+static int array_block_run(array_block_job *job, void (*total)(void *, size_t),
+                           void (*write)(void *, size_t)) {
+    size_t blocks = array_par_chunks(job->len, job->len);
+    if (blocks == 0) return -1;
+    job->offsets = malloc((blocks + 1) * sizeof(uint64_t));
+    if (!job->offsets) return -1;
+    thread_parallel_for(blocks, total, job);
+    uint64_t sum = 0;
+    for (size_t i = 0; i < blocks; i++) {
+        uint64_t n = job->offsets[i];
+        job->offsets[i] = sum;
+        sum += n;
+    }
+    job->offsets[blocks] = sum;
+    thread_parallel_for(blocks, write, job);
+    return 0;
+}
+
+// Internal helper: scan entry point shared by the four public functions
+static void array_scan(const void *src, void *dst, size_t len, int wide, int inclusive) {
+    array_block_job job = {src, dst, len, inclusive, 0, 0, 0, NULL};
+    int done = wide ? array_block_run(&job, array_sum64_block_task, array_scan64_block_task)
+                    : array_block_run(&job, array_sum32_block_task, array_scan32_block_task);
+    if (done == 0) {
+        free(job.offsets);
+    } else if (wide) {
+        array_scan64(src, dst, len, 0, inclusive);
+    } else {
+        array_scan32(src, dst, len, 0, inclusive);
+    }
+}
+
+void array_inclusive_scan_i32(const int32_t *src, int32_t *dst, size_t len) {
+    array_scan(src, dst, len, 0, 1);
+}
+
+void array_exclusive_scan_i32(const int32_t *src, int32_t *dst, size_t len) {
+    array_scan(src, dst, len, 0, 0);
+}
+
+void array_inclusive_scan_i64(const int64_t *src, int64_t *dst, size_t len) {
+    array_scan(src, dst, len, 1, 1);
+}
+
+void array_exclusive_scan_i64(const int64_t *src, int64_t *dst, size_t len) {
+    array_scan(src, dst, len, 1, 0);
+}
+
+// Copies the elements of src inside [lo, hi] to dst in order
+size_t array_filter_range_i32(const int32_t *src, int32_t *dst, size_t len, int32_t lo, int32_t hi) {
+    array_block_job job = {src, dst, len, 0, lo, hi, 0, NULL};
+    // Blocks may only run concurrently when they cannot overwrite input
+    if (src != dst && array_block_run(&job, array_count_block_task, array_split_block_task) == 0) {
+        size_t kept = job.offsets[(len - 1) / ARRAY_PAR_CHUNK + 1];
+        free(job.offsets);
+        return kept;
+    }
+    size_t kept = 0, rest = 0;
+    array_split_range(src, len, lo, hi, dst, NULL, &kept, &rest);
+    return kept;
+}
+
+// Stable partition of src into dst: elements inside [lo, hi] first
+size_t array_partition_range_i32(const int32_t *src, int32_t *dst, size_t len, int32_t lo, int32_t hi) {
+    array_block_job job = {src, dst, len, 0, lo, hi, 1, NULL};
+    if (array_block_run(&job, array_count_block_task, array_split_block_task) == 0) {
+        size_t kept = job.offsets[(len - 1) / ARRAY_PAR_CHUNK + 1];
+        free(job.offsets);
+        return kept;
+    }
+    size_t kept = 0, rest = 0;
+    array_split_range(src, len, lo, hi, dst, dst + array_count_range_i32(src, len, lo, hi),
+                      &kept, &rest);
+    return kept;
+}
+
+// Copies the elements of src for which pred returns nonzero to dst in order
+size_t array_filter_i32(const int32_t *src, int32_t *dst, size_t len,
+                        int (*pred)(int32_t x, void *ctx), void *ctx) {
+    size_t n = 0;
+    for (size_t i = 0; i < len; i++) {
+        // Store unconditionally and advance on a match: no branch to mispredict
+        int32_t x = src[i];
+        dst[n] = x;
+        n += pred(x, ctx) != 0;
+    }
+    return n;
+}
+
+// Stable partition of src into dst by pred: matching elements first
+size_t array_partition_i32(const int32_t *src, int32_t *dst, size_t len,
+                           int (*pred)(int32_t x, void *ctx), void *ctx) {
+    size_t n = 0, back = len;
+    for (size_t i = 0; i < len; i++) {
+        int32_t x = src[i];
+        if (pred(x, ctx)) {
+            dst[n++] = x;
+        } else {
+            dst[--back] = x;
+        }
+    }
+    // The rest was written back to front
+    array_reverse_i32(dst + n, len - n);
+    return n;
+}
+
+// Initializes an empty vector backed by its inline buffer
+void iv_init(int_vec *v) {
+    v->data = v->inline_buf;
+    v->len = 0;
+    v->cap = INT_VEC_INLINE;
+    v->arena = NULL;
+}
+
+// Initializes an empty vector that grows inside arena a
+void iv_init_arena(int_vec *v, arena *a) {
+    iv_init(v);
+    v->arena = a;
+}
+
+// Releases the heap buffer, if any, and leaves the vector empty
+void iv_free(int_vec *v) {
+    arena *a = v->arena;
+    if (!a && v->data != v->inline_buf) free(v->data);
+    iv_init(v);
+    v->arena = a;
+}
+
+// Empties the vector but keeps its capacity
+void iv_clear(int_vec *v) {
+    v->len = 0;
+}
+
+// Ensures room for extra elements, doubling the capacity
+int iv_reserve(int_vec *v, size_t extra) {
+    if (extra > SIZE_MAX / sizeof(int) - v->len) return -1;
+    size_t need = v->len + extra;
+    if (need <= v->cap) return 0;
+    size_t cap = v->cap * 2;
+    if (cap < need) cap = need;
+    if (cap > SIZE_MAX / sizeof(int)) cap = need;
+    int *data;
+    int spilled = v->data != v->inline_buf;
+    if (v->arena) {
+        data = arena_realloc_aligned(v->arena, spilled ? v->data : NULL, spilled ? v->cap * sizeof(int) : 0,
+                                     cap * sizeof(int), sizeof(int));
+        if (!data) return -1;
+        if (!spilled) memcpy(data, v->inline_buf, v->len * sizeof(int));
+    } else if (!spilled) {
+        data = malloc(cap * sizeof(int));
+        if (!data) return -1;
+        memcpy(data, v->inline_buf, v->len * sizeof(int));
+    } else {
+        data = realloc(v->data, cap * sizeof(int));
+        if (!data) return -1;
+    }
+    v->data = data;
+    v->cap = cap;
+    return 0;
+}
+
+// Gives back unused capacity
+int iv_shrink(int_vec *v) {
+    if (v->data == v->inline_buf || v->arena) return 0;
+    if (v->len <= INT_VEC_INLINE) {
+        int *old = v->data;
+        memcpy(v->inline_buf, old, v->len * sizeof(int));
+        free(old);
+        v->data = v->inline_buf;
+        v->cap = INT_VEC_INLINE;
+        return 0;
+    }
+    int *data = realloc(v->data, v->len * sizeof(int));
+    if (!data) return -1;
+    v->data = data;
+    v->cap = v->len;
+    return 0;
+}
+
+// Sets the length, zeroing new elements
+int iv_resize(int_vec *v, size_t len) {
+    if (len > v->len) {
+        if (iv_reserve(v, len - v->len) < 0) return -1;
+        memset(v->data + v->len, 0, (len - v->len) * sizeof(int));
+    }
+    v->len = len;
+    return 0;
+}
+
+// Appends one element
+int iv_push(int_vec *v, int x) {
+    if (v->len < v->cap) {
+        v->data[v->len++] = x;
+        return 0;
+    }
+    return iv_append(v, &x, 1);
+}
+
+// Appends n elements from src
+int iv_append(int_vec *v, const int *src, size_t n) {
+    if (iv_reserve(v, n) < 0) return -1;
+    if (n) memcpy(v->data + v->len, src, n * sizeof(int));
+    v->len += n;
+    return 0;
+}
+
+// Hands the buffer to the caller; only inline contents need a copy
+int *iv_detach(int_vec *v, size_t *len) {
+    arena *a = v->arena;
+    int *out;
+    if (len) *len = v->len;
+    if (v->len == 0) {
+        iv_free(v);
+        return NULL;
+    }
+    if (v->data == v->inline_buf) {
+        size_t bytes = v->len * sizeof(int);
+        out = a ? arena_alloc(a, bytes) : malloc(bytes);
+        if (!out) return NULL;
+        memcpy(out, v->inline_buf, bytes);
+    } else if (a) {
+        // Give back the unused tail when the buffer is the arena's newest block
+        out = arena_realloc_aligned(a, v->data, v->cap * sizeof(int), v->len * sizeof(int), sizeof(int));
+    } else {
+        out = v->data;
     }
+    iv_init(v);
+    v->arena = a;
+    return out;
 }
@@ -1,12 +1,230 @@
 #ifndef ARRAY_UTILS_H
 #define ARRAY_UTILS_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include "arena_utils.h"
+
 // Array utility function prototypes will go here
 
+// Summary statistics of an int array, gathered in one pass
+typedef struct {
+    long long sum;      // exact for any array shorter than 2^32 elements
+    int min;
+    int max;
+    double mean;
+    double variance;    // population variance (divides by len)
+} array_stats_result;
+
+// Instruction set levels for array_set_simd_limit
+#define ARRAY_SIMD_SCALAR 0
+#define ARRAY_SIMD_SSE41  1
+#define ARRAY_SIMD_AVX2   2
+
+// The sum wraps around like int arithmetic; see array_sum64 for a wide sum
 int array_sum(const int *arr, int len);
+// The mean, computed from a 64-bit sum so it does not overflow
 double array_average(const int *arr, int len);
 int array_min(const int *arr, int len);
 int array_max(const int *arr, int len);
 void array_reverse(int *arr, int len);
 
+// Returns the sum of arr as a 64-bit integer
+long long array_sum64(const int *arr, size_t len);
+
+// Computes sum, min, max, mean and variance in a single pass, using AVX2
+// or SSE4.1 when the CPU supports them. The variance comes from exact
+// integer sums of x and x^2 (combined exactly for len < 2^31), so a large
+// mean does not cancel away its precision. Returns 0, or -1 with every
+// field zeroed when len is 0.
+int array_stats(const int *arr, size_t len, array_stats_result *out);
+
+// Typed kernels with size_t lengths, vectorized like the int ones.
+// Sums: int32 is widened to 64 bits; int64 and uint64 wrap around; float
+// is accumulated in double. Floating-point sums add in SIMD lane order,
+// so the last bits can differ from a left-to-right loop and between
+// instruction set levels.
+int64_t array_sum_i32(const int32_t *arr, size_t len);
+int64_t array_sum_i64(const int64_t *arr, size_t len);
+uint64_t array_sum_u64(const uint64_t *arr, size_t len);
+double array_sum_f32(const float *arr, size_t len);
+double array_sum_f64(const double *arr, size_t len);
+
+// Min and max in one pass; return 0, or -1 when len is 0. The float
+// versions skip NaNs like fmin/fmax: the result is NaN only when every
+// element is NaN. When -0.0 and +0.0 are both extremes, either may be
+// returned.
+int array_minmax_i32(const int32_t *arr, size_t len, int32_t *min, int32_t *max);
+int array_minmax_i64(const int64_t *arr, size_t len, int64_t *min, int64_t *max);
+int array_minmax_u64(const uint64_t *arr, size_t len, uint64_t *min, uint64_t *max);
+int array_minmax_f32(const float *arr, size_t len, float *min, float *max);
+int array_minmax_f64(const double *arr, size_t len, double *min, double *max);
+
+void array_reverse_i32(int32_t *arr, size_t len);
+void array_reverse_i64(int64_t *arr, size_t len);
+void array_reverse_u64(uint64_t *arr, size_t len);
+void array_reverse_f32(float *arr, size_t len);
+void array_reverse_f64(double *arr, size_t len);
+
+// Pick the typed kernel from the element type of arr
+#define ARRAY_SUM(arr, len)                                                     \
+    _Generic((arr),                                                             \
+        int32_t *: array_sum_i32, const int32_t *: array_sum_i32,               \
+        int64_t *: array_sum_i64, const int64_t *: array_sum_i64,               \
+        uint64_t *: array_sum_u64, const uint64_t *: array_sum_u64,             \
+        float *: array_sum_f32, const float *: array_sum_f32,                   \
+        double *: array_sum_f64, const double *: array_sum_f64)(arr, len)
+#define ARRAY_MINMAX(arr, len, min, max)                                        \
+    _Generic((arr),                                                             \
+        int32_t *: array_minmax_i32, const int32_t *: array_minmax_i32,         \
+        int64_t *: array_minmax_i64, const int64_t *: array_minmax_i64,         \
+        uint64_t *: array_minmax_u64, const uint64_t *: array_minmax_u64,       \
+        float *: array_minmax_f32, const float *: array_minmax_f32,             \
+        double *: array_minmax_f64, const double *: array_minmax_f64)(arr, len, min, max)
+#define ARRAY_REVERSE(arr, len)                                                 \
+    _Generic((arr),                                                             \
+        int32_t *: array_reverse_i32,                                           \
+        int64_t *: array_reverse_i64,                                           \
+        uint64_t *: array_reverse_u64,                                          \
+        float *: array_reverse_f32,                                             \
+        double *: array_reverse_f64)(arr, len)
+
+// Parallel variants for very large arrays. At or above the threshold
+// (default 4M elements) the work is split into fixed-size chunks run on the
+// thread_utils pool; chunk results are combined in chunk order, so the
+// output does not depend on the thread count or scheduling. Below it, or
+// with a single-thread pool, they run the serial kernels.
+long long array_sum64_parallel(const int *arr, size_t len);
+// Returns 0, or -1 when len is 0
+int array_minmax_parallel(const int *arr, size_t len, int *min, int *max);
+int array_stats_parallel(const int *arr, size_t len, array_stats_result *out);
+void array_reverse_parallel(int *arr, size_t len);
+
+// Sets and returns the length from which the parallel variants use threads
+void array_set_parallel_threshold(size_t len);
+size_t array_parallel_threshold(void);
+
+// LSD radix sorts for 32- and 64-bit integers, O(n) with a scratch copy
+// of the array. Return 0, or -1 if out of memory (arr is then unchanged).
+int array_radix_sort_i32(int32_t *arr, size_t len);
+int array_radix_sort_u32(uint32_t *arr, size_t len);
+int array_radix_sort_i64(int64_t *arr, size_t len);
+int array_radix_sort_u64(uint64_t *arr, size_t len);
+
+// Sorts n elements of the given size with a qsort-style comparator, using
+// a pattern-defeating quicksort: O(n log n) worst case, linear on sorted or
+// reversed runs, not stable. Returns 0, or -1 if out of memory (only
+// possible for elements over 128 bytes).
+int array_sort(void *base, size_t n, size_t size, int (*cmp)(const void *, const void *));
+
+// Branchless binary search over a sorted array: the index of the first
+// element >= key (lower) or > key (upper), or len if there is none
+size_t array_lower_bound_i32(const int32_t *arr, size_t len, int32_t key);
+size_t array_upper_bound_i32(const int32_t *arr, size_t len, int32_t key);
+size_t array_lower_bound_i64(const int64_t *arr, size_t len, int64_t key);
+size_t array_upper_bound_i64(const int64_t *arr, size_t len, int64_t key);
+
+// A sorted array stored in Eytzinger (breadth-first) order for repeated
+// lookups: the top levels of the implicit tree stay in cache and the next
+// levels can be prefetched, which beats binary search once the array is
+// larger than the cache
+typedef struct {
+    int32_t *keys;      // keys[1..len] in breadth-first order
+    size_t *rank;       // rank[k]: index of keys[k] in the sorted array
+    size_t len;
+} array_eytz;
+
+// Builds the layout from a sorted array. Returns 0, or -1 if out of memory.
+int array_eytz_init(array_eytz *t, const int32_t *sorted, size_t len);
+// Releases the layout
+void array_eytz_free(array_eytz *t);
+// Same result as array_lower_bound_i32 on the sorted array
+size_t array_eytz_lower_bound(const array_eytz *t, int32_t key);
+
+// Prefix sums of src into dst (which may be src): inclusive puts
+// src[0] + ... + src[i] in dst[i], exclusive the sum before src[i]. Sums
+// wrap around. Like all functions below, they use the thread pool in
+// fixed-size blocks at or above the parallel threshold.
+void array_inclusive_scan_i32(const int32_t *src, int32_t *dst, size_t len);
+void array_exclusive_scan_i32(const int32_t *src, int32_t *dst, size_t len);
+void array_inclusive_scan_i64(const int64_t *src, int64_t *dst, size_t len);
+void array_exclusive_scan_i64(const int64_t *src, int64_t *dst, size_t len);
+
+// Returns the number of elements inside [lo, hi]
+size_t array_count_range_i32(const int32_t *arr, size_t len, int32_t lo, int32_t hi);
+
+// Copies the elements inside [lo, hi] to dst in order and returns how many.
+// dst may be src (the filter then runs on one thread) but must not
+// otherwise overlap it.
+size_t array_filter_range_i32(const int32_t *src, int32_t *dst, size_t len, int32_t lo, int32_t hi);
+
+// Stable partition into a separate dst: the elements inside [lo, hi], then
+// the others, each in their original order. Returns the count of the first.
+size_t array_partition_range_i32(const int32_t *src, int32_t *dst, size_t len, int32_t lo, int32_t hi);
+
+// The same with an arbitrary predicate, called once per element on the
+// calling thread. The filter writes without branching, so dst may be src.
+size_t array_filter_i32(const int32_t *src, int32_t *dst, size_t len,
+                        int (*pred)(int32_t x, void *ctx), void *ctx);
+size_t array_partition_i32(const int32_t *src, int32_t *dst, size_t len,
+                           int (*pred)(int32_t x, void *ctx), void *ctx);
+
+// Elements an int_vec holds before it first touches the heap
+#define INT_VEC_INLINE 16
+
+// A growable int array. Small arrays live in inline_buf; larger ones move
+// to a heap buffer that grows geometrically. data points into the struct
+// while inline, so a vector must not be copied by value. When arena is
+// set, the heap buffer comes from that arena instead of malloc. data and
+// len can be passed straight to the size_t kernels above (array_stats,
+// array_sum_i32, array_radix_sort_i32, ...).
+typedef struct {
+    int *data;
+    size_t len;
+    size_t cap;
+    arena *arena;
+    int inline_buf[INT_VEC_INLINE];
+} int_vec;
+
+// Initializes an empty vector
+void iv_init(int_vec *v);
+
+// Initializes an empty vector that grows inside arena a
+void iv_init_arena(int_vec *v, arena *a);
+
+// Releases the vector's heap buffer, if any, and leaves it empty (arena
+// memory is left to the arena)
+void iv_free(int_vec *v);
+
+// Empties the vector but keeps its capacity
+void iv_clear(int_vec *v);
+
+// Ensures room for extra more elements, returns 0 on success, -1 on error
+int iv_reserve(int_vec *v, size_t extra);
+
+// Gives back unused capacity: a vector that fits moves back inline, a
+// malloc'd one is trimmed to len. Arena buffers are left as they are.
+// Returns 0 on success, -1 on error.
+int iv_shrink(int_vec *v);
+
+// Sets the length to len; new elements are zero. Returns 0 or -1.
+int iv_resize(int_vec *v, size_t len);
+
+// Appends one element, returns 0 on success, -1 on error
+int iv_push(int_vec *v, int x);
+
+// Appends n elements from src, returns 0 on success, -1 on error
+int iv_append(int_vec *v, const int *src, size_t n);
+
+// Hands the elements to the caller as a malloc'd array (no copy once the
+// vector has spilled to the heap) and resets the vector; stores the length
+// in *len if len is not NULL. Arena vectors return arena memory that must
+// not be passed to free. Returns NULL on error or for an empty vector.
+int *iv_detach(int_vec *v, size_t *len);
+
+// Caps the instruction set the kernels may use (default ARRAY_SIMD_AVX2,
+// i.e. the best the CPU supports); for tests and benchmarks. Not
+// thread-safe with respect to running kernels.
+void array_set_simd_limit(int level);
+
 #endif // ARRAY_UTILS_H
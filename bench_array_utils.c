@@ -0,0 +1,183 @@
+// bench_array_utils.c - parallel reductions at 1..N threads, and sorting
+// and searching against qsort and bsearch
+//
+// Build: gcc -O2 -o bench_array_utils bench_array_utils.c array_utils.c thread_utils.c arena_utils.c -lpthread
+// Usage: ./bench_array_utils parallel [elements] [max_threads]
+//        ./bench_array_utils sort [elements]
+//        ./bench_array_utils search [elements] [lookups]
+#include "array_utils.h"
+#include "thread_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Times each parallel variant with a pool of nthreads threads, best of 3
+static void run(int *arr, size_t n, int nthreads) {
+    thread_pool_init(nthreads);
+    // Take the copy-on-write faults of the forked child before timing
+    array_reverse_parallel(arr, n);
+    double best[4] = {1e9, 1e9, 1e9, 1e9};
+    array_stats_result st;
+    int min, max;
+    volatile long long sink = 0;
+    for (int rep = 0; rep < 3; rep++) {
+        double t0 = now_sec();
+        sink += array_sum64_parallel(arr, n);
+        double t1 = now_sec();
+        array_minmax_parallel(arr, n, &min, &max);
+        double t2 = now_sec();
+        array_stats_parallel(arr, n, &st);
+        double t3 = now_sec();
+        array_reverse_parallel(arr, n);
+        double t4 = now_sec();
+        sink += min + max + st.sum;
+        double t[4] = {t1 - t0, t2 - t1, t3 - t2, t4 - t3};
+        for (int i = 0; i < 4; i++)
+            if (t[i] < best[i]) best[i] = t[i];
+    }
+    printf("%7d %10.1f %10.1f %10.1f %10.1f\n", nthreads,
+           best[0] * 1e3, best[1] * 1e3, best[2] * 1e3, best[3] * 1e3);
+}
+
+// Parallel reductions with pools of 1 to max_threads threads
+static int bench_parallel(size_t n, int max_threads) {
+    int *arr = malloc(n * sizeof(int));
+    if (!arr) {
+        perror("malloc");
+        return 1;
+    }
+    srand(1);
+    for (size_t i = 0; i < n; i++) arr[i] = rand() - RAND_MAX / 2;
+
+    printf("%zu ints, times in ms\n", n);
+    printf("%7s %10s %10s %10s %10s\n", "threads", "sum64", "minmax", "stats", "reverse");
+    // The pool size is fixed once started, so each count runs in a fresh child
+    for (int t = 1; t <= max_threads; t++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0) {
+            run(arr, n, t);
+            fflush(stdout);
+            _exit(0);
+        }
+        if (pid < 0 || waitpid(pid, NULL, 0) < 0) {
+            perror("fork");
+            return 1;
+        }
+    }
+    free(arr);
+    return 0;
+}
+
+static int cmp_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Fills arr with one of the input patterns
+static void fill(int32_t *arr, size_t n, int pattern) {
+    for (size_t i = 0; i < n; i++) {
+        switch (pattern) {
+        case 0: arr[i] = rand() - RAND_MAX / 2; break;
+        case 1: arr[i] = rand() % 100; break;
+        default: arr[i] = (int32_t)i + (rand() % 100 == 0 ? rand() % 1000 : 0); break;
+        }
+    }
+}
+
+// Sorting n ints: qsort, array_sort and the radix sort
+static int bench_sort(size_t n) {
+    static const char *patterns[] = {"random", "100 distinct", "nearly sorted"};
+    int32_t *src = malloc(n * sizeof(int32_t)), *arr = malloc(n * sizeof(int32_t));
+    if (!src || !arr) {
+        perror("malloc");
+        return 1;
+    }
+    printf("%zu ints, times in ms\n", n);
+    printf("%-14s %10s %10s %10s\n", "input", "qsort", "array_sort", "radix");
+    for (int p = 0; p < 3; p++) {
+        srand(1);
+        fill(src, n, p);
+        double t[3];
+        for (int k = 0; k < 3; k++) {
+            memcpy(arr, src, n * sizeof(int32_t));
+            double t0 = now_sec();
+            if (k == 0) qsort(arr, n, sizeof(int32_t), cmp_int);
+            if (k == 1) array_sort(arr, n, sizeof(int32_t), cmp_int);
+            if (k == 2) array_radix_sort_i32(arr, n);
+            t[k] = now_sec() - t0;
+            for (size_t i = 1; i < n; i++) {
+                if (arr[i - 1] > arr[i]) {
+                    fprintf(stderr, "not sorted\n");
+                    return 1;
+                }
+            }
+        }
+        printf("%-14s %10.1f %10.1f %10.1f\n", patterns[p], t[0] * 1e3, t[1] * 1e3, t[2] * 1e3);
+    }
+    free(src);
+    free(arr);
+    return 0;
+}
+
+// Random lookups in a sorted array: bsearch, the branchless lower bound and
+// the Eytzinger layout
+static int bench_search(size_t n, size_t lookups) {
+    int32_t *arr = malloc(n * sizeof(int32_t)), *keys = malloc(lookups * sizeof(int32_t));
+    if (!arr || !keys) {
+        perror("malloc");
+        return 1;
+    }
+    srand(1);
+    for (size_t i = 0; i < n; i++) arr[i] = (int32_t)(2 * i);
+    for (size_t i = 0; i < lookups; i++) keys[i] = (int32_t)(((size_t)rand() * 2654435761u) % (2 * n));
+    array_eytz t;
+    if (array_eytz_init(&t, arr, n) != 0) {
+        perror("array_eytz_init");
+        return 1;
+    }
+    size_t check[3] = {0, 0, 0};
+    double t0 = now_sec();
+    for (size_t i = 0; i < lookups; i++) check[0] += bsearch(&keys[i], arr, n, sizeof(int32_t), cmp_int) != NULL;
+    double t1 = now_sec();
+    for (size_t i = 0; i < lookups; i++) {
+        size_t k = array_lower_bound_i32(arr, n, keys[i]);
+        check[1] += k < n && arr[k] == keys[i];
+    }
+    double t2 = now_sec();
+    for (size_t i = 0; i < lookups; i++) {
+        size_t k = array_eytz_lower_bound(&t, keys[i]);
+        check[2] += k < n && arr[k] == keys[i];
+    }
+    double t3 = now_sec();
+    printf("%zu lookups in %zu ints, ns per lookup (hits %zu/%zu/%zu)\n", lookups, n, check[0], check[1], check[2]);
+    printf("bsearch %.1f  lower_bound %.1f  eytzinger %.1f\n",
+           (t1 - t0) * 1e9 / lookups, (t2 - t1) * 1e9 / lookups, (t3 - t2) * 1e9 / lookups);
+    array_eytz_free(&t);
+    free(arr);
+    free(keys);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *mode = argc > 1 ? argv[1] : "parallel";
+    if (strcmp(mode, "sort") == 0)
+        return bench_sort(argc > 2 ? strtoull(argv[2], NULL, 10) : 10000000);
+    if (strcmp(mode, "search") == 0)
+        return bench_search(argc > 2 ? strtoull(argv[2], NULL, 10) : 10000000,
+                            argc > 3 ? strtoull(argv[3], NULL, 10) : 10000000);
+    if (strcmp(mode, "parallel") == 0)
+        return bench_parallel(argc > 2 ? strtoull(argv[2], NULL, 10) : 200000000,
+                              argc > 3 ? atoi(argv[3]) : thread_cpu_count());
+    fprintf(stderr, "usage: %s parallel|sort|search [elements] [threads|lookups]\n", argv[0]);
+    return 1;
+}
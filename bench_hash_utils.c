@@ -0,0 +1,182 @@
+// bench_hash_utils.c - Swiss-table hash_map vs a chained hash table
+//
+// Build: gcc -O2 -o bench_hash_utils bench_hash_utils.c hash_utils.c arena_utils.c string_utils.c char_utils.c
+// Usage: ./bench_hash_utils [keys]
+#include "hash_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// The baseline: FNV-1a with malloc'd chain nodes and strdup'd keys, the
+// table each tool used to write for itself
+typedef struct chain_node {
+    struct chain_node *next;
+    char *key;
+    size_t len;
+    uint64_t value;
+} chain_node;
+
+typedef struct {
+    chain_node **buckets;
+    size_t cap;
+    size_t count;
+} chain_map;
+
+static uint64_t fnv1a(const char *s, size_t len) {
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static void chain_grow(chain_map *m) {
+    size_t cap = m->cap ? m->cap * 2 : 16;
+    chain_node **buckets = calloc(cap, sizeof(*buckets));
+    for (size_t i = 0; i < m->cap; i++) {
+        chain_node *n = m->buckets[i];
+        while (n) {
+            chain_node *next = n->next;
+            size_t b = fnv1a(n->key, n->len) & (cap - 1);
+            n->next = buckets[b];
+            buckets[b] = n;
+            n = next;
+        }
+    }
+    free(m->buckets);
+    m->buckets = buckets;
+    m->cap = cap;
+}
+
+static chain_node *chain_find(const chain_map *m, const char *key, size_t len) {
+    if (!m->cap) return NULL;
+    for (chain_node *n = m->buckets[fnv1a(key, len) & (m->cap - 1)]; n; n = n->next) {
+        if (n->len == len && memcmp(n->key, key, len) == 0) return n;
+    }
+    return NULL;
+}
+
+static void chain_put(chain_map *m, const char *key, size_t len, uint64_t value) {
+    chain_node *n = chain_find(m, key, len);
+    if (n) {
+        n->value = value;
+        return;
+    }
+    if (m->count + 1 > m->cap) chain_grow(m);
+    n = malloc(sizeof(*n));
+    n->key = malloc(len + 1);
+    memcpy(n->key, key, len);
+    n->key[len] = '\0';
+    n->len = len;
+    n->value = value;
+    size_t b = fnv1a(key, len) & (m->cap - 1);
+    n->next = m->buckets[b];
+    m->buckets[b] = n;
+    m->count++;
+}
+
+static void chain_free(chain_map *m) {
+    for (size_t i = 0; i < m->cap; i++) {
+        chain_node *n = m->buckets[i];
+        while (n) {
+            chain_node *next = n->next;
+            free(n->key);
+            free(n);
+            n = next;
+        }
+    }
+    free(m->buckets);
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? (size_t)atol(argv[1]) : 1000000;
+    // Keys look like identifiers and paths of mixed length
+    // Keys look like identifiers and paths of mixed length; each has a miss
+    // key that differs only in its last byte
+    char **keys = malloc(n * sizeof(*keys));
+    char **misses = malloc(n * sizeof(*misses));
+    size_t *lens = malloc(n * sizeof(*lens));
+    size_t *order = malloc(n * sizeof(*order));
+    char buf[64];
+    unsigned seed = 12345;
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1103515245 + 12345;
+        int len;
+        if (i % 3 == 0) {
+            len = snprintf(buf, sizeof(buf), "/srv/data/%u/file%zu.txt", seed >> 20, i);
+        } else {
+            len = snprintf(buf, sizeof(buf), "user_%zu", i);
+        }
+        keys[i] = malloc((size_t)len + 1);
+        misses[i] = malloc((size_t)len + 1);
+        memcpy(keys[i], buf, (size_t)len + 1);
+        memcpy(misses[i], buf, (size_t)len + 1);
+        misses[i][len - 1] = '#';
+        lens[i] = (size_t)len;
+        order[i] = i;
+    }
+    // Look keys up in random order so the caches see a realistic pattern
+    for (size_t i = n - 1; i > 0; i--) {
+        seed = seed * 1103515245 + 12345;
+        size_t j = ((size_t)seed << 16 ^ (seed >> 8)) % (i + 1);
+        size_t t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+
+    printf("%zu keys\n", n);
+    printf("%-10s %12s %12s %12s %12s\n", "", "insert", "hit", "miss", "iterate");
+
+    chain_map cm = {0};
+    double t0 = now_sec();
+    for (size_t i = 0; i < n; i++) chain_put(&cm, keys[i], lens[i], i);
+    double t1 = now_sec();
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++) sum += chain_find(&cm, keys[order[i]], lens[order[i]])->value;
+    double t2 = now_sec();
+    for (size_t i = 0; i < n; i++) sum += chain_find(&cm, misses[order[i]], lens[order[i]]) != NULL;
+    double t3 = now_sec();
+    for (size_t b = 0; b < cm.cap; b++) {
+        for (chain_node *node = cm.buckets[b]; node; node = node->next) sum += node->value;
+    }
+    double t4 = now_sec();
+    printf("%-10s %9.1f ns %9.1f ns %9.1f ns %9.1f ns\n", "chained",
+           (t1 - t0) / n * 1e9, (t2 - t1) / n * 1e9, (t3 - t2) / n * 1e9, (t4 - t3) / n * 1e9);
+    chain_free(&cm);
+
+    hash_map hm;
+    hash_map_init(&hm);
+    t0 = now_sec();
+    for (size_t i = 0; i < n; i++) hash_map_put(&hm, sv_make(keys[i], lens[i]), i);
+    t1 = now_sec();
+    for (size_t i = 0; i < n; i++) sum += hash_map_find(&hm, sv_make(keys[order[i]], lens[order[i]]))->value;
+    t2 = now_sec();
+    for (size_t i = 0; i < n; i++) sum += hash_map_find(&hm, sv_make(misses[order[i]], lens[order[i]])) != NULL;
+    t3 = now_sec();
+    size_t pos = 0;
+    hash_map_entry *e;
+    while ((e = hash_map_next(&hm, &pos))) sum += e->value;
+    t4 = now_sec();
+    printf("%-10s %9.1f ns %9.1f ns %9.1f ns %9.1f ns\n", "hash_map",
+           (t1 - t0) / n * 1e9, (t2 - t1) / n * 1e9, (t3 - t2) / n * 1e9, (t4 - t3) / n * 1e9);
+    printf("checksum %llu\n", (unsigned long long)sum);
+    hash_map_free(&hm);
+
+    for (size_t i = 0; i < n; i++) {
+        free(keys[i]);
+        free(misses[i]);
+    }
+    free(keys);
+    free(misses);
+    free(lens);
+    free(order);
+    return 0;
+}
@@ -0,0 +1,86 @@
+// bench_search_utils.c - Throughput of substring and multi-pattern search
+//
+// Build: gcc -O2 -mavx2 -o bench_search_utils bench_search_utils.c search_utils.c string_utils.c arena_utils.c char_utils.c
+// Usage: ./bench_search_utils [megabytes]
+#define _GNU_SOURCE
+#include "search_utils.h"
+#include "string_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Fills buf with lowercase log-like text (words, spaces and newlines)
+static void make_text(char *buf, size_t len) {
+    unsigned seed = 42;
+    for (size_t i = 0; i < len; i++) {
+        seed = seed * 1103515245 + 12345;
+        unsigned r = (seed >> 16) % 32;
+        buf[i] = r < 26 ? (char)('a' + r) : r < 31 ? ' ' : '\n';
+    }
+}
+
+static void report(const char *name, size_t bytes, double secs) {
+    printf("%-30s %8.2f GB/s\n", name, bytes / secs / 1e9);
+}
+
+int main(int argc, char *argv[]) {
+    size_t mb = argc > 1 ? (size_t)atol(argv[1]) : 256;
+    size_t len = mb << 20;
+    char *text = malloc(len);
+    if (!text) return 1;
+    make_text(text, len);
+    str_view hay = sv_make(text, len);
+    volatile size_t sink = 0;
+
+    // The needle never occurs, so every search scans the whole buffer
+    str_view needle = SV_LIT("connection reset by peer");
+    double t0 = now_sec();
+    sink += sv_find_view(hay, needle);
+    report("sv_find_view", len, now_sec() - t0);
+
+    t0 = now_sec();
+    sink += sv_find_view_nocase(hay, SV_LIT("Connection Reset By Peer"));
+    report("sv_find_view_nocase", len, now_sec() - t0);
+
+    t0 = now_sec();
+    sink += (size_t)memmem(text, len, needle.data, needle.len);
+    report("memmem (libc reference)", len, now_sec() - t0);
+
+    // 300 keywords of 6-12 letters, as a log scanner might watch for
+    enum { NPAT = 300 };
+    char words[NPAT][16];
+    str_view pats[NPAT];
+    unsigned seed = 7;
+    for (int i = 0; i < NPAT; i++) {
+        int wlen = 6 + i % 7;
+        for (int j = 0; j < wlen; j++) {
+            seed = seed * 1103515245 + 12345;
+            words[i][j] = (char)('a' + (seed >> 16) % 26);
+        }
+        pats[i] = sv_make(words[i], wlen);
+    }
+    ac_automaton *ac = ac_build(pats, NPAT, 0);
+    if (!ac) return 1;
+    ac_cursor cur;
+    ac_cursor_init(&cur);
+    t0 = now_sec();
+    sink += ac_scan(ac, &cur, text, len, NULL, NULL);
+    report("ac_scan (300 patterns)", len, now_sec() - t0);
+
+    t0 = now_sec();
+    sink += ac_scan_buffer(ac, text, len, NULL, NULL);
+    report("ac_scan_buffer (300 patterns)", len, now_sec() - t0);
+    printf("automaton: %u states x %u classes (%zu KB table)\n", ac->nstates, ac->nclasses,
+           (size_t)ac->nstates * ac->stride * sizeof(uint32_t) / 1024);
+
+    ac_free(ac);
+    free(text);
+    return (int)(sink & 0);
+}
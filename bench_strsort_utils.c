@@ -0,0 +1,67 @@
+// bench_strsort_utils.c - str_sort vs qsort with str_compare
+//
+// Build: gcc -O2 -o bench_strsort_utils bench_strsort_utils.c strsort_utils.c thread_utils.c string_utils.c arena_utils.c char_utils.c -lpthread
+// Usage: ./bench_strsort_utils [keys]
+#include "strsort_utils.h"
+#include "thread_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int cmp_cstr(const void *a, const void *b) {
+    return str_compare(*(char *const *)a, *(char *const *)b);
+}
+
+static int cmp_natural(const void *a, const void *b) {
+    return str_natural_compare(*(char *const *)a, *(char *const *)b);
+}
+
+// Paths and log keys: long shared prefixes, numbered names, duplicates
+static char **make_keys(size_t n) {
+    static const char *prefixes[] = {"/var/log/nginx/access.log.", "/home/alice/projects/c_learn/src/",
+                                     "2024-05-17T12:", "user_session:", "/usr/share/doc/"};
+    char **keys = malloc(n * sizeof(*keys));
+    char buf[96];
+    unsigned seed = 2024;
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1103515245 + 12345;
+        unsigned r = seed >> 8;
+        int len = snprintf(buf, sizeof(buf), "%s%u_%u", prefixes[r % 5], (r >> 3) % 50000, (r >> 5) % 977);
+        keys[i] = malloc((size_t)len + 1);
+        memcpy(keys[i], buf, (size_t)len + 1);
+    }
+    return keys;
+}
+
+static void run(const char *name, char **keys, size_t n, int flags, int (*cmp)(const void *, const void *)) {
+    char **a = malloc(n * sizeof(*a));
+    memcpy(a, keys, n * sizeof(*a));
+    double t0 = now_sec();
+    qsort(a, n, sizeof(*a), cmp);
+    double t1 = now_sec();
+    memcpy(a, keys, n * sizeof(*a));
+    double t2 = now_sec();
+    str_sort(a, n, flags);
+    double t3 = now_sec();
+    printf("%-9s qsort %6.2f s   str_sort %6.2f s   speedup %.1fx\n", name, t1 - t0, t3 - t2,
+           (t1 - t0) / (t3 - t2));
+    free(a);
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? (size_t)atol(argv[1]) : 10000000;
+    char **keys = make_keys(n);
+    printf("%zu keys, %d threads\n", n, thread_pool_size());
+    run("bytewise", keys, n, 0, cmp_cstr);
+    run("natural", keys, n, STR_SORT_NATURAL, cmp_natural);
+    for (size_t i = 0; i < n; i++) free(keys[i]);
+    free(keys);
+    return 0;
+}
@@ -26,3 +26,152 @@ int to_upper(char c) {
 int to_lower(char c) {
     return tolower((unsigned char)c);
 }
+
+// ASCII class table; designated ranges keep it readable
+const unsigned char ascii_class_table[256] = {
+    ['\t'] = ASCII_SPACE, ['\n'] = ASCII_SPACE, ['\v'] = ASCII_SPACE,
+    ['\f'] = ASCII_SPACE, ['\r'] = ASCII_SPACE, [' '] = ASCII_SPACE,
+    ['!' ... '/'] = ASCII_PUNCT,
+    ['0' ... '9'] = ASCII_DIGIT | ASCII_XDIGIT,
+    [':' ... '@'] = ASCII_PUNCT,
+    ['A' ... 'F'] = ASCII_UPPER | ASCII_XDIGIT,
+    ['G' ... 'Z'] = ASCII_UPPER,
+    ['[' ... '`'] = ASCII_PUNCT,
+    ['a' ... 'f'] = ASCII_LOWER | ASCII_XDIGIT,
+    ['g' ... 'z'] = ASCII_LOWER,
+    ['{' ... '~'] = ASCII_PUNCT,
+};
+
+// Whole-buffer kernels work on 32 (AVX2) or 16 (SSE2) bytes at a time. A
+// byte range [lo, lo + n) is tested with one add and one signed compare:
+// adding 128 - lo moves the range to the bottom of the signed byte range.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ASCII_SIMD 1
+typedef __m256i ascii_vec;
+#define ASCII_VEC_BYTES 32
+#define ASCII_VEC_ALL 0xffffffffu
+#define vec_load(p) _mm256_loadu_si256((const __m256i *)(p))
+#define vec_store(p, v) _mm256_storeu_si256((__m256i *)(p), (v))
+#define vec_set1(c) _mm256_set1_epi8((char)(c))
+#define vec_and _mm256_and_si256
+#define vec_andnot _mm256_andnot_si256
+#define vec_or _mm256_or_si256
+#define vec_xor _mm256_xor_si256
+#define vec_add8 _mm256_add_epi8
+#define vec_cmpgt8 _mm256_cmpgt_epi8
+#define vec_cmpeq8 _mm256_cmpeq_epi8
+#define vec_movemask(v) ((uint32_t)_mm256_movemask_epi8(v))
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define ASCII_SIMD 1
+typedef __m128i ascii_vec;
+#define ASCII_VEC_BYTES 16
+#define ASCII_VEC_ALL 0xffffu
+#define vec_load(p) _mm_loadu_si128((const __m128i *)(p))
+#define vec_store(p, v) _mm_storeu_si128((__m128i *)(p), (v))
+#define vec_set1(c) _mm_set1_epi8((char)(c))
+#define vec_and _mm_and_si128
+#define vec_andnot _mm_andnot_si128
+#define vec_or _mm_or_si128
+#define vec_xor _mm_xor_si128
+#define vec_add8 _mm_add_epi8
+#define vec_cmpgt8 _mm_cmpgt_epi8
+#define vec_cmpeq8 _mm_cmpeq_epi8
+#define vec_movemask(v) ((uint32_t)_mm_movemask_epi8(v))
+#endif
+
+#ifdef ASCII_SIMD
+#include <stdint.h>
+
+// Internal helper: 0xff in each byte of v that lies in [lo, lo + n)
+static inline ascii_vec vec_in_range(ascii_vec v, int lo, int n) {
+    ascii_vec shifted = vec_add8(v, vec_set1(128 - lo));
+    return vec_cmpgt8(vec_set1(-128 + n), shifted);
+}
+
+// Internal helper: ascii_class_table applied to every byte of v
+static inline ascii_vec vec_classify(ascii_vec v) {
+    ascii_vec upper = vec_in_range(v, 'A', 26);
+    ascii_vec lower = vec_in_range(v, 'a', 26);
+    ascii_vec digit = vec_in_range(v, '0', 10);
+    ascii_vec space = vec_or(vec_cmpeq8(v, vec_set1(' ')), vec_in_range(v, '\t', 5));
+    ascii_vec hexal = vec_in_range(vec_or(v, vec_set1(0x20)), 'a', 6);
+    ascii_vec graph = vec_in_range(v, '!', 94);
+    ascii_vec punct = vec_andnot(vec_or(vec_or(upper, lower), digit), graph);
+    ascii_vec out = vec_and(upper, vec_set1(ASCII_UPPER));
+    out = vec_or(out, vec_and(lower, vec_set1(ASCII_LOWER)));
+    out = vec_or(out, vec_and(digit, vec_set1(ASCII_DIGIT | ASCII_XDIGIT)));
+    out = vec_or(out, vec_and(space, vec_set1(ASCII_SPACE)));
+    out = vec_or(out, vec_and(punct, vec_set1(ASCII_PUNCT)));
+    return vec_or(out, vec_and(hexal, vec_set1(ASCII_XDIGIT)));
+}
+
+// Internal helper: movemask of the bytes of v whose class intersects mask
+static inline uint32_t vec_class_mask(ascii_vec v, int mask) {
+    ascii_vec hit = vec_and(vec_classify(v), vec_set1(mask));
+    return ~vec_movemask(vec_cmpeq8(hit, vec_set1(0))) & ASCII_VEC_ALL;
+}
+#endif
+
+// Converts len bytes of s to ASCII uppercase in place
+void ascii_to_upper_buf(char *s, size_t len) {
+    size_t i = 0;
+#ifdef ASCII_SIMD
+    for (; i + ASCII_VEC_BYTES <= len; i += ASCII_VEC_BYTES) {
+        ascii_vec v = vec_load(s + i);
+        ascii_vec flip = vec_and(vec_in_range(v, 'a', 26), vec_set1(0x20));
+        vec_store(s + i, vec_xor(v, flip));
+    }
+#endif
+    for (; i < len; i++) s[i] = ascii_to_upper(s[i]);
+}
+
+// Converts len bytes of s to ASCII lowercase in place
+void ascii_to_lower_buf(char *s, size_t len) {
+    size_t i = 0;
+#ifdef ASCII_SIMD
+    for (; i + ASCII_VEC_BYTES <= len; i += ASCII_VEC_BYTES) {
+        ascii_vec v = vec_load(s + i);
+        ascii_vec flip = vec_and(vec_in_range(v, 'A', 26), vec_set1(0x20));
+        vec_store(s + i, vec_xor(v, flip));
+    }
+#endif
+    for (; i < len; i++) s[i] = ascii_to_lower(s[i]);
+}
+
+// Writes the ASCII_* class bits of each byte of s to out
+void ascii_classify_buf(const char *s, size_t len, unsigned char *out) {
+    size_t i = 0;
+#ifdef ASCII_SIMD
+    for (; i + ASCII_VEC_BYTES <= len; i += ASCII_VEC_BYTES) {
+        vec_store(out + i, vec_classify(vec_load(s + i)));
+    }
+#endif
+    for (; i < len; i++) out[i] = ascii_class_table[(unsigned char)s[i]];
+}
+
+// Returns the length of the leading run of bytes whose class intersects mask
+size_t ascii_span(const char *s, size_t len, int mask) {
+    size_t i = 0;
+#ifdef ASCII_SIMD
+    for (; i + ASCII_VEC_BYTES <= len; i += ASCII_VEC_BYTES) {
+        uint32_t miss = ~vec_class_mask(vec_load(s + i), mask) & ASCII_VEC_ALL;
+        if (miss) return i + (size_t)__builtin_ctz(miss);
+    }
+#endif
+    while (i < len && (ascii_class_table[(unsigned char)s[i]] & mask)) i++;
+    return i;
+}
+
+// Counts the bytes whose class bits intersect mask
+size_t ascii_count(const char *s, size_t len, int mask) {
+    size_t count = 0, i = 0;
+#ifdef ASCII_SIMD
+    for (; i + ASCII_VEC_BYTES <= len; i += ASCII_VEC_BYTES) {
+        count += (size_t)__builtin_popcount(vec_class_mask(vec_load(s + i), mask));
+    }
+#endif
+    for (; i < len; i++) count += (ascii_class_table[(unsigned char)s[i]] & mask) != 0;
+    return count;
+}
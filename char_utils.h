@@ -1,6 +1,8 @@
 #ifndef CHAR_UTILS_H
 #define CHAR_UTILS_H
 
+#include <stddef.h>
+
 // Character utility function prototypes will go here
 
 int is_alpha(char c);
@@ -10,4 +12,48 @@ int is_space(char c);
 int to_upper(char c);
 int to_lower(char c);
 
+// ASCII class bits stored in ascii_class_table; bytes >= 0x80 have none
+#define ASCII_UPPER  0x01
+#define ASCII_LOWER  0x02
+#define ASCII_DIGIT  0x04
+#define ASCII_SPACE  0x08
+#define ASCII_PUNCT  0x10
+#define ASCII_XDIGIT 0x20
+#define ASCII_ALPHA  (ASCII_UPPER | ASCII_LOWER)
+#define ASCII_ALNUM  (ASCII_ALPHA | ASCII_DIGIT)
+
+// Class bits of every byte value, matching <ctype.h> in the "C" locale
+extern const unsigned char ascii_class_table[256];
+
+// Locale-free single-character helpers: one table load, inlined so they
+// cost no more than the ctype macros they replace in hot loops
+static inline int ascii_is_alpha(char c) { return ascii_class_table[(unsigned char)c] & ASCII_ALPHA; }
+static inline int ascii_is_digit(char c) { return ascii_class_table[(unsigned char)c] & ASCII_DIGIT; }
+static inline int ascii_is_alnum(char c) { return ascii_class_table[(unsigned char)c] & ASCII_ALNUM; }
+static inline int ascii_is_space(char c) { return ascii_class_table[(unsigned char)c] & ASCII_SPACE; }
+static inline int ascii_is_upper(char c) { return ascii_class_table[(unsigned char)c] & ASCII_UPPER; }
+static inline int ascii_is_lower(char c) { return ascii_class_table[(unsigned char)c] & ASCII_LOWER; }
+static inline int ascii_is_punct(char c) { return ascii_class_table[(unsigned char)c] & ASCII_PUNCT; }
+static inline int ascii_is_xdigit(char c) { return ascii_class_table[(unsigned char)c] & ASCII_XDIGIT; }
+
+// Locale-free case conversion of one character; non-letters pass through
+static inline char ascii_to_upper(char c) { return (char)(c ^ (ascii_is_lower(c) ? 0x20 : 0)); }
+static inline char ascii_to_lower(char c) { return (char)(c ^ (ascii_is_upper(c) ? 0x20 : 0)); }
+
+// Converts len bytes of s to ASCII uppercase in place
+void ascii_to_upper_buf(char *s, size_t len);
+
+// Converts len bytes of s to ASCII lowercase in place
+void ascii_to_lower_buf(char *s, size_t len);
+
+// Writes the ASCII_* class bits of each of the len bytes of s to out
+void ascii_classify_buf(const char *s, size_t len, unsigned char *out);
+
+// Returns the length of the leading run of bytes in s whose class bits
+// intersect mask (e.g. ASCII_DIGIT, ASCII_ALNUM)
+size_t ascii_span(const char *s, size_t len, int mask);
+
+// Counts the bytes in s whose class bits intersect mask
+size_t ascii_count(const char *s, size_t len, int mask);
+
 #endif // CHAR_UTILS_H
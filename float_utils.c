@@ -1,8 +1,21 @@
 #include "float_utils.h"
+#include <float.h>
 #include <math.h>
+#include <stdint.h>
+#include <string.h>
 
 // Float utility function implementations will go here
 
+// Batch kernels choose AVX/AVX2 or SSE4.1 at run time, with scalar loops
+// for tails and other CPUs
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FLOAT_X86 1
+#define FLOAT_HAS_AVX2() __builtin_cpu_supports("avx2")
+#define FLOAT_HAS_AVX() __builtin_cpu_supports("avx")
+#define FLOAT_HAS_SSE41() __builtin_cpu_supports("sse4.1")
+#endif
+
 double float_abs(double x) {
     return x < 0 ? -x : x;
 }
@@ -30,3 +43,321 @@ double float_ceil(double x) {
 double float_pow(double base, double exp) {
     return pow(base, exp);
 }
+
+#ifdef FLOAT_X86
+#define FLOAT_TRUNC (_MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC)
+#define FLOAT_FLOOR (_MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC)
+#define FLOAT_CEIL (_MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC)
+
+// Internal helper: round() semantics (halfway cases away from zero), which
+// the rounding instructions lack. x - trunc(x) is exact, so the halfway
+// test never misrounds values like 0.49999999999999994.
+__attribute__((target("avx")))
+static inline __m256d float_round_away_avx(__m256d x) {
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    __m256d t = _mm256_round_pd(x, FLOAT_TRUNC);
+    __m256d frac = _mm256_andnot_pd(sign, _mm256_sub_pd(x, t));
+    __m256d step = _mm256_or_pd(_mm256_and_pd(x, sign), _mm256_set1_pd(1.0));
+    // Blend rather than add zero so that -0.3 still rounds to -0.0
+    return _mm256_blendv_pd(t, _mm256_add_pd(t, step),
+                            _mm256_cmp_pd(frac, _mm256_set1_pd(0.5), _CMP_GE_OQ));
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128d float_round_away_sse41(__m128d x) {
+    const __m128d sign = _mm_set1_pd(-0.0);
+    __m128d t = _mm_round_pd(x, FLOAT_TRUNC);
+    __m128d frac = _mm_andnot_pd(sign, _mm_sub_pd(x, t));
+    __m128d step = _mm_or_pd(_mm_and_pd(x, sign), _mm_set1_pd(1.0));
+    return _mm_blendv_pd(t, _mm_add_pd(t, step), _mm_cmpge_pd(frac, _mm_set1_pd(0.5)));
+}
+
+#define FLOAT_FLOOR_AVX(x) _mm256_round_pd(x, FLOAT_FLOOR)
+#define FLOAT_CEIL_AVX(x) _mm256_round_pd(x, FLOAT_CEIL)
+#define FLOAT_FLOOR_SSE41(x) _mm_round_pd(x, FLOAT_FLOOR)
+#define FLOAT_CEIL_SSE41(x) _mm_round_pd(x, FLOAT_CEIL)
+
+// Internal helper: generates name(src, dst, n) from an AVX and an SSE4.1
+// rounding operation plus the libm function for tails
+#define FLOAT_DEFINE_ROUND(name, avx_op, sse41_op, scalar_op)                   \
+    __attribute__((target("avx")))                                              \
+    static size_t name##_avx(const double *src, double *dst, size_t n) {        \
+        size_t i = 0;                                                           \
+        for (; i + 4 <= n; i += 4)                                              \
+            _mm256_storeu_pd(dst + i, avx_op(_mm256_loadu_pd(src + i)));        \
+        return i;                                                               \
+    }                                                                           \
+    __attribute__((target("sse4.1")))                                           \
+    static size_t name##_sse41(const double *src, double *dst, size_t n) {      \
+        size_t i = 0;                                                           \
+        for (; i + 2 <= n; i += 2)                                              \
+            _mm_storeu_pd(dst + i, sse41_op(_mm_loadu_pd(src + i)));            \
+        return i;                                                               \
+    }                                                                           \
+    void name(const double *src, double *dst, size_t n) {                       \
+        size_t i = FLOAT_HAS_AVX() ? name##_avx(src, dst, n)                    \
+                 : FLOAT_HAS_SSE41() ? name##_sse41(src, dst, n) : 0;           \
+        for (; i < n; i++) dst[i] = scalar_op(src[i]);                          \
+    }
+#else
+#define FLOAT_DEFINE_ROUND(name, avx_op, sse41_op, scalar_op)                   \
+    void name(const double *src, double *dst, size_t n) {                       \
+        for (size_t i = 0; i < n; i++) dst[i] = scalar_op(src[i]);              \
+    }
+#endif
+
+FLOAT_DEFINE_ROUND(float_round_array, float_round_away_avx, float_round_away_sse41, round)
+FLOAT_DEFINE_ROUND(float_floor_array, FLOAT_FLOOR_AVX, FLOAT_FLOOR_SSE41, floor)
+FLOAT_DEFINE_ROUND(float_ceil_array, FLOAT_CEIL_AVX, FLOAT_CEIL_SSE41, ceil)
+
+// The fast exp and log follow fdlibm's reductions and polynomials, which
+// keep both within 1 ULP; the AVX2 kernels below compute the same
+// expressions lane by lane
+static const double FLOAT_LN2_HI = 6.93147180369123816490e-01;
+static const double FLOAT_LN2_LO = 1.90821492927058770002e-10;
+static const double FLOAT_SQRT2 = 1.41421356237309504880e+00;
+static const double FLOAT_LOG2E = 1.44269504088896338700e+00;
+// Adding then subtracting this rounds a double of magnitude below 2^51 to
+// an integer, and leaves that integer in the low bits of the sum
+static const double FLOAT_ROUND_MAGIC = 0x1.8p52;
+// exp is computed in-line only strictly inside this range, where the
+// result is a finite normal double
+static const double FLOAT_EXP_MIN = -708.0;
+static const double FLOAT_EXP_MAX = 709.0;
+
+static const double FLOAT_EXP_P1 = 1.66666666666666019037e-01;
+static const double FLOAT_EXP_P2 = -2.77777777770155933842e-03;
+static const double FLOAT_EXP_P3 = 6.61375632143793436117e-05;
+static const double FLOAT_EXP_P4 = -1.65339022054652515390e-06;
+static const double FLOAT_EXP_P5 = 4.13813679705723846039e-08;
+
+static const double FLOAT_LOG_LG1 = 6.666666666666735130e-01;
+static const double FLOAT_LOG_LG2 = 3.999999999940941908e-01;
+static const double FLOAT_LOG_LG3 = 2.857142874366239149e-01;
+static const double FLOAT_LOG_LG4 = 2.222219843214978396e-01;
+static const double FLOAT_LOG_LG5 = 1.818357216161805012e-01;
+static const double FLOAT_LOG_LG6 = 1.531383769920937332e-01;
+static const double FLOAT_LOG_LG7 = 1.479819860511658591e-01;
+
+// Internal helper: exp(x) for x inside (FLOAT_EXP_MIN, FLOAT_EXP_MAX)
+static inline double float_exp_core(double x) {
+    // x = k*ln2 + r with |r| <= ln2/2
+    double kd = x * FLOAT_LOG2E + FLOAT_ROUND_MAGIC;
+    uint64_t kbits;
+    memcpy(&kbits, &kd, sizeof(kbits));
+    kd -= FLOAT_ROUND_MAGIC;
+    double hi = x - kd * FLOAT_LN2_HI, lo = kd * FLOAT_LN2_LO, r = hi - lo;
+    double t = r * r;
+    double c = r - t * (FLOAT_EXP_P1 + t * (FLOAT_EXP_P2 + t * (FLOAT_EXP_P3 +
+               t * (FLOAT_EXP_P4 + t * FLOAT_EXP_P5))));
+    double y = 1.0 - ((lo - (r * c) / (2.0 - c)) - hi);
+    // 2^k from the integer left in the low bits of kbits; the rounding
+    // constant's own bits shift out
+    uint64_t sbits = (kbits + 1023) << 52;
+    double scale;
+    memcpy(&scale, &sbits, sizeof(scale));
+    return y * scale;
+}
+
+// Internal helper: log(x) for positive normal finite x
+static inline double float_log_core(double x) {
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    double k = (double)(int)(bits >> 52) - 1023;
+    // x = 2^k * m with m in [sqrt(2)/2, sqrt(2))
+    bits = (bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL;
+    double m;
+    memcpy(&m, &bits, sizeof(m));
+    if (m > FLOAT_SQRT2) {
+        m *= 0.5;
+        k += 1.0;
+    }
+    double f = m - 1.0, s = f / (2.0 + f), z = s * s, w = z * z;
+    double t1 = w * (FLOAT_LOG_LG2 + w * (FLOAT_LOG_LG4 + w * FLOAT_LOG_LG6));
+    double t2 = z * (FLOAT_LOG_LG1 + w * (FLOAT_LOG_LG3 + w * (FLOAT_LOG_LG5 + w * FLOAT_LOG_LG7)));
+    double hfsq = 0.5 * f * f;
+    return k * FLOAT_LN2_HI - ((hfsq - (s * (hfsq + t1 + t2) + k * FLOAT_LN2_LO)) - f);
+}
+
+// Internal helper: exp in FLOAT_FAST mode for one value
+static double float_exp_fast(double x) {
+    if (!(x > FLOAT_EXP_MIN && x < FLOAT_EXP_MAX)) return exp(x);
+    return float_exp_core(x);
+}
+
+// Internal helper: log in FLOAT_FAST mode for one value
+static double float_log_fast(double x) {
+    if (!(x >= DBL_MIN && x <= DBL_MAX)) return log(x);
+    return float_log_core(x);
+}
+
+// Internal helper: pow in FLOAT_FAST mode for one value
+static double float_pow_fast(double base, double exp) {
+    if (!(base >= DBL_MIN && base <= DBL_MAX)) return pow(base, exp);
+    double t = exp * float_log_core(base);
+    if (!(t > FLOAT_EXP_MIN && t < FLOAT_EXP_MAX)) return pow(base, exp);
+    return float_exp_core(t);
+}
+
+#ifdef FLOAT_X86
+// Internal helper: float_exp_core on four lanes
+__attribute__((target("avx2")))
+static inline __m256d float_exp_avx2(__m256d x) {
+    const __m256d magic = _mm256_set1_pd(FLOAT_ROUND_MAGIC);
+    __m256d kd = _mm256_add_pd(_mm256_mul_pd(x, _mm256_set1_pd(FLOAT_LOG2E)), magic);
+    __m256i kbits = _mm256_castpd_si256(kd);
+    kd = _mm256_sub_pd(kd, magic);
+    __m256d hi = _mm256_sub_pd(x, _mm256_mul_pd(kd, _mm256_set1_pd(FLOAT_LN2_HI)));
+    __m256d lo = _mm256_mul_pd(kd, _mm256_set1_pd(FLOAT_LN2_LO));
+    __m256d r = _mm256_sub_pd(hi, lo);
+    __m256d t = _mm256_mul_pd(r, r);
+    __m256d p = _mm256_add_pd(_mm256_set1_pd(FLOAT_EXP_P4), _mm256_mul_pd(t, _mm256_set1_pd(FLOAT_EXP_P5)));
+    p = _mm256_add_pd(_mm256_set1_pd(FLOAT_EXP_P3), _mm256_mul_pd(t, p));
+    p = _mm256_add_pd(_mm256_set1_pd(FLOAT_EXP_P2), _mm256_mul_pd(t, p));
+    p = _mm256_add_pd(_mm256_set1_pd(FLOAT_EXP_P1), _mm256_mul_pd(t, p));
+    __m256d c = _mm256_sub_pd(r, _mm256_mul_pd(t, p));
+    __m256d q = _mm256_div_pd(_mm256_mul_pd(r, c), _mm256_sub_pd(_mm256_set1_pd(2.0), c));
+    __m256d y = _mm256_sub_pd(_mm256_set1_pd(1.0), _mm256_sub_pd(_mm256_sub_pd(lo, q), hi));
+    __m256i sbits = _mm256_slli_epi64(_mm256_add_epi64(kbits, _mm256_set1_epi64x(1023)), 52);
+    return _mm256_mul_pd(y, _mm256_castsi256_pd(sbits));
+}
+
+// Internal helper: float_log_core on four lanes
+__attribute__((target("avx2")))
+static inline __m256d float_log_avx2(__m256d x) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    __m256i bits = _mm256_castpd_si256(x);
+    // Biased exponent to double via the 2^52 bit-pattern trick
+    __m256i ebits = _mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_set1_epi64x(0x4330000000000000LL));
+    __m256d k = _mm256_sub_pd(_mm256_castsi256_pd(ebits), _mm256_set1_pd(0x1p52 + 1023));
+    bits = _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000fffffffffffffLL)),
+                           _mm256_set1_epi64x(0x3ff0000000000000LL));
+    __m256d m = _mm256_castsi256_pd(bits);
+    __m256d big = _mm256_cmp_pd(m, _mm256_set1_pd(FLOAT_SQRT2), _CMP_GT_OQ);
+    m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), big);
+    k = _mm256_add_pd(k, _mm256_and_pd(big, one));
+    __m256d f = _mm256_sub_pd(m, one);
+    __m256d s = _mm256_div_pd(f, _mm256_add_pd(_mm256_set1_pd(2.0), f));
+    __m256d z = _mm256_mul_pd(s, s), w = _mm256_mul_pd(z, z);
+    __m256d t1 = _mm256_add_pd(_mm256_set1_pd(FLOAT_LOG_LG4), _mm256_mul_pd(w, _mm256_set1_pd(FLOAT_LOG_LG6)));
+    t1 = _mm256_mul_pd(w, _mm256_add_pd(_mm256_set1_pd(FLOAT_LOG_LG2), _mm256_mul_pd(w, t1)));
+    __m256d t2 = _mm256_add_pd(_mm256_set1_pd(FLOAT_LOG_LG5), _mm256_mul_pd(w, _mm256_set1_pd(FLOAT_LOG_LG7)));
+    t2 = _mm256_add_pd(_mm256_set1_pd(FLOAT_LOG_LG3), _mm256_mul_pd(w, t2));
+    t2 = _mm256_mul_pd(z, _mm256_add_pd(_mm256_set1_pd(FLOAT_LOG_LG1), _mm256_mul_pd(w, t2)));
+    __m256d hfsq = _mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(0.5), f), f);
+    __m256d inner = _mm256_add_pd(_mm256_mul_pd(s, _mm256_add_pd(_mm256_add_pd(hfsq, t1), t2)),
+                                  _mm256_mul_pd(k, _mm256_set1_pd(FLOAT_LN2_LO)));
+    return _mm256_sub_pd(_mm256_mul_pd(k, _mm256_set1_pd(FLOAT_LN2_HI)),
+                         _mm256_sub_pd(_mm256_sub_pd(hfsq, inner), f));
+}
+
+// Internal helper: all-ones lanes where lo < x < hi (false for NaN)
+__attribute__((target("avx2")))
+static inline __m256d float_inside_avx2(__m256d x, double lo, double hi) {
+    return _mm256_and_pd(_mm256_cmp_pd(x, _mm256_set1_pd(lo), _CMP_GT_OQ),
+                         _mm256_cmp_pd(x, _mm256_set1_pd(hi), _CMP_LT_OQ));
+}
+
+// The kernels below redo the few lanes outside the polynomial's range one
+// at a time, from saved inputs since dst may alias them
+
+__attribute__((target("avx2")))
+static size_t float_exp_fast_avx2(const double *src, double *dst, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(src + i);
+        int ok = _mm256_movemask_pd(float_inside_avx2(x, FLOAT_EXP_MIN, FLOAT_EXP_MAX));
+        __m256d r = float_exp_avx2(x);
+        if (ok == 0xf) {
+            _mm256_storeu_pd(dst + i, r);
+            continue;
+        }
+        double in[4];
+        _mm256_storeu_pd(in, x);
+        _mm256_storeu_pd(dst + i, r);
+        for (int j = 0; j < 4; j++)
+            if (!(ok >> j & 1)) dst[i + j] = exp(in[j]);
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t float_log_fast_avx2(const double *src, double *dst, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(src + i);
+        int ok = _mm256_movemask_pd(float_inside_avx2(x, DBL_MIN, INFINITY));
+        __m256d r = float_log_avx2(x);
+        if (ok == 0xf) {
+            _mm256_storeu_pd(dst + i, r);
+            continue;
+        }
+        double in[4];
+        _mm256_storeu_pd(in, x);
+        _mm256_storeu_pd(dst + i, r);
+        for (int j = 0; j < 4; j++)
+            if (!(ok >> j & 1)) dst[i + j] = float_log_fast(in[j]);
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t float_pow_fast_avx2(const double *base, const double *exp, double *dst, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d b = _mm256_loadu_pd(base + i), e = _mm256_loadu_pd(exp + i);
+        __m256d t = _mm256_mul_pd(e, float_log_avx2(b));
+        int ok = _mm256_movemask_pd(_mm256_and_pd(float_inside_avx2(b, DBL_MIN, INFINITY),
+                                                  float_inside_avx2(t, FLOAT_EXP_MIN, FLOAT_EXP_MAX)));
+        __m256d r = float_exp_avx2(t);
+        if (ok == 0xf) {
+            _mm256_storeu_pd(dst + i, r);
+            continue;
+        }
+        double in_b[4], in_e[4];
+        _mm256_storeu_pd(in_b, b);
+        _mm256_storeu_pd(in_e, e);
+        _mm256_storeu_pd(dst + i, r);
+        for (int j = 0; j < 4; j++)
+            if (!(ok >> j & 1)) dst[i + j] = float_pow_fast(in_b[j], in_e[j]);
+    }
+    return i;
+}
+#endif
+
+void float_exp_array(const double *src, double *dst, size_t n, float_mode mode) {
+    size_t i = 0;
+    if (mode == FLOAT_EXACT) {
+        for (; i < n; i++) dst[i] = exp(src[i]);
+        return;
+    }
+#ifdef FLOAT_X86
+    if (FLOAT_HAS_AVX2()) i = float_exp_fast_avx2(src, dst, n);
+#endif
+    for (; i < n; i++) dst[i] = float_exp_fast(src[i]);
+}
+
+void float_log_array(const double *src, double *dst, size_t n, float_mode mode) {
+    size_t i = 0;
+    if (mode == FLOAT_EXACT) {
+        for (; i < n; i++) dst[i] = log(src[i]);
+        return;
+    }
+#ifdef FLOAT_X86
+    if (FLOAT_HAS_AVX2()) i = float_log_fast_avx2(src, dst, n);
+#endif
+    for (; i < n; i++) dst[i] = float_log_fast(src[i]);
+}
+
+void float_pow_array(const double *base, const double *exp, double *dst, size_t n,
+                     float_mode mode) {
+    size_t i = 0;
+    if (mode == FLOAT_EXACT) {
+        for (; i < n; i++) dst[i] = pow(base[i], exp[i]);
+        return;
+    }
+#ifdef FLOAT_X86
+    if (FLOAT_HAS_AVX2()) i = float_pow_fast_avx2(base, exp, dst, n);
+#endif
+    for (; i < n; i++) dst[i] = float_pow_fast(base[i], exp[i]);
+}
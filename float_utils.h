@@ -1,6 +1,8 @@
 #ifndef FLOAT_UTILS_H
 #define FLOAT_UTILS_H
 
+#include <stddef.h>
+
 // Float utility function prototypes will go here
 
 double float_abs(double x);
@@ -11,4 +13,34 @@ double float_floor(double x);
 double float_ceil(double x);
 double float_pow(double base, double exp);
 
+// Accuracy modes for the batch exp/log/pow functions
+typedef enum {
+    FLOAT_EXACT,    // libm exp, log and pow
+    FLOAT_FAST      // vectorized approximations, see float_exp_array
+} float_mode;
+
+// Rounds n values of src into dst exactly like round, floor and ceil,
+// using AVX or SSE4.1 rounding instructions when the CPU has them. dst
+// may be src.
+void float_round_array(const double *src, double *dst, size_t n);
+void float_floor_array(const double *src, double *dst, size_t n);
+void float_ceil_array(const double *src, double *dst, size_t n);
+
+// exp, log and pow over n values into dst (dst may alias an input), in
+// the accuracy chosen by mode. FLOAT_FAST evaluates fdlibm-style
+// polynomials four lanes at a time with AVX2, without libm's errno and
+// special-case handling; inputs whose result would overflow, underflow
+// to a subnormal, or be a special value (NaN, infinity, zero or negative
+// log argument) are passed to libm, so those cases match it exactly.
+// FLOAT_FAST error bounds:
+//   exp: under 1 ULP
+//   log: under 1 ULP
+//   pow: computed as exp(exp * log(base)) for base > 0, so the error grows
+//        with that product: at most 2 * (1 + |exp * log(base)|) ULP, which
+//        is under 16 ULP for results between 0.001 and 1000
+void float_exp_array(const double *src, double *dst, size_t n, float_mode mode);
+void float_log_array(const double *src, double *dst, size_t n, float_mode mode);
+void float_pow_array(const double *base, const double *exp, double *dst, size_t n,
+                     float_mode mode);
+
 #endif // FLOAT_UTILS_H
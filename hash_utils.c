@@ -0,0 +1,327 @@
+#include "hash_utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// wyhash (final version 4) mixing constants
+#define HASH_P0 0x2d358dccaa6c78a5ULL
+#define HASH_P1 0x8bb84b93962eacc9ULL
+#define HASH_P2 0x4b33a62ed433d4a3ULL
+#define HASH_P3 0x4d5a2da51de1aa47ULL
+
+// Internal helper: 64x64 -> 128-bit multiply, returned as (lo, hi)
+static inline void hash_mum(uint64_t *a, uint64_t *b) {
+    __uint128_t r = (__uint128_t)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+}
+
+// Internal helper: multiplies and folds the 128-bit product to 64 bits
+static inline uint64_t hash_mix(uint64_t a, uint64_t b) {
+    hash_mum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t hash_r8(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t hash_r4(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+// Internal helper: packs 1-3 bytes (first, middle, last) into a word
+static inline uint64_t hash_r3(const uint8_t *p, size_t k) {
+    return ((uint64_t)p[0] << 16) | ((uint64_t)p[k >> 1] << 8) | p[k - 1];
+}
+
+// Returns a 64-bit hash of len bytes at key
+uint64_t hash_bytes(const void *key, size_t len, uint64_t seed) {
+    const uint8_t *p = key;
+    uint64_t a, b;
+    seed ^= hash_mix(seed ^ HASH_P0, HASH_P1);
+    if (len <= 16) {
+        if (len >= 4) {
+            // Two overlapping 4-byte reads from each end cover 4-16 bytes
+            size_t mid = (len >> 3) << 2;
+            a = (hash_r4(p) << 32) | hash_r4(p + mid);
+            b = (hash_r4(p + len - 4) << 32) | hash_r4(p + len - 4 - mid);
+        } else if (len > 0) {
+            a = hash_r3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i > 48) {
+            // Three independent lanes keep the multipliers busy
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = hash_mix(hash_r8(p) ^ HASH_P1, hash_r8(p + 8) ^ seed);
+                see1 = hash_mix(hash_r8(p + 16) ^ HASH_P2, hash_r8(p + 24) ^ see1);
+                see2 = hash_mix(hash_r8(p + 32) ^ HASH_P3, hash_r8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = hash_mix(hash_r8(p) ^ HASH_P1, hash_r8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = hash_r8(p + i - 16);
+        b = hash_r8(p + i - 8);
+    }
+    a ^= HASH_P1;
+    b ^= seed;
+    hash_mum(&a, &b);
+    return hash_mix(a ^ HASH_P0 ^ len, b ^ HASH_P1);
+}
+
+// Returns hash_bytes of a NUL-terminated string
+uint64_t hash_cstr(const char *s, uint64_t seed) {
+    return hash_bytes(s, strlen(s), seed);
+}
+
+// Returns a well-mixed 64-bit hash of an integer (splitmix64 finalizer)
+uint64_t hash_u64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Control byte values; a full slot stores the low 7 bits of its hash, so the
+// high bit alone separates full slots from free ones
+#define HASH_CTRL_EMPTY   0x80
+#define HASH_CTRL_DELETED 0xfe
+
+#define HASH_MAP_MIN_CAP 16
+
+// Internal helper: bit i set where group byte i equals b
+static inline unsigned hash_group_match(const uint8_t *g, uint8_t b) {
+#if defined(__SSE2__)
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)g);
+    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)b)));
+#else
+    unsigned mask = 0;
+    for (int i = 0; i < HASH_MAP_GROUP; i++) mask |= (unsigned)(g[i] == b) << i;
+    return mask;
+#endif
+}
+
+// Internal helper: bit i set where group byte i is empty or deleted
+static inline unsigned hash_group_free(const uint8_t *g) {
+#if defined(__SSE2__)
+    return (unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)g));
+#else
+    unsigned mask = 0;
+    for (int i = 0; i < HASH_MAP_GROUP; i++) mask |= (unsigned)(g[i] >> 7) << i;
+    return mask;
+#endif
+}
+
+// Initializes an empty map; the table is allocated on first insert
+void hash_map_init(hash_map *m) {
+    m->ctrl = NULL;
+    m->slots = NULL;
+    m->cap = 0;
+    m->count = 0;
+    m->tombstones = 0;
+    arena_init(&m->keys, 0);
+}
+
+// Releases the map and its keys
+void hash_map_free(hash_map *m) {
+    free(m->ctrl);
+    free(m->slots);
+    arena_free(&m->keys);
+    hash_map_init(m);
+}
+
+// Removes every entry but keeps the table's capacity
+void hash_map_clear(hash_map *m) {
+    if (m->ctrl) memset(m->ctrl, HASH_CTRL_EMPTY, m->cap);
+    m->count = 0;
+    m->tombstones = 0;
+    arena_reset(&m->keys);
+}
+
+// Internal helper: returns the slot index of key, or (size_t)-1. Groups are
+// visited in triangular order, which covers every group of a power-of-two
+// table.
+static size_t hash_map_lookup(const hash_map *m, str_view key, uint64_t h) {
+    if (!m->cap) return (size_t)-1;
+    size_t gmask = m->cap / HASH_MAP_GROUP - 1;
+    size_t g = (h >> 7) & gmask;
+    uint8_t h2 = h & 0x7f;
+    uint32_t h1 = (uint32_t)(h >> 7);
+    for (size_t step = 1;; step++) {
+        const uint8_t *ctrl = m->ctrl + g * HASH_MAP_GROUP;
+        unsigned match = hash_group_match(ctrl, h2);
+        while (match) {
+            size_t i = g * HASH_MAP_GROUP + (size_t)__builtin_ctz(match);
+            const hash_map_entry *e = &m->slots[i];
+            if (e->hash == h1 && e->len == key.len && memcmp(e->key, key.data, key.len) == 0) return i;
+            match &= match - 1;
+        }
+        // An empty slot ends the chain: the key would have been placed there
+        if (hash_group_match(ctrl, HASH_CTRL_EMPTY)) return (size_t)-1;
+        if (step > gmask) return (size_t)-1;
+        g = (g + step) & gmask;
+    }
+}
+
+// Internal helper: returns the first free slot on the probe sequence of a
+// key whose hash is h1 << 7 | h2
+static size_t hash_map_find_free(const hash_map *m, uint32_t h1) {
+    size_t gmask = m->cap / HASH_MAP_GROUP - 1;
+    size_t g = h1 & gmask;
+    for (size_t step = 1;; step++) {
+        unsigned free_mask = hash_group_free(m->ctrl + g * HASH_MAP_GROUP);
+        if (free_mask) return g * HASH_MAP_GROUP + (size_t)__builtin_ctz(free_mask);
+        g = (g + step) & gmask;
+    }
+}
+
+// Internal helper: rebuilds the table with cap slots, dropping tombstones
+static int hash_map_rehash(hash_map *m, size_t cap) {
+    uint8_t *old_ctrl = m->ctrl;
+    hash_map_entry *old_slots = m->slots;
+    size_t old_cap = m->cap;
+    uint8_t *ctrl = malloc(cap);
+    hash_map_entry *slots = malloc(cap * sizeof(*slots));
+    if (!ctrl || !slots) {
+        free(ctrl);
+        free(slots);
+        return -1;
+    }
+    memset(ctrl, HASH_CTRL_EMPTY, cap);
+    m->ctrl = ctrl;
+    m->slots = slots;
+    m->cap = cap;
+    m->tombstones = 0;
+    for (size_t i = 0; i < old_cap; i++) {
+        if (old_ctrl[i] & 0x80) continue;
+        size_t j = hash_map_find_free(m, old_slots[i].hash);
+        ctrl[j] = old_ctrl[i];
+        slots[j] = old_slots[i];
+    }
+    free(old_ctrl);
+    free(old_slots);
+    return 0;
+}
+
+// Internal helper: smallest table that holds n entries at most 7/8 full
+static size_t hash_map_cap_for(size_t n) {
+    size_t cap = HASH_MAP_MIN_CAP;
+    while (cap / 8 * 7 < n) cap *= 2;
+    return cap;
+}
+
+// Makes room for n entries without rehashing
+int hash_map_reserve(hash_map *m, size_t n) {
+    size_t cap = hash_map_cap_for(n);
+    if (cap <= m->cap) return 0;
+    return hash_map_rehash(m, cap);
+}
+
+// Returns the entry for key, or NULL if it is not present
+hash_map_entry *hash_map_find(const hash_map *m, str_view key) {
+    size_t i = hash_map_lookup(m, key, hash_bytes(key.data, key.len, 0));
+    return i == (size_t)-1 ? NULL : &m->slots[i];
+}
+
+// Returns the entry for key, inserting it with value 0 if needed
+hash_map_entry *hash_map_upsert(hash_map *m, str_view key, int *inserted) {
+    uint64_t h = hash_bytes(key.data, key.len, 0);
+    size_t i = hash_map_lookup(m, key, h);
+    if (inserted) *inserted = i == (size_t)-1;
+    if (i != (size_t)-1) return &m->slots[i];
+    if (key.len > UINT32_MAX) return NULL;
+
+    if (m->count + m->tombstones + 1 > m->cap / 8 * 7) {
+        // Double when genuinely full; rebuild at the same size when most of
+        // the load is tombstones
+        size_t cap = m->count + 1 > m->cap / 8 * 7
+                   ? (m->cap ? m->cap * 2 : HASH_MAP_MIN_CAP)
+                   : m->cap;
+        if (hash_map_rehash(m, cap) != 0) return NULL;
+    }
+    char *copy = arena_alloc_aligned(&m->keys, key.len + 1, 1);
+    if (!copy) return NULL;
+    memcpy(copy, key.data, key.len);
+    copy[key.len] = '\0';
+
+    i = hash_map_find_free(m, (uint32_t)(h >> 7));
+    if (m->ctrl[i] == HASH_CTRL_DELETED) m->tombstones--;
+    m->ctrl[i] = h & 0x7f;
+    hash_map_entry *e = &m->slots[i];
+    e->key = copy;
+    e->len = (uint32_t)key.len;
+    e->hash = (uint32_t)(h >> 7);
+    e->value = 0;
+    m->count++;
+    return e;
+}
+
+// Sets key to value
+int hash_map_put(hash_map *m, str_view key, uint64_t value) {
+    hash_map_entry *e = hash_map_upsert(m, key, NULL);
+    if (!e) return -1;
+    e->value = value;
+    return 0;
+}
+
+// Stores the value for key in *value, returns 1 if found, 0 otherwise
+int hash_map_get(const hash_map *m, str_view key, uint64_t *value) {
+    hash_map_entry *e = hash_map_find(m, key);
+    if (!e) return 0;
+    *value = e->value;
+    return 1;
+}
+
+// Removes key, returns 1 if it was present, 0 otherwise
+int hash_map_remove(hash_map *m, str_view key) {
+    size_t i = hash_map_lookup(m, key, hash_bytes(key.data, key.len, 0));
+    if (i == (size_t)-1) return 0;
+    // If the group still has an empty slot, every probe through it already
+    // stops here, so the slot can become empty instead of a tombstone
+    const uint8_t *group = m->ctrl + (i & ~(size_t)(HASH_MAP_GROUP - 1));
+    if (hash_group_match(group, HASH_CTRL_EMPTY)) {
+        m->ctrl[i] = HASH_CTRL_EMPTY;
+    } else {
+        m->ctrl[i] = HASH_CTRL_DELETED;
+        m->tombstones++;
+    }
+    m->count--;
+    return 1;
+}
+
+// Iterates over entries in slot order
+hash_map_entry *hash_map_next(const hash_map *m, size_t *pos) {
+    size_t i = *pos;
+    while (i < m->cap) {
+        size_t base = i & ~(size_t)(HASH_MAP_GROUP - 1);
+        unsigned full = ~hash_group_free(m->ctrl + base) & 0xffffu;
+        full &= ~0u << (i - base);
+        if (full) {
+            i = base + (size_t)__builtin_ctz(full);
+            *pos = i + 1;
+            return &m->slots[i];
+        }
+        i = base + HASH_MAP_GROUP;
+    }
+    *pos = m->cap;
+    return NULL;
+}
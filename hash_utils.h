@@ -0,0 +1,81 @@
+#ifndef HASH_UTILS_H
+#define HASH_UTILS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "arena_utils.h"
+#include "string_utils.h"
+
+// Returns a 64-bit hash of len bytes at key (wyhash construction: 128-bit
+// multiply-fold mixing, 48 bytes per step for long keys). Different seeds
+// give independent hash functions. Not cryptographic.
+uint64_t hash_bytes(const void *key, size_t len, uint64_t seed);
+
+// Returns hash_bytes of a NUL-terminated string
+uint64_t hash_cstr(const char *s, uint64_t seed);
+
+// Returns a well-mixed 64-bit hash of an integer
+uint64_t hash_u64(uint64_t x);
+
+// Slots examined per probe step; one SSE2 compare covers a whole group
+#define HASH_MAP_GROUP 16
+
+// One slot of a hash map (24 bytes). key points into the map's arena and is
+// NUL-terminated; hash keeps the hash bits the control byte does not.
+typedef struct {
+    const char *key;
+    uint32_t len;
+    uint32_t hash;
+    uint64_t value;
+} hash_map_entry;
+
+// An open-addressing map from byte-string keys to uint64_t values, laid out
+// as a Swiss table: a control byte per slot holds 7 bits of the hash, so a
+// probe compares a group of 16 slots at once and only touches entries whose
+// control byte matches. Keys are copied into the map's arena. Entry pointers
+// are invalidated by inserts; key pointers stay valid until hash_map_free.
+// Not thread-safe.
+typedef struct {
+    uint8_t *ctrl;
+    hash_map_entry *slots;
+    size_t cap;
+    size_t count;
+    size_t tombstones;
+    arena keys;
+} hash_map;
+
+// Initializes an empty map
+void hash_map_init(hash_map *m);
+
+// Releases the map and its keys
+void hash_map_free(hash_map *m);
+
+// Removes every entry but keeps the table's capacity
+void hash_map_clear(hash_map *m);
+
+// Makes room for n entries without rehashing, returns 0 on success, -1 on error
+int hash_map_reserve(hash_map *m, size_t n);
+
+// Returns the entry for key, or NULL if it is not present
+hash_map_entry *hash_map_find(const hash_map *m, str_view key);
+
+// Returns the entry for key, inserting it with value 0 if needed. Sets
+// *inserted (if not NULL) to whether it was added. Returns NULL on error,
+// including keys of 4 GiB or more.
+hash_map_entry *hash_map_upsert(hash_map *m, str_view key, int *inserted);
+
+// Sets key to value, returns 0 on success, -1 on error
+int hash_map_put(hash_map *m, str_view key, uint64_t value);
+
+// Stores the value for key in *value, returns 1 if found, 0 otherwise
+int hash_map_get(const hash_map *m, str_view key, uint64_t *value);
+
+// Removes key, returns 1 if it was present, 0 otherwise. The key's bytes
+// stay in the arena until hash_map_clear or hash_map_free.
+int hash_map_remove(hash_map *m, str_view key);
+
+// Iterates over entries in slot order: start with *pos = 0; returns the next
+// entry or NULL at the end. The map must not be modified while iterating.
+hash_map_entry *hash_map_next(const hash_map *m, size_t *pos);
+
+#endif // HASH_UTILS_H
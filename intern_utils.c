@@ -0,0 +1,165 @@
+#include "intern_utils.h"
+#include "hash_utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INTERN_INITIAL_CAP 64
+
+// Internal helper: 32-bit hash of a view
+static uint32_t intern_hash(str_view v) {
+    return (uint32_t)hash_bytes(v.data, v.len, 0);
+}
+
+// Initializes an empty table; slots are allocated on first insert
+void intern_init(intern_table *t) {
+    t->slots = NULL;
+    t->cap = 0;
+    t->count = 0;
+    t->requests = 0;
+    t->bytes_requested = 0;
+    arena_init(&t->strings, 0);
+}
+
+// Releases the table and every string it returned
+void intern_free(intern_table *t) {
+    free(t->slots);
+    arena_free(&t->strings);
+    intern_init(t);
+}
+
+// Internal helper: finds the slot holding v or the empty slot where it belongs
+static intern_entry *intern_probe(const intern_table *t, str_view v, uint32_t h) {
+    size_t mask = t->cap - 1;
+    for (size_t i = h & mask;; i = (i + 1) & mask) {
+        intern_entry *e = &t->slots[i];
+        if (!e->str) return e;
+        if (e->hash == h && e->len == v.len && memcmp(e->str, v.data, v.len) == 0) return e;
+    }
+}
+
+// Internal helper: doubles the slot array and reinserts every entry
+static int intern_grow(intern_table *t) {
+    size_t cap = t->cap ? t->cap * 2 : INTERN_INITIAL_CAP;
+    intern_entry *slots = calloc(cap, sizeof(*slots));
+    if (!slots) return -1;
+    for (size_t i = 0; i < t->cap; i++) {
+        intern_entry *e = &t->slots[i];
+        if (!e->str) continue;
+        size_t j = e->hash & (cap - 1);
+        while (slots[j].str) j = (j + 1) & (cap - 1);
+        slots[j] = *e;
+    }
+    free(t->slots);
+    t->slots = slots;
+    t->cap = cap;
+    return 0;
+}
+
+// Internal helper: intern with a precomputed hash
+static const char *intern_hashed(intern_table *t, str_view v, uint32_t h) {
+    if (v.len > UINT32_MAX) return NULL;
+    if (t->cap) {
+        intern_entry *e = intern_probe(t, v, h);
+        if (e->str) {
+            t->requests++;
+            t->bytes_requested += v.len + 1;
+            return e->str;
+        }
+    }
+    // Keep the load factor at or below 3/4
+    if ((t->count + 1) * 4 > t->cap * 3 && intern_grow(t) < 0) return NULL;
+    char *copy = sv_dup_arena(&t->strings, v);
+    if (!copy) return NULL;
+    intern_entry *e = intern_probe(t, v, h);
+    e->str = copy;
+    e->len = (uint32_t)v.len;
+    e->hash = h;
+    t->count++;
+    t->requests++;
+    t->bytes_requested += v.len + 1;
+    return copy;
+}
+
+// Returns the canonical copy of v, inserting it if needed
+const char *intern_view(intern_table *t, str_view v) {
+    return intern_hashed(t, v, intern_hash(v));
+}
+
+// Returns the canonical copy of s, inserting it if needed
+const char *intern_cstr(intern_table *t, const char *s) {
+    return intern_view(t, sv_from_cstr(s));
+}
+
+// Returns the canonical copy of v if already interned, or NULL
+const char *intern_lookup(const intern_table *t, str_view v) {
+    if (!t->cap) return NULL;
+    return intern_probe(t, v, intern_hash(v))->str;
+}
+
+// Fills *st with the table's memory accounting
+void intern_get_stats(const intern_table *t, intern_stats *st) {
+    size_t used = arena_bytes_used(&t->strings);
+    st->unique = t->count;
+    st->requests = t->requests;
+    st->bytes_requested = t->bytes_requested;
+    st->bytes_stored = used;
+    st->bytes_overhead = t->cap * sizeof(intern_entry) +
+                         (arena_bytes_reserved(&t->strings) - used);
+    st->bytes_saved = (long)st->bytes_requested - (long)(st->bytes_stored + st->bytes_overhead);
+}
+
+// Initializes an empty thread-safe table
+int intern_mt_init(intern_table_mt *t) {
+    for (int i = 0; i < INTERN_MT_SHARDS; i++) {
+        intern_init(&t->shards[i]);
+        // Smaller chunks so lightly used shards do not pin a full default chunk
+        arena_init(&t->shards[i].strings, ARENA_DEFAULT_CHUNK / 4);
+        if (pthread_mutex_init(&t->locks[i], NULL) != 0) {
+            while (i-- > 0) pthread_mutex_destroy(&t->locks[i]);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Releases the table and every string it returned
+void intern_mt_free(intern_table_mt *t) {
+    for (int i = 0; i < INTERN_MT_SHARDS; i++) {
+        intern_free(&t->shards[i]);
+        pthread_mutex_destroy(&t->locks[i]);
+    }
+}
+
+// Thread-safe intern_view; the top hash bits pick the shard so the low bits
+// stay well spread inside it
+const char *intern_mt_view(intern_table_mt *t, str_view v) {
+    uint32_t h = intern_hash(v);
+    size_t s = h >> 26;
+    pthread_mutex_lock(&t->locks[s]);
+    const char *r = intern_hashed(&t->shards[s], v, h);
+    pthread_mutex_unlock(&t->locks[s]);
+    return r;
+}
+
+// Thread-safe intern_cstr
+const char *intern_mt_cstr(intern_table_mt *t, const char *s) {
+    return intern_mt_view(t, sv_from_cstr(s));
+}
+
+// Fills *st with the memory accounting summed over all shards
+void intern_mt_get_stats(intern_table_mt *t, intern_stats *st) {
+    intern_stats sum = {0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < INTERN_MT_SHARDS; i++) {
+        intern_stats one;
+        pthread_mutex_lock(&t->locks[i]);
+        intern_get_stats(&t->shards[i], &one);
+        pthread_mutex_unlock(&t->locks[i]);
+        sum.unique += one.unique;
+        sum.requests += one.requests;
+        sum.bytes_requested += one.bytes_requested;
+        sum.bytes_stored += one.bytes_stored;
+        sum.bytes_overhead += one.bytes_overhead;
+    }
+    sum.bytes_saved = (long)sum.bytes_requested - (long)(sum.bytes_stored + sum.bytes_overhead);
+    *st = sum;
+}
@@ -0,0 +1,83 @@
+#ifndef INTERN_UTILS_H
+#define INTERN_UTILS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "arena_utils.h"
+#include "string_utils.h"
+
+// One slot of the open-addressing table; str is NULL for an empty slot
+typedef struct {
+    const char *str;
+    uint32_t len;
+    uint32_t hash;
+} intern_entry;
+
+// A string interning table. Every distinct string is stored once in the
+// table's arena; intern calls return that copy, so two interned strings are
+// equal exactly when their pointers are. Pointers stay valid until
+// intern_free. Not thread-safe; see intern_table_mt.
+typedef struct {
+    intern_entry *slots;
+    size_t cap;
+    size_t count;
+    arena strings;
+    size_t requests;
+    size_t bytes_requested;
+} intern_table;
+
+// Memory accounting for an interning table
+typedef struct {
+    size_t unique;          // distinct strings stored
+    size_t requests;        // intern calls served
+    size_t bytes_requested; // bytes the callers would hold as separate copies
+    size_t bytes_stored;    // bytes of string data actually kept
+    size_t bytes_overhead;  // table slots and unused arena space
+    long bytes_saved;       // bytes_requested - (bytes_stored + bytes_overhead)
+} intern_stats;
+
+// Initializes an empty table
+void intern_init(intern_table *t);
+
+// Releases the table and every string it returned
+void intern_free(intern_table *t);
+
+// Returns the canonical copy of v, inserting it if needed, or NULL on error
+const char *intern_view(intern_table *t, str_view v);
+
+// Returns the canonical copy of s, inserting it if needed, or NULL on error
+const char *intern_cstr(intern_table *t, const char *s);
+
+// Returns the canonical copy of v if already interned, or NULL
+const char *intern_lookup(const intern_table *t, str_view v);
+
+// Fills *st with the table's memory accounting
+void intern_get_stats(const intern_table *t, intern_stats *st);
+
+// Number of independently locked shards in intern_table_mt
+#define INTERN_MT_SHARDS 64
+
+// A thread-safe interning table split into shards by hash, each guarded by
+// its own mutex, so scanner threads rarely contend
+typedef struct {
+    intern_table shards[INTERN_MT_SHARDS];
+    pthread_mutex_t locks[INTERN_MT_SHARDS];
+} intern_table_mt;
+
+// Initializes an empty thread-safe table, returns 0 on success, -1 on error
+int intern_mt_init(intern_table_mt *t);
+
+// Releases the table and every string it returned
+void intern_mt_free(intern_table_mt *t);
+
+// Thread-safe intern_view
+const char *intern_mt_view(intern_table_mt *t, str_view v);
+
+// Thread-safe intern_cstr
+const char *intern_mt_cstr(intern_table_mt *t, const char *s);
+
+// Fills *st with the memory accounting summed over all shards
+void intern_mt_get_stats(intern_table_mt *t, intern_stats *st);
+
+#endif // INTERN_UTILS_H
@@ -1,7 +1,17 @@
 #include "math_utils.h"
+#include <limits.h>
+#include <stdint.h>
 
 // Math utility function implementations will go here
 
+// The batch kernels pick AVX2 at run time, so a default build still uses
+// it where the CPU has it; the scalar loops cover tails and other CPUs
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MATH_X86 1
+#define MATH_HAS_AVX2() __builtin_cpu_supports("avx2")
+#endif
+
 int add(int a, int b) {
     return a + b;
 }
@@ -33,15 +43,16 @@ int min(int a, int b) {
 }
 
 int abs_val(int a) {
-    return a < 0 ? -a : a;
+    return a < 0 ? (int)(0u - (unsigned)a) : a;
 }
 
 int pow_int(int base, int exp) {
-    int result = 1;
-    for (int i = 0; i < exp; ++i) {
-        result *= base;
+    unsigned result = 1, b = (unsigned)base;
+    for (; exp > 0; exp >>= 1) {
+        if (exp & 1) result *= b;
+        b *= b;
     }
-    return result;
+    return (int)result;
 }
 
 int clamp(int value, int min, int max) {
@@ -53,3 +64,233 @@ int clamp(int value, int min, int max) {
 int sign(int a) {
     return (a > 0) - (a < 0);
 }
+
+// base^exp with overflow detection
+int pow_int_checked(int base, int exp, int *out) {
+    if (exp < 0) return -1;
+    int result = 1, b = base;
+    for (;;) {
+        if ((exp & 1) && __builtin_mul_overflow(result, b, &result)) return -1;
+        exp >>= 1;
+        if (exp == 0) break;
+        // Only square when another bit needs it, so the last square cannot
+        // report an overflow the result never sees
+        if (__builtin_mul_overflow(b, b, &b)) return -1;
+    }
+    *out = result;
+    return 0;
+}
+
+// Internal helpers: scalar element operations shared by the loops below
+static inline int math_add_wrap(int a, int b) {
+    return (int)((unsigned)a + (unsigned)b);
+}
+
+static inline int math_mul_wrap(int a, int b) {
+    return (int)((unsigned)a * (unsigned)b);
+}
+
+static inline int math_add_sat(int a, int b) {
+    int r;
+    if (__builtin_add_overflow(a, b, &r)) return a < 0 ? INT_MIN : INT_MAX;
+    return r;
+}
+
+static inline int math_mul_sat(int a, int b) {
+    int64_t p = (int64_t)a * b;
+    return p > INT_MAX ? INT_MAX : p < INT_MIN ? INT_MIN : (int)p;
+}
+
+#ifdef MATH_X86
+// Internal helper: all-ones in the lanes where a + b overflowed
+__attribute__((target("avx2")))
+static inline __m256i math_add_overflow_v(__m256i a, __m256i b, __m256i r) {
+    // Overflow when both inputs have a sign the result does not
+    __m256i o = _mm256_and_si256(_mm256_xor_si256(a, r), _mm256_xor_si256(b, r));
+    return _mm256_srai_epi32(o, 31);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i math_add_sat_v(__m256i a, __m256i b) {
+    __m256i r = _mm256_add_epi32(a, b);
+    // INT_MIN when a < 0, INT_MAX otherwise
+    __m256i sat = _mm256_xor_si256(_mm256_srai_epi32(a, 31), _mm256_set1_epi32(INT_MAX));
+    return _mm256_blendv_epi8(r, sat, math_add_overflow_v(a, b, r));
+}
+
+// Internal helper: full 64-bit products split into low and high halves
+__attribute__((target("avx2")))
+static inline void math_mul_wide_v(__m256i a, __m256i b, __m256i *lo, __m256i *hi) {
+    __m256i even = _mm256_mul_epi32(a, b);
+    __m256i odd = _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    *lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xaa);
+    *hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xaa);
+}
+
+// Internal helper: all-ones in the lanes whose product does not fit
+__attribute__((target("avx2")))
+static inline __m256i math_mul_overflow_v(__m256i lo, __m256i hi) {
+    return _mm256_xor_si256(hi, _mm256_srai_epi32(lo, 31));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i math_mul_sat_v(__m256i a, __m256i b) {
+    __m256i lo, hi;
+    math_mul_wide_v(a, b, &lo, &hi);
+    __m256i sat = _mm256_xor_si256(_mm256_srai_epi32(hi, 31), _mm256_set1_epi32(INT_MAX));
+    __m256i over = _mm256_xor_si256(_mm256_cmpeq_epi32(math_mul_overflow_v(lo, hi), _mm256_setzero_si256()),
+                                    _mm256_set1_epi32(-1));
+    return _mm256_blendv_epi8(lo, sat, over);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i math_sign_v(__m256i x) {
+    __m256i zero = _mm256_setzero_si256();
+    return _mm256_sub_epi32(_mm256_cmpgt_epi32(zero, x), _mm256_cmpgt_epi32(x, zero));
+}
+#define MATH_ADD_V _mm256_add_epi32
+#define MATH_MUL_V _mm256_mullo_epi32
+#define MATH_MIN_V _mm256_min_epi32
+#define MATH_MAX_V _mm256_max_epi32
+#endif
+
+// Internal helper: generates name(a, b, out, n) applying an AVX2 operation
+// eight lanes at a time and the scalar one to the tail
+#ifdef MATH_X86
+#define MATH_DEFINE_BINARY(name, vec_op, scalar_op)                              \
+    __attribute__((target("avx2")))                                              \
+    static size_t name##_avx2(const int *a, const int *b, int *out, size_t n) {  \
+        size_t i = 0;                                                            \
+        for (; i + 8 <= n; i += 8) {                                             \
+            __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));            \
+            __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));            \
+            _mm256_storeu_si256((__m256i *)(out + i), vec_op(x, y));             \
+        }                                                                        \
+        return i;                                                                \
+    }                                                                            \
+    void name(const int *a, const int *b, int *out, size_t n) {                  \
+        size_t i = MATH_HAS_AVX2() ? name##_avx2(a, b, out, n) : 0;              \
+        for (; i < n; i++) out[i] = scalar_op(a[i], b[i]);                       \
+    }
+#else
+#define MATH_DEFINE_BINARY(name, vec_op, scalar_op)                              \
+    void name(const int *a, const int *b, int *out, size_t n) {                  \
+        for (size_t i = 0; i < n; i++) out[i] = scalar_op(a[i], b[i]);           \
+    }
+#endif
+
+MATH_DEFINE_BINARY(add_array, MATH_ADD_V, math_add_wrap)
+MATH_DEFINE_BINARY(add_sat_array, math_add_sat_v, math_add_sat)
+MATH_DEFINE_BINARY(multiply_array, MATH_MUL_V, math_mul_wrap)
+MATH_DEFINE_BINARY(multiply_sat_array, math_mul_sat_v, math_mul_sat)
+MATH_DEFINE_BINARY(min_array, MATH_MIN_V, min)
+MATH_DEFINE_BINARY(max_array, MATH_MAX_V, max)
+
+#ifdef MATH_X86
+__attribute__((target("avx2")))
+static size_t add_checked_avx2(const int *a, const int *b, int *out, size_t n, int *overflow) {
+    __m256i any = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+        __m256i r = _mm256_add_epi32(x, y);
+        any = _mm256_or_si256(any, math_add_overflow_v(x, y, r));
+        _mm256_storeu_si256((__m256i *)(out + i), r);
+    }
+    *overflow = !_mm256_testz_si256(any, any);
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t multiply_checked_avx2(const int *a, const int *b, int *out, size_t n, int *overflow) {
+    __m256i any = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i lo, hi;
+        math_mul_wide_v(_mm256_loadu_si256((const __m256i *)(a + i)),
+                        _mm256_loadu_si256((const __m256i *)(b + i)), &lo, &hi);
+        any = _mm256_or_si256(any, math_mul_overflow_v(lo, hi));
+        _mm256_storeu_si256((__m256i *)(out + i), lo);
+    }
+    *overflow = !_mm256_testz_si256(any, any);
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t clamp_avx2(int *arr, size_t n, int min, int max) {
+    const __m256i lo = _mm256_set1_epi32(min), hi = _mm256_set1_epi32(max);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(arr + i));
+        // Below min wins over above max, as in clamp
+        __m256i r = _mm256_blendv_epi8(_mm256_min_epi32(x, hi), lo, _mm256_cmpgt_epi32(lo, x));
+        _mm256_storeu_si256((__m256i *)(arr + i), r);
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t abs_avx2(const int *src, int *dst, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_abs_epi32(x));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t sign_avx2(const int *src, int *dst, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm256_storeu_si256((__m256i *)(dst + i), math_sign_v(x));
+    }
+    return i;
+}
+#endif
+
+int add_checked_array(const int *a, const int *b, int *out, size_t n) {
+    int overflow = 0;
+    size_t i = 0;
+#ifdef MATH_X86
+    if (MATH_HAS_AVX2()) i = add_checked_avx2(a, b, out, n, &overflow);
+#endif
+    for (; i < n; i++) overflow |= __builtin_add_overflow(a[i], b[i], &out[i]);
+    return overflow ? -1 : 0;
+}
+
+int multiply_checked_array(const int *a, const int *b, int *out, size_t n) {
+    int overflow = 0;
+    size_t i = 0;
+#ifdef MATH_X86
+    if (MATH_HAS_AVX2()) i = multiply_checked_avx2(a, b, out, n, &overflow);
+#endif
+    for (; i < n; i++) overflow |= __builtin_mul_overflow(a[i], b[i], &out[i]);
+    return overflow ? -1 : 0;
+}
+
+void clamp_array(int *arr, size_t n, int min, int max) {
+    size_t i = 0;
+#ifdef MATH_X86
+    if (MATH_HAS_AVX2()) i = clamp_avx2(arr, n, min, max);
+#endif
+    for (; i < n; i++) arr[i] = clamp(arr[i], min, max);
+}
+
+void abs_array(const int *src, int *dst, size_t n) {
+    size_t i = 0;
+#ifdef MATH_X86
+    if (MATH_HAS_AVX2()) i = abs_avx2(src, dst, n);
+#endif
+    for (; i < n; i++) dst[i] = abs_val(src[i]);
+}
+
+void sign_array(const int *src, int *dst, size_t n) {
+    size_t i = 0;
+#ifdef MATH_X86
+    if (MATH_HAS_AVX2()) i = sign_avx2(src, dst, n);
+#endif
+    for (; i < n; i++) dst[i] = sign(src[i]);
+}
@@ -1,6 +1,8 @@
 #ifndef MATH_UTILS_H
 #define MATH_UTILS_H
 
+#include <stddef.h>
+
 // Math utility function prototypes will go here
 
 int add(int a, int b);
@@ -10,9 +12,36 @@ double divide(int a, int b);
 int mod(int a, int b);
 int max(int a, int b);
 int min(int a, int b);
+// abs_val(INT_MIN) wraps around to INT_MIN
 int abs_val(int a);
+// base^exp by repeated squaring; wraps around on overflow, 1 for exp <= 0
 int pow_int(int base, int exp);
 int clamp(int value, int min, int max);
 int sign(int a);
 
+// base^exp into *out; returns 0, or -1 if exp is negative or the result
+// does not fit in an int (*out is then left alone)
+int pow_int_checked(int base, int exp, int *out);
+
+// Batch versions of the functions above over n elements, using AVX2 when
+// the CPU has it. out may be the same array as an input. Plain add and
+// multiply wrap around; _sat versions saturate at INT_MIN/INT_MAX; _checked
+// versions store the wrapped results and return -1 if any element
+// overflowed, else 0.
+void add_array(const int *a, const int *b, int *out, size_t n);
+void add_sat_array(const int *a, const int *b, int *out, size_t n);
+int add_checked_array(const int *a, const int *b, int *out, size_t n);
+void multiply_array(const int *a, const int *b, int *out, size_t n);
+void multiply_sat_array(const int *a, const int *b, int *out, size_t n);
+int multiply_checked_array(const int *a, const int *b, int *out, size_t n);
+void min_array(const int *a, const int *b, int *out, size_t n);
+void max_array(const int *a, const int *b, int *out, size_t n);
+
+// Clamps every element of arr in place, with the same rules as clamp
+void clamp_array(int *arr, size_t n, int min, int max);
+
+// Element-wise abs_val and sign of src into dst
+void abs_array(const int *src, int *dst, size_t n);
+void sign_array(const int *src, int *dst, size_t n);
+
 #endif // MATH_UTILS_H
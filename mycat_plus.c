@@ -6,20 +6,60 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include "num_utils.h"
+#include "utf8_utils.h"
 // mycat_plus.c --- A version of mycat that can display line numbers
 
 // This program reads files and prints their contents to standard output.
 // If the -n option is provided, it will also print line numbers.
-#define BUF_SIZE 1024 // Buffer size for reading file chunks
+// If --validate-utf8 is provided, it also reports the byte offset of the
+// first invalid UTF-8 sequence in each file to stderr.
+#define BUF_SIZE 65536 // Buffer size for reading file chunks
+#define OUT_SIZE 65536 // Output is collected here and written in large blocks
+
+static char out_buf[OUT_SIZE];
+static size_t out_len = 0;
+
+// Writes any buffered output to stdout
+static void out_flush(void) {
+    size_t off = 0;
+    while (off < out_len) {
+        ssize_t n = write(1, out_buf + off, out_len - off);
+        if (n <= 0) break;
+        off += (size_t)n;
+    }
+    out_len = 0;
+}
+
+// Appends len bytes to the output buffer, flushing when it fills up
+static void out_write(const char *data, size_t len) {
+    if (out_len + len > OUT_SIZE) {
+        out_flush();
+        if (len > OUT_SIZE) {
+            while (len > 0) {
+                ssize_t n = write(1, data, len);
+                if (n <= 0) return;
+                data += n;
+                len -= (size_t)n;
+            }
+            return;
+        }
+    }
+    memcpy(out_buf + out_len, data, len);
+    out_len += len;
+}
 
 // Prints the contents of a file to stdout. If line_numbers is nonzero, prints line numbers.
-void print_file(const char *filename, int line_numbers) {
+// If validate_utf8 is nonzero, checks the file is valid UTF-8 while printing.
+// Returns 0 on success, 1 if the file could not be opened or is not valid UTF-8
+// (main only uses the result for the exit status with --validate-utf8).
+int print_file(const char *filename, int line_numbers, int validate_utf8) {
     // Open the file for reading
     int fd = open(filename, O_RDONLY);
     if (fd < 0) {
         // Print error if file cannot be opened
         dprintf(2, "Cannot open file: %s\n", filename);
-        return;
+        return 1;
     }
 
     // Variable declarations
@@ -28,60 +68,93 @@ void print_file(const char *filename, int line_numbers) {
     ssize_t bytesRead;
     int line_number = 1; // Current line number
     int new_line = 1; // Flag to track if at start of a new line
+    utf8_validator validator; // Carries partial sequences between chunks
+    utf8_validator_init(&validator);
 
-    // Read the file in chunks and process each byte
+    // Read the file in chunks and copy them to the output buffer
     while ((bytesRead = read(fd, buffer, BUF_SIZE)) > 0) {
-        // Iterate through each byte in the buffer
-        for (ssize_t i = 0; i < bytesRead; i++) {
-            // Print line number at the start of a new line if enabled
-            if (new_line && line_numbers) {
+        // Validation runs once per chunk and stops after the first error
+        if (validate_utf8 && !validator.failed) {
+            utf8_validator_update(&validator, buffer, (size_t)bytesRead);
+        }
+
+        if (!line_numbers) {
+            out_write(buffer, (size_t)bytesRead);
+            continue;
+        }
+
+        // Copy whole line segments, inserting a number at each line start
+        const char *p = buffer;
+        const char *end = buffer + bytesRead;
+        while (p < end) {
+            if (new_line) {
                 char line_buf[32];
-                int len = snprintf(line_buf, sizeof(line_buf), "%6d  ", line_number++);
-                write(1, line_buf, len);
+                size_t len = num_format_u64_padded((uint64_t)line_number++, line_buf, 6, ' ');
+                line_buf[len++] = ' ';
+                line_buf[len++] = ' ';
+                out_write(line_buf, len);
                 new_line = 0;
             }
-
-            // Write the current character to stdout
-            write(1, &buffer[i], 1);
-
+            const char *nl = memchr(p, '\n', (size_t)(end - p));
+            const char *stop = nl ? nl + 1 : end;
+            out_write(p, (size_t)(stop - p));
             // If newline, set flag for next line
-            if (buffer[i] == '\n') {
-                new_line = 1;
-            }
+            if (nl) new_line = 1;
+            p = stop;
         }
     }
+    out_flush();
 
     // Close the file descriptor
     close(fd);
+
+    // Report the first invalid sequence, including one cut off at EOF
+    if (validate_utf8 && utf8_validator_finish(&validator) < 0) {
+        dprintf(2, "%s: invalid UTF-8 at byte offset %zu\n", filename, validator.error_offset);
+        return 1;
+    }
+    return 0;
 }
 
 // Program entry point: parses arguments and calls print_file for each file
 
 int main(int argc, char *argv[]) {
     int line_numbers = 0; // Flag for line numbering
+    int validate_utf8 = 0; // Flag for UTF-8 validation
     int start_index = 1; // Index of first file argument
+    int status = 0; // Exit status
+
+    // Check for -n and --validate-utf8 options before the file arguments
+    while (start_index < argc) {
+        if (strcmp(argv[start_index], "-n") == 0) {
+            line_numbers = 1;
+        } else if (strcmp(argv[start_index], "--validate-utf8") == 0) {
+            validate_utf8 = 1;
+        } else {
+            break;
+        }
+        start_index++;
+    }
 
-    if (argc < 2) {
+    if (argc < 2 || (validate_utf8 && start_index >= argc)) {
         // Print usage message if not enough arguments
-        write(2, "Usage: ./mycat_plus [-n] <file1> [file2...]\n", 45);
+        const char *usage = "Usage: ./mycat_plus [-n] [--validate-utf8] <file1> [file2...]\n";
+        write(2, usage, strlen(usage));
         return 1;
     }
 
-    // Check for -n option to enable line numbering
-    if (strcmp(argv[1], "-n") == 0) {
-        line_numbers = 1;
-        start_index = 2;
-    }
-
     // Loop through each file argument and print its contents
     // Each file is processed in order
     for (int i = start_index; i < argc; i++) {
-        print_file(argv[i], line_numbers);
+        if (print_file(argv[i], line_numbers, validate_utf8) != 0) status = 1;
     }
 
-    // Successful execution
+    // Without --validate-utf8 the exit status stays 0, as it always was,
+    // even when a file cannot be opened
+    if (!validate_utf8) status = 0;
+
     // End of program
-    return 0;
+    return status;
 }
 
 
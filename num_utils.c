@@ -0,0 +1,378 @@
+#include "num_utils.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// "00" "01" ... "99": two digits per table load
+static const char num_digits2[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Exact powers of ten representable as doubles
+static const double num_pow10[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+#define NUM_TWO53 9007199254740992.0
+
+// Internal helper: number of decimal digits in v
+static int num_count_digits(uint64_t v) {
+    int n = 1;
+    for (;;) {
+        if (v < 10) return n;
+        if (v < 100) return n + 1;
+        if (v < 1000) return n + 2;
+        if (v < 10000) return n + 3;
+        v /= 10000;
+        n += 4;
+    }
+}
+
+// Internal helper: writes the n digits of v ending at end, two at a time
+static void num_write_digits(uint64_t v, char *end) {
+    while (v >= 100) {
+        end -= 2;
+        memcpy(end, num_digits2 + (v % 100) * 2, 2);
+        v /= 100;
+    }
+    if (v >= 10) {
+        end -= 2;
+        memcpy(end, num_digits2 + v * 2, 2);
+    } else {
+        *--end = (char)('0' + v);
+    }
+}
+
+// Writes the decimal form of v to buf, returns its length
+size_t num_format_u64(uint64_t v, char *buf) {
+    int n = num_count_digits(v);
+    num_write_digits(v, buf + n);
+    buf[n] = '\0';
+    return (size_t)n;
+}
+
+// Writes the decimal form of v to buf, returns its length
+size_t num_format_i64(int64_t v, char *buf) {
+    if (v >= 0) return num_format_u64((uint64_t)v, buf);
+    buf[0] = '-';
+    return 1 + num_format_u64(0 - (uint64_t)v, buf + 1);
+}
+
+// Writes v right-aligned in width columns of pad, returns the length
+size_t num_format_u64_padded(uint64_t v, char *buf, int width, char pad) {
+    int n = num_count_digits(v);
+    int fill = width > n ? width - n : 0;
+    memset(buf, pad, (size_t)fill);
+    num_write_digits(v, buf + fill + n);
+    buf[fill + n] = '\0';
+    return (size_t)(fill + n);
+}
+
+// Internal helper: lays out the significant digits d[0..nd) with decimal
+// exponent e (value = d[0].d[1]... x 10^e)
+static size_t num_emit_double(char *p, const char *d, int nd, int e) {
+    char *start = p;
+    while (nd > 1 && d[nd - 1] == '0') nd--;
+    if (e >= -5 && e < 17) {
+        if (e < 0) {
+            *p++ = '0';
+            *p++ = '.';
+            for (int z = -1; z > e; z--) *p++ = '0';
+            memcpy(p, d, (size_t)nd);
+            p += nd;
+        } else if (nd <= e + 1) {
+            memcpy(p, d, (size_t)nd);
+            p += nd;
+            for (int z = nd; z <= e; z++) *p++ = '0';
+        } else {
+            memcpy(p, d, (size_t)(e + 1));
+            p += e + 1;
+            *p++ = '.';
+            memcpy(p, d + e + 1, (size_t)(nd - e - 1));
+            p += nd - e - 1;
+        }
+    } else {
+        *p++ = d[0];
+        if (nd > 1) {
+            *p++ = '.';
+            memcpy(p, d + 1, (size_t)(nd - 1));
+            p += nd - 1;
+        }
+        *p++ = 'e';
+        if (e < 0) {
+            *p++ = '-';
+            e = -e;
+        }
+        p += num_format_u64((uint64_t)e, p);
+    }
+    *p = '\0';
+    return (size_t)(p - start);
+}
+
+// Internal helper: finds the shortest m / 10^k (m < 2^53, k <= 22) that
+// converts back to v, which covers most values seen in practice. Because m
+// and 10^k are exact doubles, m / 10^k is exactly the correctly rounded
+// parse of "m e-k", so the round-trip check is exact. Returns 0 if no such
+// representation exists.
+static int num_shortest_fast(double v, uint64_t *mant, int *k_out) {
+    for (int k = 0; k <= 22; k++) {
+        double t = v * num_pow10[k];
+        if (t >= NUM_TWO53) return 0;
+        // t is in (0, 2^53), so the cast rounds without libm; the +-2 search
+        // below absorbs any tie rounded the other way
+        double r = (double)(int64_t)(t + 0.5);
+        // Any m that rounds to v lies within about 2^-52 * t of t; skip the
+        // divisions unless an integer is that close
+        if (fabs(t - r) > t * 4.5e-16) continue;
+        uint64_t best = 0;
+        double best_dist = 4.0;
+        for (int delta = -2; delta <= 2; delta++) {
+            double c = r + delta;
+            if (c <= 0 || c >= NUM_TWO53) continue;
+            if (c / num_pow10[k] != v) continue;
+            double dist = fabs(c - t);
+            if (dist < best_dist) {
+                best_dist = dist;
+                best = (uint64_t)c;
+            }
+        }
+        if (best) {
+            *mant = best;
+            *k_out = k;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Writes the shortest decimal that parses back to exactly v
+size_t num_format_double(double v, char *buf) {
+    char *p = buf;
+    if (isnan(v)) {
+        memcpy(buf, "nan", 4);
+        return 3;
+    }
+    if (signbit(v)) {
+        *p++ = '-';
+        v = -v;
+    }
+    if (isinf(v)) {
+        memcpy(p, "inf", 4);
+        return (size_t)(p - buf) + 3;
+    }
+    if (v == 0) {
+        memcpy(p, "0", 2);
+        return (size_t)(p - buf) + 1;
+    }
+    char digits[24];
+    uint64_t m;
+    int k;
+    if (num_shortest_fast(v, &m, &k)) {
+        int nd = (int)num_format_u64(m, digits);
+        return (size_t)(p - buf) + num_emit_double(p, digits, nd, nd - 1 - k);
+    }
+    // Rare path (very large or small magnitudes, or 17 digits beyond 2^53):
+    // binary search for the shortest correctly rounded %e that round-trips
+    char tmp[40];
+    int lo = 1, hi = 17;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        snprintf(tmp, sizeof(tmp), "%.*e", mid - 1, v);
+        if (strtod(tmp, NULL) == v) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    snprintf(tmp, sizeof(tmp), "%.*e", hi - 1, v);
+    int nd = 0;
+    char *q = tmp;
+    for (; *q != 'e'; q++) {
+        if (*q != '.') digits[nd++] = *q;
+    }
+    return (size_t)(p - buf) + num_emit_double(p, digits, nd, atoi(q + 1));
+}
+
+// Internal helper: 1 if the 8 bytes in w are all ASCII digits
+static inline int num_is_8_digits(uint64_t w) {
+    return ((w & 0xf0f0f0f0f0f0f0f0ULL) |
+            (((w + 0x0606060606060606ULL) & 0xf0f0f0f0f0f0f0f0ULL) >> 4)) == 0x3333333333333333ULL;
+}
+
+// Internal helper: converts 8 ASCII digits (first digit in the low byte)
+// to their value with three multiplies
+static inline uint32_t num_parse_8_digits(uint64_t w) {
+    w = (w & 0x0f0f0f0f0f0f0f0fULL) * 2561 >> 8;
+    w = (w & 0x00ff00ff00ff00ffULL) * 6553601 >> 16;
+    return (uint32_t)((w & 0x0000ffff0000ffffULL) * 42949672960001ULL >> 32);
+}
+
+// Internal helper: parses digits at s[*i..len) into *v, returning
+// NUM_ERANGE on overflow (consuming the remaining digits), NUM_EINVAL if
+// there are none
+static int num_parse_digits(const char *s, size_t len, size_t *i, uint64_t *v) {
+    size_t start = *i, j = *i;
+    uint64_t acc = 0;
+    // Up to 16 digits cannot overflow, so take them 8 at a time
+    while (j + 8 <= len && j - start <= 8) {
+        uint64_t w;
+        memcpy(&w, s + j, 8);
+        if (!num_is_8_digits(w)) break;
+        acc = acc * 100000000 + num_parse_8_digits(w);
+        j += 8;
+    }
+    int overflow = 0;
+    for (; j < len && (unsigned)(s[j] - '0') < 10; j++) {
+        unsigned d = (unsigned)(s[j] - '0');
+        if (acc > (UINT64_MAX - d) / 10) overflow = 1;
+        acc = acc * 10 + d;
+    }
+    *i = j;
+    if (j == start) return NUM_EINVAL;
+    if (overflow) return NUM_ERANGE;
+    *v = acc;
+    return NUM_OK;
+}
+
+// Parses an optionally signed decimal integer
+int num_parse_i64(const char *s, size_t len, int64_t *out, size_t *consumed) {
+    size_t i = 0;
+    int neg = 0;
+    if (i < len && (s[i] == '-' || s[i] == '+')) neg = s[i++] == '-';
+    uint64_t v = 0;
+    int rc = num_parse_digits(s, len, &i, &v);
+    if (rc != NUM_OK) return rc;
+    if (v > (uint64_t)INT64_MAX + neg) return NUM_ERANGE;
+    *out = neg ? (int64_t)(0 - v) : (int64_t)v;
+    if (consumed) *consumed = i;
+    return NUM_OK;
+}
+
+// Parses an unsigned decimal integer
+int num_parse_u64(const char *s, size_t len, uint64_t *out, size_t *consumed) {
+    size_t i = 0;
+    if (i < len && s[i] == '+') i++;
+    uint64_t v = 0;
+    int rc = num_parse_digits(s, len, &i, &v);
+    if (rc != NUM_OK) return rc;
+    *out = v;
+    if (consumed) *consumed = i;
+    return NUM_OK;
+}
+
+// Parses an optionally signed decimal int
+int num_parse_int(const char *s, size_t len, int *out, size_t *consumed) {
+    int64_t v;
+    size_t used;
+    int rc = num_parse_i64(s, len, &v, &used);
+    if (rc != NUM_OK) return rc;
+    if (v < -2147483647 - 1 || v > 2147483647) return NUM_ERANGE;
+    *out = (int)v;
+    if (consumed) *consumed = used;
+    return NUM_OK;
+}
+
+// Internal helper: strtod on a NUL-terminated copy of s[0..len)
+static double num_strtod_copy(const char *s, size_t len, size_t *used) {
+    char local[64];
+    char *copy = len < sizeof(local) ? local : malloc(len + 1);
+    if (!copy) {
+        *used = 0;
+        return 0;
+    }
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    char *end;
+    double v = strtod(copy, &end);
+    *used = (size_t)(end - copy);
+    if (copy != local) free(copy);
+    return v;
+}
+
+// Parses a decimal floating-point number. Mantissas of up to 19 digits and
+// exponents the exact powers of ten can absorb take Clinger's fast path (one
+// exact multiply or divide, hence correctly rounded); everything else is
+// handed to strtod.
+int num_parse_double(const char *s, size_t len, double *out, size_t *consumed) {
+    size_t i = 0;
+    int neg = 0;
+    if (i < len && (s[i] == '-' || s[i] == '+')) neg = s[i++] == '-';
+    uint64_t mant = 0;
+    int ndig = 0, exp10 = 0, truncated = 0, any = 0;
+    for (; i < len && (unsigned)(s[i] - '0') < 10; i++) {
+        any = 1;
+        if (ndig < 19) {
+            mant = mant * 10 + (unsigned)(s[i] - '0');
+            ndig += mant != 0;
+        } else {
+            exp10++;
+            truncated |= s[i] != '0';
+        }
+    }
+    if (i < len && s[i] == '.') {
+        size_t j = i + 1;
+        for (; j < len && (unsigned)(s[j] - '0') < 10; j++) {
+            any = 1;
+            if (ndig < 19) {
+                mant = mant * 10 + (unsigned)(s[j] - '0');
+                ndig += mant != 0;
+                exp10--;
+            } else {
+                truncated |= s[j] != '0';
+            }
+        }
+        if (any) i = j;
+    }
+    if (!any) {
+        // Only "inf", "infinity" and "nan" remain; leave those to strtod
+        size_t used;
+        size_t span = len < 16 ? len : 16;
+        if (span == 0 || (s[0] != '+' && s[0] != '-' && (unsigned)((s[0] | 0x20) - 'a') >= 26)) {
+            return NUM_EINVAL;
+        }
+        double v = num_strtod_copy(s, span, &used);
+        if (used == 0) return NUM_EINVAL;
+        *out = v;
+        if (consumed) *consumed = used;
+        return NUM_OK;
+    }
+    if (i < len && (s[i] == 'e' || s[i] == 'E')) {
+        size_t j = i + 1;
+        int eneg = 0, e = 0;
+        if (j < len && (s[j] == '-' || s[j] == '+')) eneg = s[j++] == '-';
+        size_t digits_start = j;
+        for (; j < len && (unsigned)(s[j] - '0') < 10; j++) {
+            if (e < 100000) e = e * 10 + (s[j] - '0');
+        }
+        if (j > digits_start) {
+            exp10 += eneg ? -e : e;
+            i = j;
+        }
+    }
+    if (consumed) *consumed = i;
+
+    double v;
+    if (!truncated && mant <= (uint64_t)NUM_TWO53 && exp10 >= -22 && exp10 <= 22 + 15) {
+        v = (double)mant;
+        if (exp10 < 0) {
+            v /= num_pow10[-exp10];
+        } else if (exp10 <= 22) {
+            v *= num_pow10[exp10];
+        } else {
+            // Move the excess exponent into the mantissa while it stays exact
+            v *= num_pow10[exp10 - 22];
+            if (v > NUM_TWO53) goto slow;
+            v *= 1e22;
+        }
+        *out = neg ? -v : v;
+        return NUM_OK;
+    }
+slow:;
+    size_t used;
+    v = num_strtod_copy(s, i, &used);
+    *out = v;
+    return isinf(v) ? NUM_ERANGE : NUM_OK;
+}
@@ -0,0 +1,47 @@
+#ifndef NUM_UTILS_H
+#define NUM_UTILS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Status codes returned by the parse functions
+#define NUM_OK      0
+#define NUM_EINVAL -1   // no number at the start of the input
+#define NUM_ERANGE -2   // the number does not fit the result type
+
+// Buffer sizes that always fit a formatted value and its NUL
+#define NUM_INT_BUFSIZE    21
+#define NUM_DOUBLE_BUFSIZE 32
+
+// Writes the decimal form of v to buf (NUM_INT_BUFSIZE bytes), returns its length
+size_t num_format_u64(uint64_t v, char *buf);
+
+// Writes the decimal form of v to buf (NUM_INT_BUFSIZE bytes), returns its length
+size_t num_format_i64(int64_t v, char *buf);
+
+// Writes v right-aligned in width columns of pad (like "%6llu" for width 6
+// and pad ' '); buf needs max(width, 20) + 1 bytes. Returns the length.
+size_t num_format_u64_padded(uint64_t v, char *buf, int width, char pad);
+
+// Writes the shortest decimal that parses back to exactly v, returns its
+// length; buf needs NUM_DOUBLE_BUFSIZE bytes. Uses fixed notation for
+// exponents from -5 to 16 and d.ddde[-]X otherwise; "nan", "inf", "-inf".
+size_t num_format_double(double v, char *buf);
+
+// Parses an optionally signed decimal integer from the first len bytes of s.
+// On NUM_OK stores the value in *out and, if consumed is not NULL, the number
+// of bytes used. Returns NUM_OK, NUM_EINVAL or NUM_ERANGE.
+int num_parse_i64(const char *s, size_t len, int64_t *out, size_t *consumed);
+
+// Like num_parse_i64 for unsigned values (a leading '+' is accepted)
+int num_parse_u64(const char *s, size_t len, uint64_t *out, size_t *consumed);
+
+// Like num_parse_i64 for int
+int num_parse_int(const char *s, size_t len, int *out, size_t *consumed);
+
+// Parses a decimal floating-point number (as strtod, without leading
+// whitespace or hex forms) from the first len bytes of s. Returns NUM_OK,
+// NUM_EINVAL, or NUM_ERANGE when the value overflows to infinity.
+int num_parse_double(const char *s, size_t len, double *out, size_t *consumed);
+
+#endif // NUM_UTILS_H
@@ -0,0 +1,331 @@
+#include "quantile_utils.h"
+#include "array_utils.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Internal helper: bucket of a non-negative value
+static inline size_t quantile_hist_index(int precision, uint64_t v) {
+    if (v < ((uint64_t)1 << precision)) return (size_t)v;
+    int e = 63 - __builtin_clzll(v);
+    return ((size_t)(e - precision + 1) << precision) +
+           (size_t)((v >> (e - precision)) - ((uint64_t)1 << precision));
+}
+
+// Internal helper: midpoint of the values that fall in bucket i
+static int64_t quantile_hist_midpoint(int precision, size_t i) {
+    size_t group = i >> precision;
+    uint64_t sub = i & (((size_t)1 << precision) - 1);
+    if (group == 0) return (int64_t)sub;
+    uint64_t lo = (((uint64_t)1 << precision) + sub) << (group - 1);
+    return (int64_t)(lo + (((uint64_t)1 << (group - 1)) - 1) / 2);
+}
+
+// Sets up an empty histogram
+int quantile_hist_init(quantile_hist *h, int precision) {
+    memset(h, 0, sizeof(*h));
+    if (precision < 1 || precision > 16) return -1;
+    h->precision = precision;
+    h->nbuckets = (size_t)(64 - precision) << precision;
+    h->counts = calloc(h->nbuckets, sizeof(uint64_t));
+    if (!h->counts) return -1;
+    h->min = INT64_MAX;
+    h->max = INT64_MIN;
+    return 0;
+}
+
+// Releases the counters
+void quantile_hist_free(quantile_hist *h) {
+    free(h->counts);
+    memset(h, 0, sizeof(*h));
+}
+
+// Forgets every value
+void quantile_hist_clear(quantile_hist *h) {
+    memset(h->counts, 0, h->nbuckets * sizeof(uint64_t));
+    h->total = 0;
+    h->min = INT64_MAX;
+    h->max = INT64_MIN;
+}
+
+// Records count copies of value
+void quantile_hist_add_n(quantile_hist *h, int64_t value, uint64_t count) {
+    if (count == 0) return;
+    h->counts[quantile_hist_index(h->precision, value < 0 ? 0 : (uint64_t)value)] += count;
+    h->total += count;
+    if (value < h->min) h->min = value;
+    if (value > h->max) h->max = value;
+}
+
+// Records one value
+void quantile_hist_add(quantile_hist *h, int64_t value) {
+    quantile_hist_add_n(h, value, 1);
+}
+
+// Records every element of arr
+void quantile_hist_add_array(quantile_hist *h, const int *arr, size_t len) {
+    int32_t min, max;
+    if (array_minmax_i32(arr, len, &min, &max) != 0) return;
+    if (min < h->min) h->min = min;
+    if (max > h->max) h->max = max;
+    h->total += len;
+    uint64_t *c = h->counts;
+    int p = h->precision;
+    if (min >= 0) {
+        for (size_t i = 0; i < len; i++) c[quantile_hist_index(p, (uint64_t)arr[i])]++;
+    } else {
+        for (size_t i = 0; i < len; i++) c[quantile_hist_index(p, arr[i] < 0 ? 0 : (uint64_t)arr[i])]++;
+    }
+}
+
+// Adds the counts of src into dst
+int quantile_hist_merge(quantile_hist *dst, const quantile_hist *src) {
+    if (dst->precision != src->precision) return -1;
+    for (size_t i = 0; i < dst->nbuckets; i++) dst->counts[i] += src->counts[i];
+    dst->total += src->total;
+    if (src->min < dst->min) dst->min = src->min;
+    if (src->max > dst->max) dst->max = src->max;
+    return 0;
+}
+
+// Stores the value at quantile q in *out
+int quantile_hist_value(const quantile_hist *h, double q, int64_t *out) {
+    if (h->total == 0) return -1;
+    if (!(q > 0)) {
+        *out = h->min;
+        return 0;
+    }
+    if (q >= 1) {
+        *out = h->max;
+        return 0;
+    }
+    uint64_t target = (uint64_t)(q * (double)h->total);
+    if (target >= h->total) target = h->total - 1;
+    uint64_t seen = 0;
+    size_t i = 0;
+    for (; i < h->nbuckets; i++) {
+        seen += h->counts[i];
+        if (seen > target) break;
+    }
+    int64_t v = quantile_hist_midpoint(h->precision, i);
+    *out = v < h->min ? h->min : v > h->max ? h->max : v;
+    return 0;
+}
+
+// Smallest level capacity; keeps compactions of the low levels from
+// running on a handful of items at a time
+#define QUANTILE_MIN_CAPACITY 8
+
+// Internal helper: recomputes the level capacities after the number of
+// levels changes. They shrink by 2/3 going down from the top level, which
+// holds k items.
+static void quantile_sketch_resize(quantile_sketch *s) {
+    s->capacity = 0;
+    for (uint32_t h = 0; h < s->nlevels; h++) {
+        double cap = ceil(s->k * pow(2.0 / 3.0, (double)(s->nlevels - 1 - h)));
+        s->levels[h].capacity = cap < QUANTILE_MIN_CAPACITY ? QUANTILE_MIN_CAPACITY : (uint32_t)cap;
+        s->capacity += s->levels[h].capacity;
+    }
+}
+
+// Internal helper: makes room for extra more items in a level
+static int quantile_level_reserve(quantile_level *l, size_t extra) {
+    if (l->len + extra <= l->alloc) return 0;
+    size_t cap = l->alloc ? l->alloc : 16;
+    while (cap < l->len + extra) cap *= 2;
+    if (cap > UINT32_MAX) return -1;
+    int64_t *items = realloc(l->items, cap * sizeof(int64_t));
+    if (!items) return -1;
+    l->items = items;
+    l->alloc = (uint32_t)cap;
+    return 0;
+}
+
+// Internal helper: next random bit (xorshift64)
+static unsigned quantile_random_bit(quantile_sketch *s) {
+    s->rng ^= s->rng << 13;
+    s->rng ^= s->rng >> 7;
+    s->rng ^= s->rng << 17;
+    return (unsigned)(s->rng >> 63);
+}
+
+static int quantile_cmp_i64(const void *a, const void *b) {
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Internal helper: sorts level 0, usually only a few items long
+static void quantile_sort_items(int64_t *items, size_t n) {
+    if (n > 32) {
+        array_sort(items, n, sizeof(int64_t), quantile_cmp_i64);
+        return;
+    }
+    for (size_t i = 1; i < n; i++) {
+        int64_t x = items[i];
+        size_t j = i;
+        for (; j > 0 && items[j - 1] > x; j--) items[j] = items[j - 1];
+        items[j] = x;
+    }
+}
+
+// Internal helper: merges n sorted items into a sorted level, in place
+// from the back
+static int quantile_level_merge(quantile_level *l, const int64_t *src, size_t n) {
+    if (quantile_level_reserve(l, n) != 0) return -1;
+    size_t i = l->len, j = n, out = l->len + n;
+    while (j > 0) {
+        if (i > 0 && l->items[i - 1] > src[j - 1]) {
+            l->items[--out] = l->items[--i];
+        } else {
+            l->items[--out] = src[--j];
+        }
+    }
+    l->len += (uint32_t)n;
+    return 0;
+}
+
+// Internal helper: halves the lowest level that is over capacity. Levels
+// above 0 are kept sorted, so only level 0 needs sorting; the promoted
+// items come out sorted and are merged into the level above.
+static int quantile_sketch_compress(quantile_sketch *s) {
+    uint32_t h = 0;
+    while (h + 1 < s->nlevels && s->levels[h].len < s->levels[h].capacity) h++;
+    if (h + 1 == s->nlevels) {
+        if (s->nlevels == QUANTILE_SKETCH_LEVELS) return -1;
+        s->nlevels++;
+        quantile_sketch_resize(s);
+    }
+    quantile_level *l = &s->levels[h];
+    size_t odd = l->len & 1, promoted = l->len / 2;
+    if (h == 0) quantile_sort_items(l->items, l->len);
+    // Pick every other item in place, then merge them upwards; an odd item
+    // out (the largest) stays behind at this level
+    size_t offset = quantile_random_bit(s);
+    int64_t last = l->items[l->len - 1];
+    for (size_t j = 0; j < promoted; j++) l->items[j] = l->items[offset + 2 * j];
+    if (quantile_level_merge(&s->levels[h + 1], l->items, promoted) != 0) return -1;
+    if (odd) l->items[0] = last;
+    l->len = (uint32_t)odd;
+    s->retained -= promoted;
+    return 0;
+}
+
+// Sets up an empty sketch
+int quantile_sketch_init(quantile_sketch *s, uint32_t k) {
+    memset(s, 0, sizeof(*s));
+    if (k < 8 || k > 65535) return -1;
+    s->k = k;
+    s->nlevels = 1;
+    s->min = INT64_MAX;
+    s->max = INT64_MIN;
+    s->rng = 0x9e3779b97f4a7c15ULL;
+    quantile_sketch_resize(s);
+    return 0;
+}
+
+// Releases the sketch's buffers
+void quantile_sketch_free(quantile_sketch *s) {
+    for (uint32_t h = 0; h < QUANTILE_SKETCH_LEVELS; h++) free(s->levels[h].items);
+    memset(s, 0, sizeof(*s));
+}
+
+// Records one value
+int quantile_sketch_add(quantile_sketch *s, int64_t value) {
+    quantile_level *l = &s->levels[0];
+    if (s->retained >= s->capacity && quantile_sketch_compress(s) != 0) return -1;
+    if (quantile_level_reserve(l, 1) != 0) return -1;
+    l->items[l->len++] = value;
+    s->retained++;
+    s->n++;
+    if (value < s->min) s->min = value;
+    if (value > s->max) s->max = value;
+    return 0;
+}
+
+// Records every element of arr
+int quantile_sketch_add_array(quantile_sketch *s, const int *arr, size_t len) {
+    quantile_level *l = &s->levels[0];
+    while (len > 0) {
+        if (s->retained >= s->capacity && quantile_sketch_compress(s) != 0) return -1;
+        // Copy straight into level 0 up to the next compaction
+        size_t n = s->capacity - s->retained;
+        if (n > len) n = len;
+        if (quantile_level_reserve(l, n) != 0) return -1;
+        int64_t *dst = l->items + l->len, min = s->min, max = s->max;
+        for (size_t i = 0; i < n; i++) {
+            dst[i] = arr[i];
+            min = dst[i] < min ? dst[i] : min;
+            max = dst[i] > max ? dst[i] : max;
+        }
+        s->min = min;
+        s->max = max;
+        l->len += (uint32_t)n;
+        s->retained += n;
+        s->n += n;
+        arr += n;
+        len -= n;
+    }
+    return 0;
+}
+
+// Folds src into dst
+int quantile_sketch_merge(quantile_sketch *dst, const quantile_sketch *src) {
+    if (dst->k != src->k) return -1;
+    // Level 0 is unsorted; the others are merged to stay sorted
+    quantile_level *d0 = &dst->levels[0];
+    if (quantile_level_reserve(d0, src->levels[0].len) != 0) return -1;
+    memcpy(d0->items + d0->len, src->levels[0].items, src->levels[0].len * sizeof(int64_t));
+    d0->len += src->levels[0].len;
+    for (uint32_t h = 1; h < src->nlevels; h++) {
+        if (quantile_level_merge(&dst->levels[h], src->levels[h].items, src->levels[h].len) != 0) return -1;
+    }
+    if (src->nlevels > dst->nlevels) dst->nlevels = src->nlevels;
+    dst->n += src->n;
+    dst->retained += src->retained;
+    if (src->min < dst->min) dst->min = src->min;
+    if (src->max > dst->max) dst->max = src->max;
+    quantile_sketch_resize(dst);
+    while (dst->retained >= dst->capacity) {
+        if (quantile_sketch_compress(dst) != 0) return -1;
+    }
+    return 0;
+}
+
+// One stored item with its weight, for answering queries
+typedef struct {
+    int64_t value;
+    uint64_t weight;
+} quantile_weighted;
+
+static int quantile_cmp_weighted(const void *a, const void *b) {
+    return quantile_cmp_i64(&((const quantile_weighted *)a)->value, &((const quantile_weighted *)b)->value);
+}
+
+// Stores the value at quantile q in *out
+int quantile_sketch_value(const quantile_sketch *s, double q, int64_t *out) {
+    if (s->n == 0) return -1;
+    if (!(q > 0)) {
+        *out = s->min;
+        return 0;
+    }
+    if (q >= 1) {
+        *out = s->max;
+        return 0;
+    }
+    quantile_weighted *all = malloc(s->retained * sizeof(*all));
+    if (!all) return -1;
+    size_t n = 0;
+    for (uint32_t h = 0; h < s->nlevels; h++) {
+        for (uint32_t i = 0; i < s->levels[h].len; i++) {
+            all[n].value = s->levels[h].items[i];
+            all[n++].weight = (uint64_t)1 << h;
+        }
+    }
+    array_sort(all, n, sizeof(*all), quantile_cmp_weighted);
+    uint64_t target = (uint64_t)(q * (double)s->n), seen = 0;
+    size_t i = 0;
+    while (i + 1 < n && (seen += all[i].weight) <= target) i++;
+    *out = all[i].value;
+    free(all);
+    return 0;
+}
@@ -0,0 +1,98 @@
+#ifndef QUANTILE_UTILS_H
+#define QUANTILE_UTILS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// A log-linear histogram of int64 values (the HdrHistogram layout). Values
+// below 2^precision get a bucket each; above that, every power-of-two range
+// is split into 2^precision buckets, so a reported quantile is within a
+// relative error of 2^-(precision + 1) of a value in the data. Memory is
+// fixed at (64 - precision) << precision counters, e.g. 58 KB for
+// precision 7. Negative values are counted in the bucket for 0; min and max
+// are tracked exactly. Not thread-safe: give each thread its own histogram
+// and merge them.
+typedef struct {
+    int precision;
+    size_t nbuckets;
+    uint64_t *counts;
+    uint64_t total;
+    int64_t min;
+    int64_t max;
+} quantile_hist;
+
+// Sets up an empty histogram; precision is 1 to 16. Returns 0, or -1 on a
+// bad precision or if out of memory.
+int quantile_hist_init(quantile_hist *h, int precision);
+
+// Releases the counters
+void quantile_hist_free(quantile_hist *h);
+
+// Forgets every value, keeping the counters allocated
+void quantile_hist_clear(quantile_hist *h);
+
+// Records one value, or count copies of it
+void quantile_hist_add(quantile_hist *h, int64_t value);
+void quantile_hist_add_n(quantile_hist *h, int64_t value, uint64_t count);
+
+// Records every element of arr
+void quantile_hist_add_array(quantile_hist *h, const int *arr, size_t len);
+
+// Adds the counts of src into dst. Returns 0, or -1 if the precisions differ.
+int quantile_hist_merge(quantile_hist *dst, const quantile_hist *src);
+
+// Stores the value at quantile q (0 = min, 0.5 = median, 1 = max) in *out.
+// Returns 0, or -1 when the histogram is empty.
+int quantile_hist_value(const quantile_hist *h, double q, int64_t *out);
+
+// Levels a sketch can grow to; level h holds items of weight 2^h
+#define QUANTILE_SKETCH_LEVELS 64
+
+// One level of a quantile sketch
+typedef struct {
+    int64_t *items;
+    uint32_t len;
+    uint32_t alloc;         // allocated items
+    uint32_t capacity;      // items before the level is due for compaction
+} quantile_level;
+
+// A KLL quantile sketch of int64 values. Each level is a buffer of items
+// that stand for 2^level inputs each; when the sketch is over capacity, the
+// lowest full level is sorted and every other item (starting at a random
+// offset) is promoted, so the memory stays near 3k items however many
+// values are added. A quantile's rank is off by about 1.65/k of the count
+// (1% for k = 200) with high probability. Sketches with the same k merge
+// without losing accuracy. Not thread-safe: give each thread its own
+// sketch and merge them.
+typedef struct {
+    uint32_t k;
+    uint32_t nlevels;
+    uint64_t n;             // values added
+    int64_t min;
+    int64_t max;
+    size_t retained;        // items stored over all levels
+    size_t capacity;        // compaction starts when retained reaches this
+    uint64_t rng;           // picks the compaction offsets
+    quantile_level levels[QUANTILE_SKETCH_LEVELS];
+} quantile_sketch;
+
+// Sets up an empty sketch with accuracy parameter k (8 to 65535; 200 is a
+// good default). Returns 0, or -1 on a bad k.
+int quantile_sketch_init(quantile_sketch *s, uint32_t k);
+
+// Releases the sketch's buffers
+void quantile_sketch_free(quantile_sketch *s);
+
+// Records one value, or every element of arr. Return 0, or -1 if out of
+// memory (the sketch then holds what was added before the failure).
+int quantile_sketch_add(quantile_sketch *s, int64_t value);
+int quantile_sketch_add_array(quantile_sketch *s, const int *arr, size_t len);
+
+// Folds src into dst. Returns 0, or -1 if the k differ or out of memory.
+int quantile_sketch_merge(quantile_sketch *dst, const quantile_sketch *src);
+
+// Stores the value at quantile q in *out. Returns 0, or -1 when the sketch
+// is empty or out of memory.
+int quantile_sketch_value(const quantile_sketch *s, double q, int64_t *out);
+
+#endif // QUANTILE_UTILS_H
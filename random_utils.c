@@ -0,0 +1,364 @@
+#include "random_utils.h"
+#include <stdatomic.h>
+
+// The bulk fills choose AVX2 at run time; the plain C lanes produce the
+// same values on other CPUs
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RANDOM_X86 1
+#define RANDOM_HAS_AVX2() __builtin_cpu_supports("avx2")
+#endif
+
+#define RANDOM_PCG_MULT 6364136223846793005ULL
+
+// Internal helper: one step of SplitMix64, used to expand seeds
+static uint64_t random_splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t random_rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// Seeds a xoshiro256** generator via SplitMix64
+void random_xoshiro_seed(random_xoshiro *r, uint64_t seed) {
+    for (int i = 0; i < 4; i++) r->s[i] = random_splitmix64(&seed);
+}
+
+// Seeds a xoshiro256** generator as one stream of a seed
+void random_xoshiro_stream(random_xoshiro *r, uint64_t seed, uint64_t stream) {
+    random_xoshiro_seed(r, seed);
+    for (uint64_t i = 0; i < stream; i++) random_xoshiro_jump(r);
+}
+
+// Returns the next 64-bit output
+uint64_t random_xoshiro_next(random_xoshiro *r) {
+    uint64_t *s = r->s;
+    uint64_t result = random_rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = random_rotl(s[3], 45);
+    return result;
+}
+
+// Internal helper: advances r by the jump polynomial in poly
+static void random_xoshiro_jump_by(random_xoshiro *r, const uint64_t poly[4]) {
+    uint64_t s[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (poly[i] >> b & 1) {
+                for (int w = 0; w < 4; w++) s[w] ^= r->s[w];
+            }
+            random_xoshiro_next(r);
+        }
+    }
+    for (int w = 0; w < 4; w++) r->s[w] = s[w];
+}
+
+// Advances the generator by 2^128 steps
+void random_xoshiro_jump(random_xoshiro *r) {
+    static const uint64_t jump[4] = {
+        0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+    };
+    random_xoshiro_jump_by(r, jump);
+}
+
+// Advances the generator by 2^192 steps
+void random_xoshiro_long_jump(random_xoshiro *r) {
+    static const uint64_t long_jump[4] = {
+        0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL, 0x77710069854ee241ULL, 0x39109bb02acbe635ULL
+    };
+    random_xoshiro_jump_by(r, long_jump);
+}
+
+// Returns a uniform value below bound
+uint64_t random_xoshiro_bounded(random_xoshiro *r, uint64_t bound) {
+    unsigned __int128 m = (unsigned __int128)random_xoshiro_next(r) * bound;
+    uint64_t low = (uint64_t)m;
+    if (low < bound) {
+        // Reject the 2^64 mod bound lowest products, which would bias the
+        // result towards small values
+        uint64_t threshold = -bound % bound;
+        while (low < threshold) {
+            m = (unsigned __int128)random_xoshiro_next(r) * bound;
+            low = (uint64_t)m;
+        }
+    }
+    return (uint64_t)(m >> 64);
+}
+
+// Returns a uniform int in [lo, hi]
+int random_xoshiro_range(random_xoshiro *r, int lo, int hi) {
+    uint64_t span = (uint64_t)((int64_t)hi - lo) + 1;
+    return (int)((uint32_t)lo + (uint32_t)random_xoshiro_bounded(r, span));
+}
+
+// Returns a uniform double in [0, 1)
+double random_xoshiro_double(random_xoshiro *r) {
+    return (double)(random_xoshiro_next(r) >> 11) * 0x1.0p-53;
+}
+
+// Seeds a PCG32 generator, following the reference pcg32_srandom_r
+void random_pcg32_seed(random_pcg32 *r, uint64_t seed, uint64_t stream) {
+    r->state = 0;
+    r->inc = (stream << 1) | 1;
+    random_pcg32_next(r);
+    r->state += seed;
+    random_pcg32_next(r);
+}
+
+// Returns the next 32-bit output
+uint32_t random_pcg32_next(random_pcg32 *r) {
+    uint64_t old = r->state;
+    r->state = old * RANDOM_PCG_MULT + r->inc;
+    uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rot = (uint32_t)(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+// Advances the generator by delta steps
+void random_pcg32_advance(random_pcg32 *r, uint64_t delta) {
+    // Square-and-multiply on the LCG step x -> mult * x + inc (Brown,
+    // "Random Number Generation with Arbitrary Strides")
+    uint64_t cur_mult = RANDOM_PCG_MULT, cur_plus = r->inc;
+    uint64_t acc_mult = 1, acc_plus = 0;
+    for (; delta > 0; delta >>= 1) {
+        if (delta & 1) {
+            acc_mult *= cur_mult;
+            acc_plus = acc_plus * cur_mult + cur_plus;
+        }
+        cur_plus = (cur_mult + 1) * cur_plus;
+        cur_mult *= cur_mult;
+    }
+    r->state = acc_mult * r->state + acc_plus;
+}
+
+// Returns a uniform value below bound
+uint32_t random_pcg32_bounded(random_pcg32 *r, uint32_t bound) {
+    uint64_t m = (uint64_t)random_pcg32_next(r) * bound;
+    uint32_t low = (uint32_t)m;
+    if (low < bound) {
+        uint32_t threshold = -bound % bound;
+        while (low < threshold) {
+            m = (uint64_t)random_pcg32_next(r) * bound;
+            low = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+static atomic_uint_fast64_t random_thread_seed = 0;
+static atomic_uint_fast64_t random_next_stream = 0;
+static _Thread_local random_xoshiro random_thread_state;
+static _Thread_local int random_thread_ready = 0;
+
+// Sets the seed for per-thread generators
+void random_set_seed(uint64_t seed) {
+    atomic_store(&random_thread_seed, seed);
+}
+
+// Returns the calling thread's generator, creating it on first use
+random_xoshiro *random_thread_rng(void) {
+    if (!random_thread_ready) {
+        random_xoshiro_stream(&random_thread_state, atomic_load(&random_thread_seed),
+                              atomic_fetch_add(&random_next_stream, 1));
+        random_thread_ready = 1;
+    }
+    return &random_thread_state;
+}
+
+// Four xoshiro256** generators side by side: word w of lane j is s[w][j],
+// so each row loads straight into one AVX2 register
+typedef struct {
+    uint64_t s[4][4];
+} random_lanes;
+
+// Internal helper: seeds the lanes from four outputs of r
+static void random_lanes_seed(random_lanes *l, random_xoshiro *r) {
+    for (int j = 0; j < 4; j++) {
+        uint64_t x = random_xoshiro_next(r);
+        for (int w = 0; w < 4; w++) l->s[w][j] = random_splitmix64(&x);
+    }
+}
+
+// Internal helper: one step of every lane, outputs in lane order
+static inline void random_lanes_next(random_lanes *l, uint64_t out[4]) {
+    for (int j = 0; j < 4; j++) {
+        random_xoshiro r = { { l->s[0][j], l->s[1][j], l->s[2][j], l->s[3][j] } };
+        out[j] = random_xoshiro_next(&r);
+        for (int w = 0; w < 4; w++) l->s[w][j] = r.s[w];
+    }
+}
+
+// Internal helper: draw for random_fill_int. Accepts a 32-bit candidate
+// when its product with span does not fall in the biased low range, and
+// stores the offset from lo.
+static inline int random_accept32(uint32_t c, uint32_t span, uint32_t threshold, uint32_t *out) {
+    if (span == 0) {
+        *out = c;
+        return 1;
+    }
+    uint64_t m = (uint64_t)c * span;
+    *out = (uint32_t)(m >> 32);
+    return (uint32_t)m >= threshold;
+}
+
+#ifdef RANDOM_X86
+// Internal helper: one step of four lanes held in registers
+__attribute__((target("avx2")))
+static inline __m256i random_lanes_next_avx2(__m256i s[4]) {
+    __m256i x = _mm256_add_epi64(_mm256_slli_epi64(s[1], 2), s[1]);
+    x = _mm256_or_si256(_mm256_slli_epi64(x, 7), _mm256_srli_epi64(x, 57));
+    __m256i result = _mm256_add_epi64(_mm256_slli_epi64(x, 3), x);
+    __m256i t = _mm256_slli_epi64(s[1], 17);
+    s[2] = _mm256_xor_si256(s[2], s[0]);
+    s[3] = _mm256_xor_si256(s[3], s[1]);
+    s[1] = _mm256_xor_si256(s[1], s[2]);
+    s[0] = _mm256_xor_si256(s[0], s[3]);
+    s[2] = _mm256_xor_si256(s[2], t);
+    s[3] = _mm256_or_si256(_mm256_slli_epi64(s[3], 45), _mm256_srli_epi64(s[3], 19));
+    return result;
+}
+
+// Internal helper: (x >> 11) * 2^-53 on four lanes, exactly, by converting
+// the 53 bits as two halves small enough for the 2^52 bit-pattern trick
+__attribute__((target("avx2")))
+static inline __m256d random_to_double_avx2(__m256i x) {
+    const __m256i magic = _mm256_set1_epi64x(0x4330000000000000LL);
+    const __m256d two52 = _mm256_set1_pd(0x1.0p52);
+    __m256i t = _mm256_srli_epi64(x, 11);
+    __m256d hi = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(t, 26), magic)), two52);
+    __m256d lo = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(
+                     _mm256_and_si256(t, _mm256_set1_epi64x((1 << 26) - 1)), magic)), two52);
+    return _mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(hi, _mm256_set1_pd(0x1.0p26)), lo),
+                         _mm256_set1_pd(0x1.0p-53));
+}
+
+__attribute__((target("avx2")))
+static void random_fill_u64_avx2(random_lanes *l, uint64_t *dst, size_t n) {
+    __m256i s[4];
+    for (int w = 0; w < 4; w++) s[w] = _mm256_loadu_si256((const __m256i *)l->s[w]);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_si256((__m256i *)(dst + i), random_lanes_next_avx2(s));
+    if (i < n) {
+        uint64_t tail[4];
+        _mm256_storeu_si256((__m256i *)tail, random_lanes_next_avx2(s));
+        for (size_t j = 0; i < n; j++) dst[i++] = tail[j];
+    }
+}
+
+__attribute__((target("avx2")))
+static void random_fill_double_avx2(random_lanes *l, double *dst, size_t n) {
+    __m256i s[4];
+    for (int w = 0; w < 4; w++) s[w] = _mm256_loadu_si256((const __m256i *)l->s[w]);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(dst + i, random_to_double_avx2(random_lanes_next_avx2(s)));
+    if (i < n) {
+        double tail[4];
+        _mm256_storeu_pd(tail, random_to_double_avx2(random_lanes_next_avx2(s)));
+        for (size_t j = 0; i < n; j++) dst[i++] = tail[j];
+    }
+}
+
+// Takes each 64-bit output as two 32-bit candidates, low half first, and
+// keeps the accepted ones in order
+__attribute__((target("avx2")))
+static void random_fill_int_avx2(random_lanes *l, int *dst, size_t n, int lo,
+                                 uint32_t span, uint32_t threshold) {
+    const __m256i spanv = _mm256_set1_epi32((int)span);
+    const __m256i thresholdv = _mm256_set1_epi32((int)threshold);
+    const __m256i lov = _mm256_set1_epi32(lo);
+    __m256i s[4];
+    for (int w = 0; w < 4; w++) s[w] = _mm256_loadu_si256((const __m256i *)l->s[w]);
+    size_t i = 0;
+    while (i < n) {
+        __m256i c = random_lanes_next_avx2(s);
+        __m256i even = _mm256_mul_epu32(c, spanv);
+        __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(c, 32), spanv);
+        __m256i low = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xaa);
+        __m256i high = span ? _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xaa) : c;
+        __m256i ok = _mm256_cmpeq_epi32(_mm256_max_epu32(low, thresholdv), low);
+        __m256i v = _mm256_add_epi32(high, lov);
+        if (_mm256_movemask_epi8(ok) == -1 && n - i >= 8) {
+            _mm256_storeu_si256((__m256i *)(dst + i), v);
+            i += 8;
+            continue;
+        }
+        int vals[8];
+        _mm256_storeu_si256((__m256i *)vals, v);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(ok));
+        for (int k = 0; k < 8 && i < n; k++)
+            if (mask >> k & 1) dst[i++] = vals[k];
+    }
+}
+#endif
+
+// Fills dst with n 64-bit outputs of four side-by-side lanes
+void random_fill_u64(random_xoshiro *r, uint64_t *dst, size_t n) {
+    random_lanes l;
+    random_lanes_seed(&l, r);
+#ifdef RANDOM_X86
+    if (RANDOM_HAS_AVX2()) {
+        random_fill_u64_avx2(&l, dst, n);
+        return;
+    }
+#endif
+    uint64_t out[4];
+    for (size_t i = 0; i < n; i += 4) {
+        random_lanes_next(&l, out);
+        for (size_t j = 0; j < 4 && i + j < n; j++) dst[i + j] = out[j];
+    }
+}
+
+// Fills dst with n uniform doubles in [0, 1)
+void random_fill_double(random_xoshiro *r, double *dst, size_t n) {
+    random_lanes l;
+    random_lanes_seed(&l, r);
+#ifdef RANDOM_X86
+    if (RANDOM_HAS_AVX2()) {
+        random_fill_double_avx2(&l, dst, n);
+        return;
+    }
+#endif
+    uint64_t out[4];
+    for (size_t i = 0; i < n; i += 4) {
+        random_lanes_next(&l, out);
+        for (size_t j = 0; j < 4 && i + j < n; j++) dst[i + j] = (double)(out[j] >> 11) * 0x1.0p-53;
+    }
+}
+
+// Fills dst with n uniform ints in [lo, hi]
+int random_fill_int(random_xoshiro *r, int *dst, size_t n, int lo, int hi) {
+    if (lo > hi) return -1;
+    // span wraps to 0 for the full int range, where every candidate is
+    // used as it is
+    uint32_t span = (uint32_t)hi - (uint32_t)lo + 1;
+    uint32_t threshold = span ? -span % span : 0;
+    random_lanes l;
+    random_lanes_seed(&l, r);
+#ifdef RANDOM_X86
+    if (RANDOM_HAS_AVX2()) {
+        random_fill_int_avx2(&l, dst, n, lo, span, threshold);
+        return 0;
+    }
+#endif
+    uint64_t out[4];
+    size_t i = 0;
+    while (i < n) {
+        random_lanes_next(&l, out);
+        for (int k = 0; k < 8 && i < n; k++) {
+            uint32_t c = (uint32_t)(out[k / 2] >> (k % 2 * 32)), v;
+            if (random_accept32(c, span, threshold, &v)) dst[i++] = (int)((uint32_t)lo + v);
+        }
+    }
+    return 0;
+}
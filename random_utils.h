@@ -0,0 +1,69 @@
+#ifndef RANDOM_UTILS_H
+#define RANDOM_UTILS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Seedable pseudo-random generators. Neither is suitable for cryptography.
+
+// xoshiro256**: 64-bit outputs, period 2^256 - 1, with jumps of 2^128 and
+// 2^192 steps for splitting one seed into non-overlapping streams
+typedef struct {
+    uint64_t s[4];
+} random_xoshiro;
+
+// PCG32 (XSH RR): 32-bit outputs, period 2^64 per stream, 2^63 streams,
+// and jump-ahead by any number of steps in O(log n)
+typedef struct {
+    uint64_t state;
+    uint64_t inc;       // stream selector, always odd
+} random_pcg32;
+
+// Seeds r from a single 64-bit value (expanded with SplitMix64, so any
+// seed, including 0, gives a well-mixed state)
+void random_xoshiro_seed(random_xoshiro *r, uint64_t seed);
+// Seeds r as stream number stream of seed: the seed's state advanced by
+// stream * 2^128 steps. Costs one jump per stream, so stream numbers are
+// meant to be small, such as thread indices.
+void random_xoshiro_stream(random_xoshiro *r, uint64_t seed, uint64_t stream);
+uint64_t random_xoshiro_next(random_xoshiro *r);
+// Advances r by 2^128 and 2^192 steps
+void random_xoshiro_jump(random_xoshiro *r);
+void random_xoshiro_long_jump(random_xoshiro *r);
+
+// Uniform value in [0, bound) without modulo bias (Lemire's multiply and
+// reject method); 0 when bound is 0
+uint64_t random_xoshiro_bounded(random_xoshiro *r, uint64_t bound);
+// Uniform int in [lo, hi]; lo must not exceed hi
+int random_xoshiro_range(random_xoshiro *r, int lo, int hi);
+// Uniform double in [0, 1), a multiple of 2^-53
+double random_xoshiro_double(random_xoshiro *r);
+
+// Seeds r with a starting state and a stream; different streams give
+// independent sequences from the same seed
+void random_pcg32_seed(random_pcg32 *r, uint64_t seed, uint64_t stream);
+uint32_t random_pcg32_next(random_pcg32 *r);
+// Advances r by delta steps, as if random_pcg32_next were called delta times
+void random_pcg32_advance(random_pcg32 *r, uint64_t delta);
+// Uniform value in [0, bound) without modulo bias; 0 when bound is 0
+uint32_t random_pcg32_bounded(random_pcg32 *r, uint32_t bound);
+
+// Sets the seed of the per-thread generators created from now on
+void random_set_seed(uint64_t seed);
+// Returns the calling thread's generator. Each thread's first call takes
+// the next stream of the seed (see random_xoshiro_stream), so threads get
+// non-overlapping sequences; which thread gets which stream depends on
+// the order of first calls.
+random_xoshiro *random_thread_rng(void);
+
+// Bulk fills. These run four xoshiro256** lanes side by side (AVX2 when
+// the CPU has it, plain C otherwise, with identical output), seeded from
+// r, and advance r by four steps per call. The values are therefore not
+// the ones n single calls on r would give.
+void random_fill_u64(random_xoshiro *r, uint64_t *dst, size_t n);
+// Uniform doubles in [0, 1), as random_xoshiro_double
+void random_fill_double(random_xoshiro *r, double *dst, size_t n);
+// Uniform ints in [lo, hi] without modulo bias. Returns 0, or -1 if lo > hi.
+int random_fill_int(random_xoshiro *r, int *dst, size_t n, int lo, int hi);
+
+#endif // RANDOM_UTILS_H
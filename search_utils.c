@@ -0,0 +1,311 @@
+#include "search_utils.h"
+#include <stdlib.h>
+#include <string.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#define AC_NONE UINT32_MAX
+
+// Internal helper: ASCII-only lowercase
+static unsigned char ac_fold(unsigned char c) {
+    return (unsigned char)(c - 'A') < 26 ? c + 32 : c;
+}
+
+// Internal helper: assigns one class per distinct pattern byte (both ASCII
+// cases share a class with AC_NOCASE); class 0 is every other byte
+static void ac_make_classes(ac_automaton *ac, const str_view *patterns, size_t n, int flags) {
+    memset(ac->classes, 0, sizeof(ac->classes));
+    uint32_t next = 1;
+    for (size_t p = 0; p < n; p++) {
+        for (size_t i = 0; i < patterns[p].len; i++) {
+            unsigned char c = (unsigned char)patterns[p].data[i];
+            if (flags & AC_NOCASE) c = ac_fold(c);
+            if (ac->classes[c]) continue;
+            ac->classes[c] = (uint16_t)next;
+            if ((flags & AC_NOCASE) && (unsigned char)(c - 'a') < 26) {
+                ac->classes[c - 32] = (uint16_t)next;
+            }
+            next++;
+        }
+    }
+    ac->nclasses = next;
+    ac->stride_shift = 1;
+    while ((1u << ac->stride_shift) < next) ac->stride_shift++;
+    ac->stride = 1u << ac->stride_shift;
+}
+
+// Internal helper: reads the prefix_len bytes at p as a key. With AC_NOCASE
+// every byte gets 0x20 OR'd in, which folds ASCII letters; other bytes may
+// collide, which only costs a false candidate.
+static inline uint32_t ac_prefix_key(const ac_automaton *ac, const unsigned char *p) {
+    uint32_t key = 0;
+    for (uint32_t i = 0; i < ac->prefix_len; i++) key |= (uint32_t)p[i] << (8 * i);
+    return (key | ac->prefix_fold) & ac->prefix_mask;
+}
+
+// Internal helper: hashes a prefix key to one of 65536 filter bits
+static inline uint32_t ac_prefix_hash(uint32_t key) {
+    return (key * 0x9E3779B1u) >> 16;
+}
+
+// Internal helper: sets the prefilter bit of every non-empty pattern
+static void ac_make_prefilter(ac_automaton *ac, const str_view *patterns, size_t n, int flags) {
+    size_t shortest = 4;
+    for (size_t p = 0; p < n; p++) {
+        if (patterns[p].len && patterns[p].len < shortest) shortest = patterns[p].len;
+    }
+    ac->prefix_len = (uint32_t)shortest;
+    ac->prefix_mask = shortest == 4 ? 0xffffffffu : (1u << (8 * shortest)) - 1;
+    ac->prefix_fold = (flags & AC_NOCASE) ? 0x20202020u & ac->prefix_mask : 0;
+    memset(ac->prefilter, 0, sizeof(ac->prefilter));
+    for (size_t p = 0; p < n; p++) {
+        if (!patterns[p].len) continue;
+        uint32_t h = ac_prefix_hash(ac_prefix_key(ac, (const unsigned char *)patterns[p].data));
+        ac->prefilter[h >> 6] |= 1ULL << (h & 63);
+    }
+}
+
+// Compiles n patterns into a dense DFA over byte classes
+ac_automaton *ac_build(const str_view *patterns, size_t n, int flags) {
+    ac_automaton *ac = calloc(1, sizeof(*ac));
+    if (!ac) return NULL;
+    size_t max_states = 1;
+    for (size_t p = 0; p < n; p++) max_states += patterns[p].len;
+    ac_make_classes(ac, patterns, n, flags);
+    if (max_states > (UINT32_MAX / 2) / ac->stride) {
+        free(ac);
+        return NULL;
+    }
+    uint32_t stride = ac->stride;
+    uint32_t *go = malloc(max_states * stride * sizeof(*go));
+    uint32_t *fail = malloc(max_states * sizeof(*fail));
+    uint32_t *queue = malloc(max_states * sizeof(*queue));
+    ac->out = malloc(max_states * sizeof(*ac->out));
+    ac->dict = malloc(max_states * sizeof(*ac->dict));
+    ac->out_next = malloc((n ? n : 1) * sizeof(*ac->out_next));
+    ac->pattern_len = malloc((n ? n : 1) * sizeof(*ac->pattern_len));
+    ac->depth = malloc(max_states * sizeof(*ac->depth));
+    if (!go || !fail || !queue || !ac->out || !ac->dict || !ac->out_next || !ac->pattern_len ||
+        !ac->depth) {
+        free(go);
+        free(fail);
+        free(queue);
+        ac_free(ac);
+        return NULL;
+    }
+    ac->npatterns = n;
+
+    // Trie: go[] holds state numbers here, AC_NONE for missing edges
+    memset(go, 0xff, stride * sizeof(*go));
+    ac->out[0] = -1;
+    ac->depth[0] = 0;
+    uint32_t nstates = 1;
+    for (size_t p = 0; p < n; p++) {
+        ac->pattern_len[p] = patterns[p].len;
+        ac->out_next[p] = -1;
+        if (patterns[p].len == 0) continue;
+        uint32_t s = 0;
+        for (size_t i = 0; i < patterns[p].len; i++) {
+            uint32_t c = ac->classes[(unsigned char)patterns[p].data[i]];
+            if (go[s * stride + c] == AC_NONE) {
+                memset(go + (size_t)nstates * stride, 0xff, stride * sizeof(*go));
+                ac->out[nstates] = -1;
+                ac->depth[nstates] = ac->depth[s] + 1;
+                go[s * stride + c] = nstates++;
+            }
+            s = go[s * stride + c];
+        }
+        // Duplicate patterns chain off the first one so each id is reported
+        ac->out_next[p] = ac->out[s];
+        ac->out[s] = (int32_t)p;
+    }
+
+    // Breadth-first pass: fill failure links and turn missing edges into the
+    // failure state's edges, which completes the DFA
+    size_t head = 0, tail = 0;
+    fail[0] = 0;
+    ac->dict[0] = AC_NONE;
+    for (uint32_t c = 0; c < stride; c++) {
+        uint32_t v = go[c];
+        if (v == AC_NONE || c >= ac->nclasses) {
+            go[c] = 0;
+        } else {
+            fail[v] = 0;
+            ac->dict[v] = AC_NONE;
+            queue[tail++] = v;
+        }
+    }
+    while (head < tail) {
+        uint32_t u = queue[head++];
+        for (uint32_t c = 0; c < stride; c++) {
+            uint32_t v = go[(size_t)u * stride + c];
+            uint32_t fv = go[(size_t)fail[u] * stride + c];
+            if (v == AC_NONE) {
+                go[(size_t)u * stride + c] = fv;
+            } else {
+                fail[v] = fv;
+                ac->dict[v] = ac->out[fv] >= 0 ? fv : ac->dict[fv];
+                queue[tail++] = v;
+            }
+        }
+    }
+
+    // Encode entries as row offsets with a has-output flag in bit 0
+    for (size_t i = 0; i < (size_t)nstates * stride; i++) {
+        uint32_t v = go[i];
+        uint32_t flag = ac->out[v] >= 0 || ac->dict[v] != AC_NONE;
+        go[i] = v * stride | flag;
+    }
+    // Trim the trie allocation down to the states actually created
+    uint32_t *table = realloc(go, (size_t)nstates * stride * sizeof(*go));
+    ac->table = table ? table : go;
+    ac->nstates = nstates;
+    ac_make_prefilter(ac, patterns, n, flags);
+    free(fail);
+    free(queue);
+    return ac;
+}
+
+// Releases an automaton
+void ac_free(ac_automaton *ac) {
+    if (!ac) return;
+    free(ac->table);
+    free(ac->out);
+    free(ac->dict);
+    free(ac->out_next);
+    free(ac->pattern_len);
+    free(ac->depth);
+    free(ac);
+}
+
+// Resets a cursor to the start of a new input
+void ac_cursor_init(ac_cursor *cur) {
+    cur->state = 0;
+    cur->offset = 0;
+}
+
+// Internal helper: reports every pattern ending in state s; returns the
+// number reported, with *stop set if the callback asked to stop
+static size_t ac_report(const ac_automaton *ac, uint32_t s, size_t end,
+                        ac_match_fn fn, void *ctx, int *stop) {
+    size_t count = 0;
+    for (; s != AC_NONE; s = ac->dict[s]) {
+        for (int32_t id = ac->out[s]; id >= 0; id = ac->out_next[id]) {
+            count++;
+            if (fn && fn(ctx, (size_t)id, end)) {
+                *stop = 1;
+                return count;
+            }
+        }
+    }
+    return count;
+}
+
+// Scans len bytes; the hot loop is one class lookup and one table load per byte
+size_t ac_scan(const ac_automaton *ac, ac_cursor *cur, const char *data, size_t len,
+               ac_match_fn fn, void *ctx) {
+    const uint32_t *table = ac->table;
+    const uint16_t *classes = ac->classes;
+    const unsigned char *p = (const unsigned char *)data;
+    uint32_t row = cur->state;
+    size_t count = 0;
+    int stop = 0;
+    for (size_t i = 0; i < len; i++) {
+        uint32_t e = table[row + classes[p[i]]];
+        row = e & ~1u;
+        if (e & 1) {
+            count += ac_report(ac, row >> ac->stride_shift, cur->offset + i + 1, fn, ctx, &stop);
+            if (stop) {
+                cur->state = row;
+                cur->offset += i + 1;
+                return count;
+            }
+        }
+    }
+    cur->state = row;
+    cur->offset += len;
+    return count;
+}
+
+// Internal helper: walks trie edges from the root over data[i..], reporting
+// the patterns that start at i. A DFA edge is a trie edge exactly when it
+// goes one level deeper; failure-derived edges never do.
+static size_t ac_walk_from(const ac_automaton *ac, const unsigned char *data, size_t len,
+                           size_t i, ac_match_fn fn, void *ctx, int *stop) {
+    size_t count = 0;
+    uint32_t state = 0;
+    for (size_t j = i; j < len; j++) {
+        uint32_t next = ac->table[(state << ac->stride_shift) + ac->classes[data[j]]] >> ac->stride_shift;
+        if (ac->depth[next] != ac->depth[state] + 1) break;
+        state = next;
+        for (int32_t id = ac->out[state]; id >= 0; id = ac->out_next[id]) {
+            count++;
+            if (fn && fn(ctx, (size_t)id, j + 1)) {
+                *stop = 1;
+                return count;
+            }
+        }
+    }
+    return count;
+}
+
+// Scans a complete buffer, probing the prefix filter at every position. Each
+// probe is independent of the last, so the CPU overlaps them freely.
+size_t ac_scan_buffer(const ac_automaton *ac, const char *data, size_t len,
+                      ac_match_fn fn, void *ctx) {
+    const unsigned char *p = (const unsigned char *)data;
+    const uint64_t *filter = ac->prefilter;
+    uint32_t mask = ac->prefix_mask, fold = ac->prefix_fold;
+    size_t count = 0;
+    int stop = 0;
+    if (ac->npatterns == 0 || len < ac->prefix_len) return 0;
+    size_t end = len - ac->prefix_len + 1;
+    size_t i = 0;
+#if defined(__AVX2__)
+    // 32 positions per step: four overlapping loads give the 4-byte keys at
+    // offsets o, o + 4, ..., o + 28; eight hashes at a time are tested with a
+    // gather, and each hit bit is shifted into the sign for movemask
+    static const uint32_t spread4[16] = {
+        0x0000, 0x0001, 0x0010, 0x0011, 0x0100, 0x0101, 0x0110, 0x0111,
+        0x1000, 0x1001, 0x1010, 0x1011, 0x1100, 0x1101, 0x1110, 0x1111,
+    };
+    const __m256i vfold = _mm256_set1_epi32((int)fold), vmask = _mm256_set1_epi32((int)mask);
+    const __m256i vmul = _mm256_set1_epi32((int)0x9E3779B1u), v31 = _mm256_set1_epi32(31);
+    const int *filter32 = (const int *)filter;
+    for (; i + 35 <= len; i += 32) {
+        uint32_t hits = 0;
+        for (int o = 0; o < 4; o++) {
+            __m256i k = _mm256_loadu_si256((const __m256i *)(p + i + o));
+            k = _mm256_and_si256(_mm256_or_si256(k, vfold), vmask);
+            __m256i h = _mm256_srli_epi32(_mm256_mullo_epi32(k, vmul), 16);
+            __m256i w = _mm256_i32gather_epi32(filter32, _mm256_srli_epi32(h, 5), 4);
+            w = _mm256_sllv_epi32(w, _mm256_sub_epi32(v31, _mm256_and_si256(h, v31)));
+            uint32_t m = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(w));
+            hits |= (spread4[m & 15] | spread4[m >> 4] << 16) << o;
+        }
+        while (hits) {
+            count += ac_walk_from(ac, p, len, i + (size_t)__builtin_ctz(hits), fn, ctx, &stop);
+            if (stop) return count;
+            hits &= hits - 1;
+        }
+    }
+#endif
+    for (; i + 4 <= len; i++) {
+        uint32_t key;
+        memcpy(&key, p + i, sizeof(key));
+        uint32_t h = ac_prefix_hash((key | fold) & mask);
+        if (filter[h >> 6] & (1ULL << (h & 63))) {
+            count += ac_walk_from(ac, p, len, i, fn, ctx, &stop);
+            if (stop) return count;
+        }
+    }
+    for (; i < end; i++) {
+        uint32_t h = ac_prefix_hash(ac_prefix_key(ac, p + i));
+        if (filter[h >> 6] & (1ULL << (h & 63))) {
+            count += ac_walk_from(ac, p, len, i, fn, ctx, &stop);
+            if (stop) return count;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,69 @@
+#ifndef SEARCH_UTILS_H
+#define SEARCH_UTILS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "string_utils.h"
+
+// ac_build flag: match patterns ignoring ASCII case
+#define AC_NOCASE 1
+
+// A compiled Aho-Corasick automaton for finding many patterns in one pass.
+// Bytes are first mapped to equivalence classes (bytes that appear in no
+// pattern share one class), so each DFA row is only nclasses wide and the
+// whole table stays cache-resident for hundreds of keywords.
+typedef struct {
+    uint16_t classes[256];
+    uint32_t nclasses;
+    uint32_t stride;        // row width in table entries (power of two >= 2)
+    uint32_t stride_shift;  // log2(stride), maps a row offset back to its state
+    uint32_t nstates;
+    uint32_t *table;        // next row offset, bit 0 set if that state reports matches
+    int32_t *out;           // per state: first pattern ending here, or -1
+    uint32_t *dict;         // per state: nearest suffix state with output, or UINT32_MAX
+    int32_t *out_next;      // per pattern: next pattern with the same text, or -1
+    size_t *pattern_len;    // per pattern: length in bytes
+    size_t npatterns;
+    uint32_t *depth;        // per state: trie depth
+    uint32_t prefix_len;    // bytes hashed by the prefilter (1 to 4)
+    uint32_t prefix_mask;   // keeps the low prefix_len bytes of a 32-bit load
+    uint32_t prefix_fold;   // 0x20 per byte with AC_NOCASE, else 0
+    uint64_t prefilter[1024]; // bitmap of hashed pattern prefixes
+} ac_automaton;
+
+// Scan position carried across calls so input can be fed in chunks
+typedef struct {
+    uint32_t state;         // current row offset
+    size_t offset;          // bytes consumed so far
+} ac_cursor;
+
+// Called for each match with the pattern id (its index in ac_build) and the
+// byte offset one past the match end; return nonzero to stop the scan
+typedef int (*ac_match_fn)(void *ctx, size_t pattern_id, size_t end);
+
+// Compiles n patterns into an automaton; empty patterns never match.
+// Returns NULL on error.
+ac_automaton *ac_build(const str_view *patterns, size_t n, int flags);
+
+// Releases an automaton
+void ac_free(ac_automaton *ac);
+
+// Resets a cursor to the start of a new input
+void ac_cursor_init(ac_cursor *cur);
+
+// Scans len bytes, reporting matches to fn (which may be NULL to only
+// count). Matches that straddle chunk boundaries are found when the same
+// cursor is reused. Returns the number of matches reported.
+size_t ac_scan(const ac_automaton *ac, ac_cursor *cur, const char *data, size_t len,
+               ac_match_fn fn, void *ctx);
+
+// Scans a complete in-memory buffer (e.g. an mmap'd file). A hashed bitmap
+// of pattern prefixes (the first 4 bytes, or fewer if a pattern is shorter)
+// rejects most positions with one load and one bit test, and only
+// candidate positions walk the trie, so throughput stays well above the
+// byte-at-a-time DFA when matches are rare. Matches are reported in order of
+// their start offset. Returns the number of matches reported.
+size_t ac_scan_buffer(const ac_automaton *ac, const char *data, size_t len,
+                      ac_match_fn fn, void *ctx);
+
+#endif // SEARCH_UTILS_H
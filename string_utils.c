@@ -1,6 +1,15 @@
 #include "string_utils.h"
+#include "char_utils.h"
 #include <ctype.h>
 #include <stdlib.h>
+#include <string.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 // Returns the length of a string
 int str_length(const char *s) {
@@ -68,6 +77,16 @@ void str_to_lower(char *s) {
     }
 }
 
+// Converts string to ASCII uppercase in place, a vector block at a time
+void str_to_upper_ascii(char *s) {
+    if (s) ascii_to_upper_buf(s, strlen(s));
+}
+
+// Converts string to ASCII lowercase in place, a vector block at a time
+void str_to_lower_ascii(char *s) {
+    if (s) ascii_to_lower_buf(s, strlen(s));
+}
+
 // Returns 1 if s starts with prefix, 0 otherwise
 int str_starts_with(const char *s, const char *prefix) {
     while (*prefix) {
@@ -124,6 +143,11 @@ char *str_dup(const char *s) {
     return copy;
 }
 
+// Returns a copy of s allocated from arena a, or NULL on error
+char *str_dup_arena(arena *a, const char *s) {
+    return sv_dup_arena(a, sv_from_cstr(s));
+}
+
 // Returns 1 if s is NULL or empty, 0 otherwise
 int str_is_empty(const char *s) {
     return !s || *s == '\0';
@@ -160,3 +184,1071 @@ char *str_repeat(char *s, char c, int n) {
     s[n] = '\0';
     return s;
 }
+
+// Makes a view of len bytes at data
+str_view sv_make(const char *data, size_t len) {
+    str_view v = {data, len};
+    return v;
+}
+
+// Makes a view of a NUL-terminated string; NULL gives an empty view
+str_view sv_from_cstr(const char *s) {
+    return sv_make(s ? s : "", s ? strlen(s) : 0);
+}
+
+// Returns the sub-view [pos, pos + len), clamped to the bounds of v
+str_view sv_substr(str_view v, size_t pos, size_t len) {
+    if (pos > v.len) pos = v.len;
+    if (len > v.len - pos) len = v.len - pos;
+    return sv_make(v.data + pos, len);
+}
+
+// Returns 1 if both views hold the same bytes, 0 otherwise
+int sv_equal(str_view a, str_view b) {
+    return a.len == b.len && (a.len == 0 || memcmp(a.data, b.data, a.len) == 0);
+}
+
+// Compares bytewise like str_compare; a proper prefix sorts first
+int sv_compare(str_view a, str_view b) {
+    size_t n = a.len < b.len ? a.len : b.len;
+    int r = n ? memcmp(a.data, b.data, n) : 0;
+    if (r != 0) return r;
+    return (a.len > b.len) - (a.len < b.len);
+}
+
+// Returns the index of the first c in v, or SV_NPOS
+size_t sv_find(str_view v, char c) {
+    const char *p = v.len ? memchr(v.data, c, v.len) : NULL;
+    return p ? (size_t)(p - v.data) : SV_NPOS;
+}
+
+// Returns the index of the last c in v, or SV_NPOS
+size_t sv_rfind(str_view v, char c) {
+    for (size_t i = v.len; i > 0; i--) {
+        if (v.data[i - 1] == c) return i - 1;
+    }
+    return SV_NPOS;
+}
+
+// Internal helper: ASCII-only lowercase, independent of the locale
+static inline unsigned char sv_fold(unsigned char c) {
+    return (unsigned char)ascii_to_lower((char)c);
+}
+
+// Internal helper: ASCII case-insensitive equality of n bytes
+static int sv_equal_nocase(const char *a, const char *b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (sv_fold((unsigned char)a[i]) != sv_fold((unsigned char)b[i])) return 0;
+    }
+    return 1;
+}
+
+// Internal helper: checks the candidate at hay + i; the first and last needle
+// bytes have already matched
+static inline int sv_verify(const char *hay, size_t i, str_view needle, int nocase) {
+    if (needle.len <= 2) return 1;
+    if (nocase) return sv_equal_nocase(hay + i + 1, needle.data + 1, needle.len - 2);
+    return memcmp(hay + i + 1, needle.data + 1, needle.len - 2) == 0;
+}
+
+// Substring search with a first/last byte filter: a block of positions is
+// kept only where both the byte at i and the byte at i + len - 1 match the
+// needle's ends, so the full compare runs on very few candidates. With SIMD
+// the filter tests 16 or 32 positions per step. For nocase the ends are
+// compared against both ASCII cases.
+static size_t sv_search(str_view v, str_view needle, int nocase) {
+    if (needle.len == 0) return 0;
+    if (needle.len > v.len) return SV_NPOS;
+    const char *hay = v.data;
+    size_t n = needle.len;
+    size_t last = v.len - n;
+    unsigned char f = (unsigned char)needle.data[0], l = (unsigned char)needle.data[n - 1];
+    unsigned char fl = nocase ? sv_fold(f) : f, ll = nocase ? sv_fold(l) : l;
+    unsigned char fu = (unsigned char)(fl - 'a') < 26 && nocase ? fl - 32 : fl;
+    unsigned char lu = (unsigned char)(ll - 'a') < 26 && nocase ? ll - 32 : ll;
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i vfl = _mm256_set1_epi8((char)fl), vfu = _mm256_set1_epi8((char)fu);
+    const __m256i vll = _mm256_set1_epi8((char)ll), vlu = _mm256_set1_epi8((char)lu);
+    for (; i + 32 <= last + 1; i += 32) {
+        __m256i bf = _mm256_loadu_si256((const __m256i *)(hay + i));
+        __m256i bl = _mm256_loadu_si256((const __m256i *)(hay + i + n - 1));
+        __m256i ef = _mm256_or_si256(_mm256_cmpeq_epi8(bf, vfl), _mm256_cmpeq_epi8(bf, vfu));
+        __m256i el = _mm256_or_si256(_mm256_cmpeq_epi8(bl, vll), _mm256_cmpeq_epi8(bl, vlu));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_and_si256(ef, el));
+        while (mask) {
+            size_t j = i + (size_t)__builtin_ctz(mask);
+            if (sv_verify(hay, j, needle, nocase)) return j;
+            mask &= mask - 1;
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128i vfl = _mm_set1_epi8((char)fl), vfu = _mm_set1_epi8((char)fu);
+    const __m128i vll = _mm_set1_epi8((char)ll), vlu = _mm_set1_epi8((char)lu);
+    for (; i + 16 <= last + 1; i += 16) {
+        __m128i bf = _mm_loadu_si128((const __m128i *)(hay + i));
+        __m128i bl = _mm_loadu_si128((const __m128i *)(hay + i + n - 1));
+        __m128i ef = _mm_or_si128(_mm_cmpeq_epi8(bf, vfl), _mm_cmpeq_epi8(bf, vfu));
+        __m128i el = _mm_or_si128(_mm_cmpeq_epi8(bl, vll), _mm_cmpeq_epi8(bl, vlu));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(ef, el));
+        while (mask) {
+            size_t j = i + (size_t)__builtin_ctz(mask);
+            if (sv_verify(hay, j, needle, nocase)) return j;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i <= last; i++) {
+        unsigned char a = (unsigned char)hay[i], b = (unsigned char)hay[i + n - 1];
+        if ((a == fl || a == fu) && (b == ll || b == lu) && sv_verify(hay, i, needle, nocase)) {
+            return i;
+        }
+    }
+    return SV_NPOS;
+}
+
+// Returns the index of the first occurrence of needle in v, or SV_NPOS
+size_t sv_find_view(str_view v, str_view needle) {
+    return sv_search(v, needle, 0);
+}
+
+// Returns the index of the first ASCII case-insensitive match, or SV_NPOS
+size_t sv_find_view_nocase(str_view v, str_view needle) {
+    return sv_search(v, needle, 1);
+}
+
+// Finds the first occurrence of needle in s, returns pointer or NULL
+char *str_find_str(const char *s, const char *needle) {
+    size_t i = sv_search(sv_from_cstr(s), sv_from_cstr(needle), 0);
+    return i == SV_NPOS ? NULL : (char *)s + i;
+}
+
+// Finds the first ASCII case-insensitive match of needle in s, or NULL
+char *str_find_str_nocase(const char *s, const char *needle) {
+    size_t i = sv_search(sv_from_cstr(s), sv_from_cstr(needle), 1);
+    return i == SV_NPOS ? NULL : (char *)s + i;
+}
+
+// Counts occurrences of c in v
+size_t sv_count_char(str_view v, char c) {
+    size_t count = 0;
+    for (size_t i = 0; i < v.len; i++) count += v.data[i] == c;
+    return count;
+}
+
+// Returns 1 if v starts with prefix, 0 otherwise
+int sv_starts_with(str_view v, str_view prefix) {
+    return prefix.len <= v.len && sv_equal(sv_make(v.data, prefix.len), prefix);
+}
+
+// Returns 1 if v ends with suffix, 0 otherwise
+int sv_ends_with(str_view v, str_view suffix) {
+    return suffix.len <= v.len &&
+           sv_equal(sv_make(v.data + v.len - suffix.len, suffix.len), suffix);
+}
+
+// Returns v without leading whitespace
+str_view sv_lstrip(str_view v) {
+    while (v.len && ascii_is_space(*v.data)) {
+        v.data++;
+        v.len--;
+    }
+    return v;
+}
+
+// Returns v without trailing whitespace
+str_view sv_rstrip(str_view v) {
+    while (v.len && ascii_is_space(v.data[v.len - 1])) v.len--;
+    return v;
+}
+
+// Returns v without leading and trailing whitespace
+str_view sv_strip(str_view v) {
+    return sv_rstrip(sv_lstrip(v));
+}
+
+// Pops the next delim-separated field off *rest; a trailing delimiter yields
+// a final empty field, matching how split behaves on "a,b,"
+int sv_split(str_view *rest, char delim, str_view *field) {
+    if (!rest->data) return 0;
+    size_t i = sv_find(*rest, delim);
+    if (i == SV_NPOS) {
+        *field = *rest;
+        rest->data = NULL;
+        rest->len = 0;
+        return 1;
+    }
+    *field = sv_make(rest->data, i);
+    rest->data += i + 1;
+    rest->len -= i + 1;
+    return 1;
+}
+
+// Returns a NUL-terminated copy of v allocated from arena a, or NULL
+char *sv_dup_arena(arena *a, str_view v) {
+    char *copy = arena_alloc_aligned(a, v.len + 1, 1);
+    if (!copy) return NULL;
+    if (v.len) memcpy(copy, v.data, v.len);
+    copy[v.len] = '\0';
+    return copy;
+}
+
+// Copies v into buf as a NUL-terminated string, returns buf
+char *sv_to_cstr(str_view v, char *buf, size_t buflen) {
+    if (buflen == 0) return buf;
+    size_t n = v.len < buflen - 1 ? v.len : buflen - 1;
+    if (n) memcpy(buf, v.data, n);
+    buf[n] = '\0';
+    return buf;
+}
+
+// Initializes an empty builder backed by its inline buffer
+void sb_init(str_builder *sb) {
+    sb->data = sb->inline_buf;
+    sb->len = 0;
+    sb->cap = STR_BUILDER_INLINE;
+    sb->arena = NULL;
+    sb->inline_buf[0] = '\0';
+}
+
+// Initializes an empty builder that grows inside arena a
+void sb_init_arena(str_builder *sb, arena *a) {
+    sb_init(sb);
+    sb->arena = a;
+}
+
+// Releases the heap buffer, if any, and leaves the builder empty
+void sb_free(str_builder *sb) {
+    arena *a = sb->arena;
+    if (!a && sb->data != sb->inline_buf) free(sb->data);
+    sb_init(sb);
+    sb->arena = a;
+}
+
+// Empties the builder but keeps its capacity
+void sb_clear(str_builder *sb) {
+    sb->len = 0;
+    sb->data[0] = '\0';
+}
+
+// Ensures room for extra bytes plus the terminator, doubling the capacity
+int sb_reserve(str_builder *sb, size_t extra) {
+    if (extra >= (size_t)-1 - sb->len) return -1;
+    size_t need = sb->len + extra + 1;
+    if (need <= sb->cap) return 0;
+    size_t cap = sb->cap * 2;
+    if (cap < need) cap = need;
+    char *data;
+    if (sb->arena) {
+        int spilled = sb->data != sb->inline_buf;
+        data = arena_realloc(sb->arena, spilled ? sb->data : NULL, spilled ? sb->cap : 0, cap);
+        if (!data) return -1;
+        if (!spilled) memcpy(data, sb->inline_buf, sb->len + 1);
+    } else if (sb->data == sb->inline_buf) {
+        data = malloc(cap);
+        if (!data) return -1;
+        memcpy(data, sb->inline_buf, sb->len + 1);
+    } else {
+        data = realloc(sb->data, cap);
+        if (!data) return -1;
+    }
+    sb->data = data;
+    sb->cap = cap;
+    return 0;
+}
+
+// Appends n bytes from data
+int sb_append_n(str_builder *sb, const char *data, size_t n) {
+    if (sb_reserve(sb, n) < 0) return -1;
+    if (n) memcpy(sb->data + sb->len, data, n);
+    sb->len += n;
+    sb->data[sb->len] = '\0';
+    return 0;
+}
+
+// Appends a NUL-terminated string
+int sb_append(str_builder *sb, const char *s) {
+    return sb_append_n(sb, s, strlen(s));
+}
+
+// Appends the bytes of a view
+int sb_append_view(str_builder *sb, str_view v) {
+    return sb_append_n(sb, v.data, v.len);
+}
+
+// Appends a single character
+int sb_append_char(str_builder *sb, char c) {
+    if (sb->len + 1 < sb->cap) {
+        sb->data[sb->len++] = c;
+        sb->data[sb->len] = '\0';
+        return 0;
+    }
+    return sb_append_n(sb, &c, 1);
+}
+
+// Appends c repeated n times
+int sb_append_repeat(str_builder *sb, char c, size_t n) {
+    if (sb_reserve(sb, n) < 0) return -1;
+    memset(sb->data + sb->len, c, n);
+    sb->len += n;
+    sb->data[sb->len] = '\0';
+    return 0;
+}
+
+// Appends the decimal form of an unsigned value
+int sb_append_uint(str_builder *sb, unsigned long long v) {
+    char buf[20];
+    char *p = buf + sizeof(buf);
+    do {
+        *--p = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    return sb_append_n(sb, p, (size_t)(buf + sizeof(buf) - p));
+}
+
+// Appends the decimal form of a signed value
+int sb_append_int(str_builder *sb, long long v) {
+    unsigned long long u = (unsigned long long)v;
+    if (v < 0) {
+        if (sb_append_char(sb, '-') < 0) return -1;
+        u = 0 - u;
+    }
+    return sb_append_uint(sb, u);
+}
+
+// Appends v right-aligned in width columns of pad
+int sb_append_pad_left(str_builder *sb, str_view v, size_t width, char pad) {
+    size_t fill = v.len < width ? width - v.len : 0;
+    if (sb_reserve(sb, fill + v.len) < 0) return -1;
+    sb_append_repeat(sb, pad, fill);
+    return sb_append_view(sb, v);
+}
+
+// Appends v left-aligned in width columns of pad
+int sb_append_pad_right(str_builder *sb, str_view v, size_t width, char pad) {
+    size_t fill = v.len < width ? width - v.len : 0;
+    if (sb_reserve(sb, fill + v.len) < 0) return -1;
+    sb_append_view(sb, v);
+    return sb_append_repeat(sb, pad, fill);
+}
+
+// Returns the contents as a NUL-terminated string
+const char *sb_cstr(const str_builder *sb) {
+    return sb->data;
+}
+
+// Returns the contents as a view
+str_view sb_view(const str_builder *sb) {
+    return sv_make(sb->data, sb->len);
+}
+
+// Hands the buffer to the caller; only inline contents need a copy
+char *sb_detach(str_builder *sb, size_t *len) {
+    arena *a = sb->arena;
+    char *out;
+    if (a && sb->data == sb->inline_buf) {
+        out = sv_dup_arena(a, sb_view(sb));
+        if (!out) return NULL;
+    } else if (sb->data == sb->inline_buf) {
+        out = malloc(sb->len + 1);
+        if (!out) return NULL;
+        memcpy(out, sb->inline_buf, sb->len + 1);
+    } else if (a) {
+        // Give back the unused tail when the buffer is the arena's newest block
+        out = arena_realloc(a, sb->data, sb->cap, sb->len + 1);
+    } else {
+        out = sb->data;
+    }
+    if (len) *len = sb->len;
+    sb_init(sb);
+    sb->arena = a;
+    return out;
+}
+
+// Compiles the delimiter characters into a bitmap and nibble tables. A byte
+// b is in the set when lo_nibble[b & 15] & hi_nibble[b >> 4] is nonzero:
+// hi_nibble gives each high nibble 0-7 its own bit and lo_nibble records
+// which high nibbles pair with each low nibble.
+void str_delims_init(str_delims *d, const char *chars) {
+    memset(d, 0, sizeof(*d));
+    d->simd_ok = 1;
+    for (int h = 0; h < 8; h++) d->hi_nibble[h] = (unsigned char)(1 << h);
+    for (const unsigned char *p = (const unsigned char *)chars; *p; p++) {
+        d->bits[*p >> 6] |= 1ULL << (*p & 63);
+        if (*p >= 0x80) d->simd_ok = 0;
+        else d->lo_nibble[*p & 15] |= (unsigned char)(1 << (*p >> 4));
+    }
+}
+
+// Internal helper: 1 if byte c is in the set
+static inline int str_delims_has(const str_delims *d, unsigned char c) {
+    return (d->bits[c >> 6] >> (c & 63)) & 1;
+}
+
+#if defined(__AVX2__)
+// Internal helper: bitmask of the delimiter bytes among p[0..31]
+static inline uint32_t str_delims_block(const str_delims *d, const char *p) {
+    __m256i lo_t = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)d->lo_nibble));
+    __m256i hi_t = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)d->hi_nibble));
+    __m256i v = _mm256_loadu_si256((const __m256i *)p);
+    __m256i nib = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_shuffle_epi8(lo_t, _mm256_and_si256(v, nib));
+    __m256i hi = _mm256_shuffle_epi8(hi_t, _mm256_and_si256(_mm256_srli_epi16(v, 4), nib));
+    __m256i miss = _mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), _mm256_setzero_si256());
+    return ~(uint32_t)_mm256_movemask_epi8(miss);
+}
+#define STR_DELIMS_BLOCK 32
+#elif defined(__SSSE3__)
+// Internal helper: bitmask of the delimiter bytes among p[0..15]
+static inline uint32_t str_delims_block(const str_delims *d, const char *p) {
+    __m128i lo_t = _mm_loadu_si128((const __m128i *)d->lo_nibble);
+    __m128i hi_t = _mm_loadu_si128((const __m128i *)d->hi_nibble);
+    __m128i v = _mm_loadu_si128((const __m128i *)p);
+    __m128i nib = _mm_set1_epi8(0x0f);
+    __m128i lo = _mm_shuffle_epi8(lo_t, _mm_and_si128(v, nib));
+    __m128i hi = _mm_shuffle_epi8(hi_t, _mm_and_si128(_mm_srli_epi16(v, 4), nib));
+    __m128i miss = _mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128());
+    return ~(uint32_t)_mm_movemask_epi8(miss) & 0xffffu;
+}
+#define STR_DELIMS_BLOCK 16
+#endif
+
+// Internal helper: index of the first byte whose membership equals want
+static size_t str_delims_scan(const str_delims *d, str_view v, int want) {
+    size_t i = 0;
+#ifdef STR_DELIMS_BLOCK
+    if (d->simd_ok) {
+        const uint32_t all = (uint32_t)((1ULL << STR_DELIMS_BLOCK) - 1);
+        for (; i + STR_DELIMS_BLOCK <= v.len; i += STR_DELIMS_BLOCK) {
+            uint32_t hits = str_delims_block(d, v.data + i);
+            if (!want) hits = ~hits & all;
+            if (hits) return i + (size_t)__builtin_ctz(hits);
+        }
+    }
+#endif
+    while (i < v.len && str_delims_has(d, (unsigned char)v.data[i]) != want) i++;
+    return i;
+}
+
+// Returns the index of the first delimiter in v, or v.len
+size_t str_delims_find(const str_delims *d, str_view v) {
+    return str_delims_scan(d, v, 1);
+}
+
+// Returns the index of the first non-delimiter in v, or v.len
+size_t str_delims_skip(const str_delims *d, str_view v) {
+    return str_delims_scan(d, v, 0);
+}
+
+// str_delims_init(" \t\n\v\f\r") spelled out, so the whitespace splitter
+// needs no setup
+static const str_delims str_ws_delims = {
+    {0x100003e00ULL, 0, 0, 0},
+    {4, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0, 0},
+    {1, 2, 4, 8, 16, 32, 64, 128, 0, 0, 0, 0, 0, 0, 0, 0},
+    1,
+};
+
+// Starts splitting v on any byte in d
+void str_split_init(str_splitter *it, str_view v, const str_delims *d, int flags) {
+    it->cur = v.data;
+    it->end = v.data + v.len;
+    it->delims = d;
+    it->flags = flags;
+    it->lines = 0;
+    it->done = 0;
+}
+
+// Starts splitting v into runs of non-whitespace
+void str_split_ws_init(str_splitter *it, str_view v) {
+    str_split_init(it, v, &str_ws_delims, STR_SPLIT_SKIP_EMPTY);
+}
+
+// Starts splitting v into lines
+void str_split_lines_init(str_splitter *it, str_view v) {
+    str_split_init(it, v, NULL, 0);
+    it->lines = 1;
+}
+
+// Internal helper: next line, found with memchr
+static int str_split_next_line(str_splitter *it, str_view *field) {
+    if (it->cur == it->end) return 0;
+    size_t rest = (size_t)(it->end - it->cur);
+    const char *nl = memchr(it->cur, '\n', rest);
+    const char *stop = nl ? nl : it->end;
+    size_t len = (size_t)(stop - it->cur);
+    if (len && stop[-1] == '\r' && nl) len--;
+    *field = sv_make(it->cur, len);
+    it->cur = nl ? nl + 1 : it->end;
+    return 1;
+}
+
+// Stores the next field in *field, returns 1, or returns 0 when done
+int str_split_next(str_splitter *it, str_view *field) {
+    if (it->lines) return str_split_next_line(it, field);
+    if (it->done) return 0;
+    if (it->flags & STR_SPLIT_SKIP_EMPTY) {
+        it->cur += str_delims_skip(it->delims, sv_make(it->cur, (size_t)(it->end - it->cur)));
+        if (it->cur == it->end) {
+            it->done = 1;
+            return 0;
+        }
+    }
+    str_view rest = sv_make(it->cur, (size_t)(it->end - it->cur));
+    size_t i = str_delims_find(it->delims, rest);
+    *field = sv_make(it->cur, i);
+    if (i == rest.len) {
+        it->done = 1;
+    } else {
+        it->cur += i + 1;
+    }
+    return 1;
+}
+
+// Base64 alphabets, as 64 characters for encoding and a byte -> value
+// table (-1 for characters outside the alphabet) for decoding
+static const char str_b64_std_chars[65] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const char str_b64_url_chars[65] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+static const signed char str_b64_std_values[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+    -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+    -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+static const signed char str_b64_url_values[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+    -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, 63,
+    -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+static const char str_hex_lower[17] = "0123456789abcdef";
+static const char str_hex_upper[17] = "0123456789ABCDEF";
+
+// Internal helper: scalar encoding of n / 3 whole groups
+static void str_b64_encode_groups(const unsigned char *s, size_t groups, char *d,
+                                  const char *chars) {
+    for (size_t i = 0; i < groups; i++, s += 3, d += 4) {
+        uint32_t v = (uint32_t)s[0] << 16 | (uint32_t)s[1] << 8 | s[2];
+        d[0] = chars[v >> 18];
+        d[1] = chars[(v >> 12) & 63];
+        d[2] = chars[(v >> 6) & 63];
+        d[3] = chars[v & 63];
+    }
+}
+
+#if defined(__AVX2__)
+// Internal helper: spreads each 3 input bytes (placed by the shuffle as
+// b1 b0 b2 b1 in a 32-bit lane) into four 6-bit indices, one per byte,
+// using Wojciech Mula's multiply-shift unpacking
+static inline __m256i str_b64_unpack256(__m256i in) {
+    __m256i ac = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)),
+                                    _mm256_set1_epi32(0x04000040));
+    __m256i bd = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)),
+                                    _mm256_set1_epi32(0x01000010));
+    return _mm256_or_si256(ac, bd);
+}
+
+// Internal helper: maps 32 indices (0..63) to characters. Indices are
+// bucketed (0..25, 26..51, 52..61, 62, 63) and a 16-entry table gives the
+// offset to add for each bucket.
+static inline __m256i str_b64_chars256(__m256i idx, int url) {
+    __m256i bucket = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+    __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx);
+    bucket = _mm256_or_si256(bucket, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+    char c62 = url ? '-' : '+', c63 = url ? '_' : '/';
+    __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                    (char)(c62 - 62), (char)(c63 - 63), 'A', 0, 0);
+    __m256i lut = _mm256_broadcastsi128_si256(offsets);
+    return _mm256_add_epi8(idx, _mm256_shuffle_epi8(lut, bucket));
+}
+#elif defined(__SSSE3__)
+// Internal helper: spreads 3 bytes per 32-bit lane into four indices, as above
+static inline __m128i str_b64_unpack128(__m128i in) {
+    __m128i ac = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)),
+                                 _mm_set1_epi32(0x04000040));
+    __m128i bd = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)),
+                                 _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(ac, bd);
+}
+
+// Internal helper: maps 16 indices (0..63) to characters, as above
+static inline __m128i str_b64_chars128(__m128i idx, int url) {
+    __m128i bucket = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+    __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), idx);
+    bucket = _mm_or_si128(bucket, _mm_and_si128(upper, _mm_set1_epi8(13)));
+    char c62 = url ? '-' : '+', c63 = url ? '_' : '/';
+    __m128i lut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                (char)(c62 - 62), (char)(c63 - 63), 'A', 0, 0);
+    return _mm_add_epi8(idx, _mm_shuffle_epi8(lut, bucket));
+}
+#endif
+
+// Internal helper: encodes whole 3-byte groups of s[0..n), returns the
+// number of input bytes consumed
+static size_t str_b64_encode_bulk(const unsigned char *s, size_t n, char *d, int flags) {
+    size_t i = 0;
+    int url = flags & STR_BASE64_URL;
+#if defined(__AVX2__)
+    // 24 bytes -> 32 characters; the two 12-byte halves are loaded into the
+    // lanes at the offsets the shuffle expects, reading 28 bytes
+    const __m256i shuf = _mm256_setr_epi8(5, 4, 6, 5, 8, 7, 9, 8, 11, 10, 12, 11, 14, 13, 15, 14,
+                                          1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    for (; i + 28 <= n; i += 24) {
+        __m128i lo = _mm_slli_si128(_mm_loadu_si128((const __m128i *)(s + i)), 4);
+        __m128i hi = _mm_loadu_si128((const __m128i *)(s + i + 12));
+        __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        in = _mm256_shuffle_epi8(in, shuf);
+        _mm256_storeu_si256((__m256i *)(d + i / 3 * 4), str_b64_chars256(str_b64_unpack256(in), url));
+    }
+#elif defined(__SSSE3__)
+    // 12 bytes -> 16 characters, reading 16
+    const __m128i shuf = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    for (; i + 16 <= n; i += 12) {
+        __m128i in = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(s + i)), shuf);
+        _mm_storeu_si128((__m128i *)(d + i / 3 * 4), str_b64_chars128(str_b64_unpack128(in), url));
+    }
+#endif
+    size_t groups = (n - i) / 3;
+    str_b64_encode_groups(s + i, groups, d + i / 3 * 4, url ? str_b64_url_chars : str_b64_std_chars);
+    return i + groups * 3;
+}
+
+// Internal helper: encodes the last 1 or 2 bytes, returns the characters written
+static size_t str_b64_encode_tail(const unsigned char *s, size_t n, char *d, int flags) {
+    const char *chars = flags & STR_BASE64_URL ? str_b64_url_chars : str_b64_std_chars;
+    uint32_t v = (uint32_t)s[0] << 16 | (n > 1 ? (uint32_t)s[1] << 8 : 0);
+    d[0] = chars[v >> 18];
+    d[1] = chars[(v >> 12) & 63];
+    size_t len = 2;
+    if (n > 1) d[len++] = chars[(v >> 6) & 63];
+    if (!(flags & STR_BASE64_NOPAD)) {
+        while (len < 4) d[len++] = '=';
+    }
+    return len;
+}
+
+// Returns the length of the base64 encoding of n bytes
+size_t str_base64_encoded_len(size_t n, int flags) {
+    if (flags & STR_BASE64_NOPAD) return n / 3 * 4 + (n % 3 ? n % 3 + 1 : 0);
+    return (n + 2) / 3 * 4;
+}
+
+// Returns the most bytes n base64 characters can decode to
+size_t str_base64_decoded_max(size_t n) {
+    return n / 4 * 3 + (n % 4 > 1 ? n % 4 - 1 : 0);
+}
+
+// Encodes n bytes from src as base64 into dst
+size_t str_base64_encode(const void *src, size_t n, char *dst, int flags) {
+    const unsigned char *s = src;
+    size_t used = str_b64_encode_bulk(s, n, dst, flags);
+    size_t len = used / 3 * 4;
+    if (used < n) len += str_b64_encode_tail(s + used, n - used, dst + len, flags);
+    return len;
+}
+
+#if defined(__AVX2__)
+// Internal helper: translates 32 characters to 6-bit values; sets *bad if
+// any is outside the alphabet. Bytes >= 0x80 are negative and fail every
+// range check.
+static inline __m256i str_b64_values256(__m256i c, char c62, char c63, int *bad) {
+    __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('A' - 1)),
+                                     _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), c));
+    __m256i lower = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('a' - 1)),
+                                     _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), c));
+    __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)),
+                                     _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+    __m256i s62 = _mm256_cmpeq_epi8(c, _mm256_set1_epi8(c62));
+    __m256i s63 = _mm256_cmpeq_epi8(c, _mm256_set1_epi8(c63));
+    __m256i valid = _mm256_or_si256(_mm256_or_si256(upper, lower),
+                                    _mm256_or_si256(digit, _mm256_or_si256(s62, s63)));
+    *bad = _mm256_movemask_epi8(valid) != -1;
+    __m256i off = _mm256_or_si256(
+        _mm256_or_si256(_mm256_and_si256(upper, _mm256_set1_epi8(-65)),
+                        _mm256_and_si256(lower, _mm256_set1_epi8(-71))),
+        _mm256_or_si256(_mm256_and_si256(digit, _mm256_set1_epi8(4)),
+                        _mm256_or_si256(_mm256_and_si256(s62, _mm256_set1_epi8((char)(62 - c62))),
+                                        _mm256_and_si256(s63, _mm256_set1_epi8((char)(63 - c63))))));
+    return _mm256_add_epi8(c, off);
+}
+#elif defined(__SSSE3__)
+// Internal helper: translates 16 characters to 6-bit values, as above
+static inline __m128i str_b64_values128(__m128i c, char c62, char c63, int *bad) {
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('A' - 1)),
+                                  _mm_cmplt_epi8(c, _mm_set1_epi8('Z' + 1)));
+    __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('a' - 1)),
+                                  _mm_cmplt_epi8(c, _mm_set1_epi8('z' + 1)));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                                  _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+    __m128i s62 = _mm_cmpeq_epi8(c, _mm_set1_epi8(c62));
+    __m128i s63 = _mm_cmpeq_epi8(c, _mm_set1_epi8(c63));
+    __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower),
+                                 _mm_or_si128(digit, _mm_or_si128(s62, s63)));
+    *bad = _mm_movemask_epi8(valid) != 0xffff;
+    __m128i off = _mm_or_si128(
+        _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-65)),
+                     _mm_and_si128(lower, _mm_set1_epi8(-71))),
+        _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(4)),
+                     _mm_or_si128(_mm_and_si128(s62, _mm_set1_epi8((char)(62 - c62))),
+                                  _mm_and_si128(s63, _mm_set1_epi8((char)(63 - c63))))));
+    return _mm_add_epi8(c, off);
+}
+#endif
+
+// Internal helper: decodes n characters (a multiple of 4, no padding) into
+// n / 4 * 3 bytes, returns 0 or -1 on a character outside the alphabet
+static int str_b64_decode_groups(const char *s, size_t n, unsigned char *d, int flags) {
+    const signed char *values = flags & STR_BASE64_URL ? str_b64_url_values : str_b64_std_values;
+    size_t i = 0;
+#if defined(__AVX2__) || defined(__SSSE3__)
+    char c62 = flags & STR_BASE64_URL ? '-' : '+';
+    char c63 = flags & STR_BASE64_URL ? '_' : '/';
+#endif
+#if defined(__AVX2__)
+    // 32 characters -> 24 bytes. Each store writes 32 bytes, so keep at
+    // least 12 more characters (9 bytes of output) behind the block.
+    for (; i + 44 <= n; i += 32) {
+        int bad;
+        __m256i v = str_b64_values256(_mm256_loadu_si256((const __m256i *)(s + i)), c62, c63, &bad);
+        if (bad) return -1;
+        // Merge value pairs into 12-bit fields, then pairs of those into 24 bits
+        v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+        v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+        v = _mm256_shuffle_epi8(v, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                    2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+        _mm256_storeu_si256((__m256i *)(d + i / 4 * 3), v);
+    }
+#elif defined(__SSSE3__)
+    // 16 characters -> 12 bytes, storing 16; keep 8 characters behind
+    for (; i + 24 <= n; i += 16) {
+        int bad;
+        __m128i v = str_b64_values128(_mm_loadu_si128((const __m128i *)(s + i)), c62, c63, &bad);
+        if (bad) return -1;
+        v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+        v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+        v = _mm_shuffle_epi8(v, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        _mm_storeu_si128((__m128i *)(d + i / 4 * 3), v);
+    }
+#endif
+    for (; i < n; i += 4) {
+        const unsigned char *q = (const unsigned char *)s + i;
+        int a = values[q[0]], b = values[q[1]], c = values[q[2]], e = values[q[3]];
+        if ((a | b | c | e) < 0) return -1;
+        uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6 | (uint32_t)e;
+        unsigned char *o = d + i / 4 * 3;
+        o[0] = (unsigned char)(v >> 16);
+        o[1] = (unsigned char)(v >> 8);
+        o[2] = (unsigned char)v;
+    }
+    return 0;
+}
+
+// Internal helper: decodes the final group of 2-4 characters, which may be
+// padded (or partial with STR_BASE64_NOPAD). Returns the byte count or -1.
+static int str_b64_decode_last(const char *s, size_t n, unsigned char *d, int flags) {
+    const signed char *values = flags & STR_BASE64_URL ? str_b64_url_values : str_b64_std_values;
+    const unsigned char *q = (const unsigned char *)s;
+    size_t len = n;
+    if (!(flags & STR_BASE64_NOPAD)) {
+        if (n != 4) return -1;
+        if (q[3] == '=') len = q[2] == '=' ? 2 : 3;
+    }
+    if (len < 2) return -1;
+    uint32_t v = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (values[q[i]] < 0) return -1;
+        v |= (uint32_t)values[q[i]] << (18 - 6 * i);
+    }
+    // The bits past the last whole byte must be zero (canonical encoding)
+    if (len == 2 && (v & 0xffff)) return -1;
+    if (len == 3 && (v & 0xff)) return -1;
+    d[0] = (unsigned char)(v >> 16);
+    if (len > 2) d[1] = (unsigned char)(v >> 8);
+    if (len > 3) d[2] = (unsigned char)v;
+    return (int)len - 1;
+}
+
+// Decodes n base64 characters into dst
+int str_base64_decode(const char *src, size_t n, void *dst, size_t *out_len, int flags) {
+    unsigned char *d = dst;
+    *out_len = 0;
+    if (n == 0) return 0;
+    size_t last = n % 4 ? n % 4 : 4;
+    if (!(flags & STR_BASE64_NOPAD) && last != 4) return -1;
+    if (str_b64_decode_groups(src, n - last, d, flags) != 0) return -1;
+    int tail = str_b64_decode_last(src + n - last, last, d + (n - last) / 4 * 3, flags);
+    if (tail < 0) return -1;
+    *out_len = (n - last) / 4 * 3 + (size_t)tail;
+    return 0;
+}
+
+// Starts an incremental base64 encoding
+void str_base64_encoder_init(str_base64_encoder *e, int flags) {
+    e->npending = 0;
+    e->flags = flags;
+}
+
+// Encodes the next n bytes
+size_t str_base64_encode_update(str_base64_encoder *e, const void *src, size_t n, char *dst) {
+    const unsigned char *s = src;
+    size_t len = 0;
+    if (e->npending) {
+        while (e->npending < 3 && n > 0) {
+            e->pending[e->npending++] = *s++;
+            n--;
+        }
+        if (e->npending < 3) return 0;
+        len = str_b64_encode_bulk(e->pending, 3, dst, e->flags) / 3 * 4;
+        e->npending = 0;
+    }
+    size_t used = str_b64_encode_bulk(s, n, dst + len, e->flags);
+    len += used / 3 * 4;
+    for (size_t i = used; i < n; i++) e->pending[e->npending++] = s[i];
+    return len;
+}
+
+// Flushes the last partial group
+size_t str_base64_encode_finish(str_base64_encoder *e, char *dst) {
+    size_t len = e->npending ? str_b64_encode_tail(e->pending, (size_t)e->npending, dst, e->flags) : 0;
+    e->npending = 0;
+    return len;
+}
+
+// Starts an incremental base64 decoding
+void str_base64_decoder_init(str_base64_decoder *d, int flags) {
+    d->npending = 0;
+    d->flags = flags;
+    d->done = 0;
+    d->failed = 0;
+}
+
+// Internal helper: decodes one whole group of the stream; a padded group
+// must be the last one
+static int str_b64_stream_group(str_base64_decoder *d, const char *g, unsigned char *o) {
+    if (g[3] == '=' && !(d->flags & STR_BASE64_NOPAD)) {
+        d->done = 1;
+        return str_b64_decode_last(g, 4, o, d->flags);
+    }
+    return str_b64_decode_groups(g, 4, o, d->flags) == 0 ? 3 : -1;
+}
+
+// Decodes the next n characters
+int str_base64_decode_update(str_base64_decoder *d, const char *src, size_t n,
+                             void *dst, size_t *out_len) {
+    unsigned char *o = dst;
+    size_t len = 0;
+    *out_len = 0;
+    if (d->failed || (d->done && n > 0)) goto fail;
+    if (d->npending) {
+        while (d->npending < 4 && n > 0) {
+            d->pending[d->npending++] = *src++;
+            n--;
+        }
+        if (d->npending < 4) return 0;
+        int r = str_b64_stream_group(d, d->pending, o);
+        if (r < 0 || (d->done && n > 0)) goto fail;
+        len = (size_t)r;
+        d->npending = 0;
+    }
+    size_t whole = n / 4 * 4;
+    if (whole) {
+        // All but the last group cannot be padded
+        if (str_b64_decode_groups(src, whole - 4, o + len, d->flags) != 0) goto fail;
+        len += (whole - 4) / 4 * 3;
+        int r = str_b64_stream_group(d, src + whole - 4, o + len);
+        if (r < 0 || (d->done && whole < n)) goto fail;
+        len += (size_t)r;
+    }
+    for (size_t i = whole; i < n; i++) d->pending[d->npending++] = src[i];
+    *out_len = len;
+    return 0;
+fail:
+    d->failed = 1;
+    return -1;
+}
+
+// Decodes a trailing unpadded group and checks the input ended cleanly
+int str_base64_decode_finish(str_base64_decoder *d, void *dst, size_t *out_len) {
+    *out_len = 0;
+    if (d->failed) return -1;
+    if (d->npending == 0) return 0;
+    int r = (d->flags & STR_BASE64_NOPAD)
+                ? str_b64_decode_last(d->pending, (size_t)d->npending, dst, d->flags)
+                : -1;
+    d->npending = 0;
+    if (r < 0) {
+        d->failed = 1;
+        return -1;
+    }
+    *out_len = (size_t)r;
+    return 0;
+}
+
+// Encodes n bytes from src as 2 * n hex digits in dst
+size_t str_hex_encode(const void *src, size_t n, char *dst, int flags) {
+    const unsigned char *s = src;
+    const char *digits = flags & STR_HEX_UPPER ? str_hex_upper : str_hex_lower;
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)digits));
+    const __m256i nib = _mm256_set1_epi8(0x0f);
+    for (; i + 32 <= n; i += 32) {
+        __m256i in = _mm256_loadu_si256((const __m256i *)(s + i));
+        __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(in, 4), nib));
+        __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(in, nib));
+        // unpack works within lanes: bytes 0-7 | 16-23 and 8-15 | 24-31
+        __m256i a = _mm256_unpacklo_epi8(hi, lo);
+        __m256i b = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256((__m256i *)(dst + 2 * i), _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst + 2 * i + 32), _mm256_permute2x128_si256(a, b, 0x31));
+    }
+#elif defined(__SSSE3__)
+    const __m128i lut = _mm_loadu_si128((const __m128i *)digits);
+    const __m128i nib = _mm_set1_epi8(0x0f);
+    for (; i + 16 <= n; i += 16) {
+        __m128i in = _mm_loadu_si128((const __m128i *)(s + i));
+        __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(in, 4), nib));
+        __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(in, nib));
+        _mm_storeu_si128((__m128i *)(dst + 2 * i), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i *)(dst + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[2 * i] = digits[s[i] >> 4];
+        dst[2 * i + 1] = digits[s[i] & 15];
+    }
+    return 2 * n;
+}
+
+// Internal helper: value of a hex digit, or -1. Letters have bit 6 set and
+// their low nibble counts from 1, so adding 9 maps them to 10..15.
+static inline int str_hex_value(char c) {
+    if (!ascii_is_xdigit(c)) return -1;
+    return (c & 15) + 9 * ((c >> 6) & 1);
+}
+
+// Internal helper: decodes n / 2 byte pairs (n even), returns 0 or -1
+static int str_hex_decode_pairs(const char *s, size_t n, unsigned char *d) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    // Digits are c - '0' <= 9, letters (c | 0x20) - 'a' <= 5; maddubs then
+    // combines each pair as hi * 16 + lo
+    for (; i + 64 <= n; i += 64) {
+        __m256i out[2];
+        for (int h = 0; h < 2; h++) {
+            __m256i c = _mm256_loadu_si256((const __m256i *)(s + i + 32 * h));
+            __m256i dig = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+            __m256i let = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+            __m256i is_dig = _mm256_cmpeq_epi8(_mm256_min_epu8(dig, _mm256_set1_epi8(9)), dig);
+            __m256i is_let = _mm256_cmpeq_epi8(_mm256_min_epu8(let, _mm256_set1_epi8(5)), let);
+            if (_mm256_movemask_epi8(_mm256_or_si256(is_dig, is_let)) != -1) return -1;
+            __m256i v = _mm256_blendv_epi8(_mm256_add_epi8(let, _mm256_set1_epi8(10)), dig, is_dig);
+            out[h] = _mm256_maddubs_epi16(v, _mm256_set1_epi16(0x0110));
+        }
+        // packus interleaves lanes; restore order with a 64-bit permute
+        __m256i packed = _mm256_packus_epi16(out[0], out[1]);
+        _mm256_storeu_si256((__m256i *)(d + i / 2), _mm256_permute4x64_epi64(packed, 0xd8));
+    }
+#elif defined(__SSSE3__)
+    for (; i + 32 <= n; i += 32) {
+        __m128i out[2];
+        for (int h = 0; h < 2; h++) {
+            __m128i c = _mm_loadu_si128((const __m128i *)(s + i + 16 * h));
+            __m128i dig = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+            __m128i let = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+            __m128i is_dig = _mm_cmpeq_epi8(_mm_min_epu8(dig, _mm_set1_epi8(9)), dig);
+            __m128i is_let = _mm_cmpeq_epi8(_mm_min_epu8(let, _mm_set1_epi8(5)), let);
+            if (_mm_movemask_epi8(_mm_or_si128(is_dig, is_let)) != 0xffff) return -1;
+            __m128i v = _mm_or_si128(_mm_and_si128(is_dig, dig),
+                                     _mm_andnot_si128(is_dig, _mm_add_epi8(let, _mm_set1_epi8(10))));
+            out[h] = _mm_maddubs_epi16(v, _mm_set1_epi16(0x0110));
+        }
+        _mm_storeu_si128((__m128i *)(d + i / 2), _mm_packus_epi16(out[0], out[1]));
+    }
+#endif
+    for (; i < n; i += 2) {
+        int hi = str_hex_value(s[i]), lo = str_hex_value(s[i + 1]);
+        if ((hi | lo) < 0) return -1;
+        d[i / 2] = (unsigned char)(hi << 4 | lo);
+    }
+    return 0;
+}
+
+// Decodes n hex digits (n even) into n / 2 bytes at dst
+int str_hex_decode(const char *src, size_t n, void *dst) {
+    if (n % 2) return -1;
+    return str_hex_decode_pairs(src, n, dst);
+}
+
+// Starts an incremental hex decoding
+void str_hex_decoder_init(str_hex_decoder *d) {
+    d->npending = 0;
+    d->failed = 0;
+}
+
+// Decodes the next n characters
+int str_hex_decode_update(str_hex_decoder *d, const char *src, size_t n,
+                          void *dst, size_t *out_len) {
+    unsigned char *o = dst;
+    size_t len = 0;
+    *out_len = 0;
+    if (d->failed) return -1;
+    if (d->npending && n > 0) {
+        char pair[2] = {d->pending, *src++};
+        n--;
+        d->npending = 0;
+        if (str_hex_decode_pairs(pair, 2, o) != 0) goto fail;
+        len = 1;
+    }
+    size_t whole = n & ~(size_t)1;
+    if (str_hex_decode_pairs(src, whole, o + len) != 0) goto fail;
+    len += whole / 2;
+    if (whole < n) {
+        d->pending = src[whole];
+        d->npending = 1;
+    }
+    *out_len = len;
+    return 0;
+fail:
+    d->failed = 1;
+    return -1;
+}
+
+// Checks no half byte is left over
+int str_hex_decode_finish(str_hex_decoder *d) {
+    int ok = !d->failed && d->npending == 0;
+    d->npending = 0;
+    return ok ? 0 : -1;
+}
@@ -1,6 +1,10 @@
 #ifndef STRING_UTILS_H
 #define STRING_UTILS_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include "arena_utils.h"
+
 // Returns the length of a string
 int str_length(const char *s);
 
@@ -19,12 +23,24 @@ char *str_find(const char *s, char c);
 // Finds the last occurrence of character c in string s
 char *str_rfind(const char *s, char c);
 
+// Finds the first occurrence of substring needle in s
+char *str_find_str(const char *s, const char *needle);
+
+// Finds the first occurrence of needle in s, ignoring ASCII case
+char *str_find_str_nocase(const char *s, const char *needle);
+
 // Converts a string to uppercase
 void str_to_upper(char *s);
 
 // Converts a string to lowercase
 void str_to_lower(char *s);
 
+// Converts a string to uppercase, ASCII letters only, ignoring the locale
+void str_to_upper_ascii(char *s);
+
+// Converts a string to lowercase, ASCII letters only, ignoring the locale
+void str_to_lower_ascii(char *s);
+
 // Checks if string s starts with the given prefix
 int str_starts_with(const char *s, const char *prefix);
 
@@ -42,6 +58,9 @@ int str_count_char(const char *s, char c);
 
 char *str_dup(const char *s);
 
+// Returns a copy of s allocated from arena a (freed with the arena), or NULL
+char *str_dup_arena(arena *a, const char *s);
+
 int str_is_empty(const char *s);
 
 void str_chomp(char *s);
@@ -52,4 +71,279 @@ char *str_pad_right(char *s, int total_len, char pad_char);
 
 char *str_repeat(char *s, char c, int n);
 
+// A non-owning view of len bytes starting at data; not NUL-terminated
+typedef struct {
+    const char *data;
+    size_t len;
+} str_view;
+
+// Returned by the view search functions when nothing is found
+#define SV_NPOS ((size_t)-1)
+
+// Builds a view from a string literal without scanning for the NUL
+#define SV_LIT(s) sv_make((s), sizeof(s) - 1)
+
+// Makes a view of len bytes at data
+str_view sv_make(const char *data, size_t len);
+
+// Makes a view of a NUL-terminated string (the only view call that scans)
+str_view sv_from_cstr(const char *s);
+
+// Returns the sub-view [pos, pos + len), clamped to the bounds of v
+str_view sv_substr(str_view v, size_t pos, size_t len);
+
+// Returns 1 if both views hold the same bytes, 0 otherwise
+int sv_equal(str_view a, str_view b);
+
+// Compares two views bytewise, returns 0 if equal, <0 if a<b, >0 if a>b
+int sv_compare(str_view a, str_view b);
+
+// Returns the index of the first c in v, or SV_NPOS
+size_t sv_find(str_view v, char c);
+
+// Returns the index of the last c in v, or SV_NPOS
+size_t sv_rfind(str_view v, char c);
+
+// Returns the index of the first occurrence of needle in v, or SV_NPOS
+size_t sv_find_view(str_view v, str_view needle);
+
+// Like sv_find_view, but ignores ASCII case
+size_t sv_find_view_nocase(str_view v, str_view needle);
+
+// Counts the number of occurrences of c in v
+size_t sv_count_char(str_view v, char c);
+
+// Returns 1 if v starts with prefix, 0 otherwise
+int sv_starts_with(str_view v, str_view prefix);
+
+// Returns 1 if v ends with suffix, 0 otherwise
+int sv_ends_with(str_view v, str_view suffix);
+
+// Returns v without leading whitespace
+str_view sv_lstrip(str_view v);
+
+// Returns v without trailing whitespace
+str_view sv_rstrip(str_view v);
+
+// Returns v without leading and trailing whitespace; never writes to the data
+str_view sv_strip(str_view v);
+
+// Splits off the text before the first delim into *field and advances *rest
+// past it; returns 1 while a field was produced, 0 once *rest is exhausted
+int sv_split(str_view *rest, char delim, str_view *field);
+
+// Returns a NUL-terminated copy of v allocated from arena a, or NULL
+char *sv_dup_arena(arena *a, str_view v);
+
+// Copies v into buf as a NUL-terminated string (truncating to buflen - 1),
+// returns buf
+char *sv_to_cstr(str_view v, char *buf, size_t buflen);
+
+// Bytes a str_builder holds before it first touches the heap
+#define STR_BUILDER_INLINE 64
+
+// A growable NUL-terminated string. Small strings live in inline_buf; larger
+// ones move to a heap buffer that grows geometrically. data points into the
+// struct while inline, so a builder must not be copied by value. When
+// arena is set, the heap buffer comes from that arena instead of malloc.
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+    arena *arena;
+    char inline_buf[STR_BUILDER_INLINE];
+} str_builder;
+
+// Initializes an empty builder
+void sb_init(str_builder *sb);
+
+// Initializes an empty builder that grows inside arena a
+void sb_init_arena(str_builder *sb, arena *a);
+
+// Releases the builder's heap buffer, if any, and leaves it empty (arena
+// memory is left to the arena)
+void sb_free(str_builder *sb);
+
+// Empties the builder but keeps its capacity
+void sb_clear(str_builder *sb);
+
+// Ensures room for extra more bytes, returns 0 on success, -1 on error
+int sb_reserve(str_builder *sb, size_t extra);
+
+// Appends n bytes from data, returns 0 on success, -1 on error
+int sb_append_n(str_builder *sb, const char *data, size_t n);
+
+// Appends a NUL-terminated string, returns 0 on success, -1 on error
+int sb_append(str_builder *sb, const char *s);
+
+// Appends the bytes of a view, returns 0 on success, -1 on error
+int sb_append_view(str_builder *sb, str_view v);
+
+// Appends a single character, returns 0 on success, -1 on error
+int sb_append_char(str_builder *sb, char c);
+
+// Appends c repeated n times, returns 0 on success, -1 on error
+int sb_append_repeat(str_builder *sb, char c, size_t n);
+
+// Appends the decimal form of v, returns 0 on success, -1 on error
+int sb_append_int(str_builder *sb, long long v);
+
+// Appends the decimal form of v, returns 0 on success, -1 on error
+int sb_append_uint(str_builder *sb, unsigned long long v);
+
+// Appends v right-aligned in width columns of pad, returns 0 or -1
+int sb_append_pad_left(str_builder *sb, str_view v, size_t width, char pad);
+
+// Appends v left-aligned in width columns of pad, returns 0 or -1
+int sb_append_pad_right(str_builder *sb, str_view v, size_t width, char pad);
+
+// Returns the contents as a NUL-terminated string owned by the builder
+const char *sb_cstr(const str_builder *sb);
+
+// Returns the contents as a view owned by the builder
+str_view sb_view(const str_builder *sb);
+
+// Hands the contents to the caller as a malloc'd string (no copy once the
+// builder has spilled to the heap) and resets the builder; stores the length
+// in *len if len is not NULL. Arena builders return arena memory that must
+// not be passed to free. Returns NULL on error.
+char *sb_detach(str_builder *sb, size_t *len);
+
+// A precompiled delimiter set: a 256-bit membership bitmap plus nibble
+// lookup tables so SIMD builds can test 16 or 32 bytes with two shuffles
+typedef struct {
+    uint64_t bits[4];
+    unsigned char lo_nibble[16];
+    unsigned char hi_nibble[16];
+    int simd_ok;            // 0 if the set holds bytes >= 0x80
+} str_delims;
+
+// str_splitter flag: drop empty fields instead of returning them
+#define STR_SPLIT_SKIP_EMPTY 1
+
+// Iterates over the fields of a buffer without copying or modifying it.
+// The fields returned are views into the original buffer.
+typedef struct {
+    const char *cur;
+    const char *end;
+    const str_delims *delims;
+    int flags;
+    int lines;
+    int done;
+} str_splitter;
+
+// Compiles the NUL-terminated list of delimiter characters in chars
+void str_delims_init(str_delims *d, const char *chars);
+
+// Returns the index of the first delimiter in v, or v.len if there is none
+size_t str_delims_find(const str_delims *d, str_view v);
+
+// Returns the index of the first non-delimiter in v, or v.len
+size_t str_delims_skip(const str_delims *d, str_view v);
+
+// Starts splitting v on any byte in d (which must outlive the splitter);
+// flags is 0 or STR_SPLIT_SKIP_EMPTY
+void str_split_init(str_splitter *it, str_view v, const str_delims *d, int flags);
+
+// Starts splitting v into runs of non-whitespace (is_space semantics)
+void str_split_ws_init(str_splitter *it, str_view v);
+
+// Starts splitting v into lines; "\n" and "\r\n" both end a line and a final
+// newline does not produce an extra empty line
+void str_split_lines_init(str_splitter *it, str_view v);
+
+// Stores the next field in *field, returns 1, or returns 0 when done
+int str_split_next(str_splitter *it, str_view *field);
+
+// Base64 flags: STR_BASE64_URL selects the URL-safe alphabet ('-' and '_'
+// instead of '+' and '/'); STR_BASE64_NOPAD omits '=' padding when encoding
+// and rejects it when decoding
+#define STR_BASE64_URL   1
+#define STR_BASE64_NOPAD 2
+
+// Hex flag: encode with uppercase digits (decoding accepts either case)
+#define STR_HEX_UPPER 1
+
+// Incremental base64 encoder for chunked input
+typedef struct {
+    unsigned char pending[3];
+    int npending;
+    int flags;
+} str_base64_encoder;
+
+// Incremental base64 decoder for chunked input
+typedef struct {
+    char pending[4];
+    int npending;
+    int flags;
+    int done;   // padding seen: no more input is allowed
+    int failed;
+} str_base64_decoder;
+
+// Incremental hex decoder for chunked input
+typedef struct {
+    char pending;
+    int npending;
+    int failed;
+} str_hex_decoder;
+
+// Returns the length of the base64 encoding of n bytes
+size_t str_base64_encoded_len(size_t n, int flags);
+
+// Returns the most bytes n base64 characters can decode to
+size_t str_base64_decoded_max(size_t n);
+
+// Encodes n bytes from src as base64 into dst (str_base64_encoded_len bytes,
+// not NUL-terminated), returns the number of characters written
+size_t str_base64_encode(const void *src, size_t n, char *dst, int flags);
+
+// Decodes n base64 characters into dst (str_base64_decoded_max bytes) and
+// stores the byte count in *out_len. Strict: no whitespace, padding exactly
+// as RFC 4648 requires (or none with STR_BASE64_NOPAD), and unused trailing
+// bits must be zero. Returns 0 on success, -1 on invalid input.
+int str_base64_decode(const char *src, size_t n, void *dst, size_t *out_len, int flags);
+
+// Starts an incremental base64 encoding
+void str_base64_encoder_init(str_base64_encoder *e, int flags);
+
+// Encodes the next n bytes; only whole groups are written, so dst needs
+// (n + 2) / 3 * 4 bytes with or without STR_BASE64_NOPAD. Returns the
+// number of characters written.
+size_t str_base64_encode_update(str_base64_encoder *e, const void *src, size_t n, char *dst);
+
+// Flushes the last partial group (up to 4 characters), returns the count
+size_t str_base64_encode_finish(str_base64_encoder *e, char *dst);
+
+// Starts an incremental base64 decoding
+void str_base64_decoder_init(str_base64_decoder *d, int flags);
+
+// Decodes the next n characters; dst needs str_base64_decoded_max(n + 3)
+// bytes. Stores the bytes written in *out_len. Returns 0, or -1 once the
+// input seen so far is invalid.
+int str_base64_decode_update(str_base64_decoder *d, const char *src, size_t n,
+                             void *dst, size_t *out_len);
+
+// Decodes a trailing unpadded group (up to 2 bytes into dst) and checks the
+// input ended cleanly. Returns 0 on success, -1 on invalid input.
+int str_base64_decode_finish(str_base64_decoder *d, void *dst, size_t *out_len);
+
+// Encodes n bytes from src as 2 * n hex digits in dst (not NUL-terminated),
+// returns the number of characters written
+size_t str_hex_encode(const void *src, size_t n, char *dst, int flags);
+
+// Decodes n hex digits (n even) into n / 2 bytes at dst. Returns 0 on
+// success, -1 on an odd length or a non-hex character.
+int str_hex_decode(const char *src, size_t n, void *dst);
+
+// Starts an incremental hex decoding
+void str_hex_decoder_init(str_hex_decoder *d);
+
+// Decodes the next n characters into dst ((n + 1) / 2 bytes), stores the
+// bytes written in *out_len. Returns 0, or -1 on a non-hex character.
+int str_hex_decode_update(str_hex_decoder *d, const char *src, size_t n,
+                          void *dst, size_t *out_len);
+
+// Checks no half byte is left over. Returns 0 on success, -1 otherwise.
+int str_hex_decode_finish(str_hex_decoder *d);
+
 #endif // STRING_UTILS_H
@@ -0,0 +1,328 @@
+#include "strsort_utils.h"
+#include "arena_utils.h"
+#include "char_utils.h"
+#include "thread_utils.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Ranges below this size are insertion sorted
+#define STRSORT_SMALL 32
+
+// Ranges at least this large split their buckets across the thread pool
+#define STRSORT_PARALLEL_MIN (1 << 16)
+
+// One string being sorted. key caches 8 bytes of the string, big-endian and
+// zero padded, starting at the depth of the range the item is in, so most
+// comparisons and all bucket passes read the item array sequentially
+// instead of chasing data pointers.
+typedef struct {
+    uint64_t key;
+    const char *data;
+    size_t len;
+    size_t idx;
+} strsort_item;
+
+// Shared state of one sort
+typedef struct {
+    strsort_item *items;
+    strsort_item *tmp;
+    size_t n;
+    const str_view *orig; // original strings, for natural-order tie breaks
+} strsort_ctx;
+
+// Internal helper: the 8 bytes of s[0..len) starting at depth as a key
+static inline uint64_t strsort_prefix(const char *s, size_t len, size_t depth) {
+    if (len <= depth) return 0;
+    const unsigned char *p = (const unsigned char *)s + depth;
+    size_t rem = len - depth;
+    if (rem >= 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        return __builtin_bswap64(v);
+    }
+    uint64_t v = 0;
+    for (size_t i = 0; i < rem; i++) v |= (uint64_t)p[i] << (56 - 8 * i);
+    return v;
+}
+
+// Internal helper: compares two items whose first depth bytes are equal
+static int strsort_compare(const strsort_ctx *c, const strsort_item *a,
+                           const strsort_item *b, size_t depth) {
+    if (a->key != b->key) return a->key < b->key ? -1 : 1;
+    size_t d = depth + 8;
+    int r = 0;
+    if (a->len > d && b->len > d) {
+        size_t n = a->len < b->len ? a->len : b->len;
+        r = memcmp(a->data + d, b->data + d, n - d);
+    }
+    // Equal keys with one string ending inside them: the shorter is a prefix
+    if (r == 0) r = (a->len > b->len) - (a->len < b->len);
+    if (r == 0 && c->orig) r = sv_compare(c->orig[a->idx], c->orig[b->idx]);
+    return r;
+}
+
+// Internal helper: insertion sort for small ranges
+static void strsort_insertion(const strsort_ctx *c, strsort_item *it, size_t n, size_t depth) {
+    for (size_t i = 1; i < n; i++) {
+        strsort_item x = it[i];
+        size_t j = i;
+        while (j > 0 && strsort_compare(c, &x, &it[j - 1], depth) < 0) {
+            it[j] = it[j - 1];
+            j--;
+        }
+        it[j] = x;
+    }
+}
+
+// Internal helper: merge sort of strings that are equal up to depth + 8
+// and end there, so only length and the tie break separate them
+static void strsort_ended(const strsort_ctx *c, strsort_item *it, strsort_item *tmp,
+                          size_t n, size_t depth) {
+    if (n < STRSORT_SMALL) {
+        strsort_insertion(c, it, n, depth);
+        return;
+    }
+    size_t half = n / 2;
+    strsort_ended(c, it, tmp, half, depth);
+    strsort_ended(c, it + half, tmp + half, n - half, depth);
+    if (strsort_compare(c, &it[half - 1], &it[half], depth) <= 0) return;
+    size_t i = 0, j = half, k = 0;
+    while (i < half && j < n) {
+        tmp[k++] = strsort_compare(c, &it[j], &it[i], depth) < 0 ? it[j++] : it[i++];
+    }
+    while (i < half) tmp[k++] = it[i++];
+    memcpy(it, tmp, k * sizeof(*it));
+}
+
+static void strsort_range(const strsort_ctx *c, size_t lo, size_t n, size_t depth, int shift);
+
+// One bucket of a split range, run as a thread pool task
+typedef struct {
+    const strsort_ctx *c;
+    size_t starts[257];
+    size_t depth;
+    int shift;
+} strsort_split;
+
+// Internal helper: sorts bucket i of a split range
+static void strsort_bucket_task(void *arg, size_t i) {
+    const strsort_split *s = arg;
+    size_t n = s->starts[i + 1] - s->starts[i];
+    if (n > 1) strsort_range(s->c, s->starts[i], n, s->depth, s->shift);
+}
+
+// Internal helper: sorts items[lo..lo+n), whose first depth bytes and the
+// key bytes above shift are all equal, by byte (key >> shift) & 0xff
+static void strsort_range(const strsort_ctx *c, size_t lo, size_t n, size_t depth, int shift) {
+    strsort_item *it = c->items + lo;
+    for (;;) {
+        if (n < STRSORT_SMALL) {
+            strsort_insertion(c, it, n, depth);
+            return;
+        }
+        if (shift < 0) {
+            // All keys are equal: move the strings that end here to the
+            // front, then continue eight bytes deeper with the rest
+            size_t d = depth + 8, ended = 0;
+            for (size_t i = 0; i < n; i++) {
+                if (it[i].len <= d) {
+                    strsort_item t = it[ended];
+                    it[ended++] = it[i];
+                    it[i] = t;
+                }
+            }
+            if (ended > 1) strsort_ended(c, it, c->tmp + lo, ended, depth);
+            it += ended;
+            lo += ended;
+            n -= ended;
+            depth = d;
+            shift = 56;
+            for (size_t i = 0; i < n; i++) it[i].key = strsort_prefix(it[i].data, it[i].len, depth);
+            continue;
+        }
+
+        size_t counts[256] = {0};
+        for (size_t i = 0; i < n; i++) counts[(it[i].key >> shift) & 0xff]++;
+        unsigned first = (it[0].key >> shift) & 0xff;
+        if (counts[first] == n) {
+            // A byte shared by the whole range (common path prefixes)
+            shift -= 8;
+            continue;
+        }
+
+        strsort_split split;
+        split.c = c;
+        split.depth = depth;
+        split.shift = shift - 8;
+        size_t pos[256];
+        size_t sum = 0;
+        for (int b = 0; b < 256; b++) {
+            split.starts[b] = lo + sum;
+            pos[b] = sum;
+            sum += counts[b];
+        }
+        split.starts[256] = lo + n;
+        strsort_item *tmp = c->tmp + lo;
+        for (size_t i = 0; i < n; i++) tmp[pos[(it[i].key >> shift) & 0xff]++] = it[i];
+        memcpy(it, tmp, n * sizeof(*it));
+
+        if (n >= STRSORT_PARALLEL_MIN) {
+            thread_parallel_for(256, strsort_bucket_task, &split);
+        } else {
+            for (size_t b = 0; b < 256; b++) strsort_bucket_task(&split, b);
+        }
+        return;
+    }
+}
+
+// Loads the first keys in chunks, as a thread pool task
+#define STRSORT_CHUNK (1 << 16)
+
+static void strsort_load_task(void *arg, size_t chunk) {
+    strsort_ctx *c = arg;
+    strsort_item *it = c->items;
+    size_t end = (chunk + 1) * STRSORT_CHUNK;
+    if (end > c->n) end = c->n;
+    for (size_t i = chunk * STRSORT_CHUNK; i < end; i++) {
+        it[i].key = strsort_prefix(it[i].data, it[i].len, 0);
+    }
+}
+
+// Internal helper: sorts n prepared items (data, len and idx set)
+static void strsort_items(strsort_item *items, size_t n, const str_view *orig) {
+    strsort_ctx c = {items, items + n, n, orig};
+    thread_parallel_for((n + STRSORT_CHUNK - 1) / STRSORT_CHUNK, strsort_load_task, &c);
+    strsort_range(&c, 0, n, 0, 56);
+}
+
+// Internal helper: writes the natural-order key of v to out, which needs
+// 3 * v.len bytes. Each run of digits becomes '0', its length without
+// leading zeros (one byte, or 255 and four big-endian bytes), then those
+// digits, so plain bytewise order of the keys is natural order.
+static size_t strsort_natural_key(str_view v, char *out) {
+    char *o = out;
+    size_t i = 0;
+    while (i < v.len) {
+        if (!ascii_is_digit(v.data[i])) {
+            *o++ = v.data[i++];
+            continue;
+        }
+        size_t end = i;
+        while (end < v.len && ascii_is_digit(v.data[end])) end++;
+        while (i < end && v.data[i] == '0') i++;
+        size_t len = end - i;
+        *o++ = '0';
+        if (len < 255) {
+            *o++ = (char)len;
+        } else {
+            *o++ = (char)255;
+            for (int s = 24; s >= 0; s -= 8) *o++ = (char)(len >> s);
+        }
+        memcpy(o, v.data + i, len);
+        o += len;
+        i = end;
+    }
+    return (size_t)(o - out);
+}
+
+// Internal helper: sorts views into out_order (indices into views)
+static int strsort_views(const str_view *views, size_t n, int flags, size_t *out_order) {
+    strsort_item *items = malloc(2 * n * sizeof(*items));
+    if (!items) return -1;
+    arena keys;
+    arena_init(&keys, 0);
+    for (size_t i = 0; i < n; i++) {
+        items[i].data = views[i].data;
+        items[i].len = views[i].len;
+        items[i].idx = i;
+        if (flags & STR_SORT_NATURAL) {
+            char *key = arena_alloc_aligned(&keys, 3 * views[i].len + 1, 1);
+            if (!key) {
+                arena_free(&keys);
+                free(items);
+                return -1;
+            }
+            size_t len = strsort_natural_key(views[i], key);
+            arena_realloc(&keys, key, 3 * views[i].len + 1, len);
+            items[i].data = key;
+            items[i].len = len;
+        }
+    }
+    strsort_items(items, n, flags & STR_SORT_NATURAL ? views : NULL);
+    for (size_t i = 0; i < n; i++) out_order[i] = items[i].idx;
+    arena_free(&keys);
+    free(items);
+    return 0;
+}
+
+// Sorts n NUL-terminated strings in place
+int str_sort(char **strs, size_t n, int flags) {
+    if (n < 2) return 0;
+    str_view *views = malloc(n * sizeof(*views));
+    size_t *order = malloc(n * sizeof(*order));
+    int rc = -1;
+    if (views && order) {
+        for (size_t i = 0; i < n; i++) views[i] = sv_from_cstr(strs[i]);
+        rc = strsort_views(views, n, flags, order);
+        if (rc == 0) {
+            for (size_t i = 0; i < n; i++) strs[i] = (char *)views[order[i]].data;
+        }
+    }
+    free(views);
+    free(order);
+    return rc;
+}
+
+// Sorts n views in place like str_sort
+int sv_sort(str_view *views, size_t n, int flags) {
+    if (n < 2) return 0;
+    str_view *copy = malloc(n * sizeof(*copy));
+    size_t *order = malloc(n * sizeof(*order));
+    int rc = -1;
+    if (copy && order) {
+        memcpy(copy, views, n * sizeof(*copy));
+        rc = strsort_views(copy, n, flags, order);
+        if (rc == 0) {
+            for (size_t i = 0; i < n; i++) views[i] = copy[order[i]];
+        }
+    }
+    free(copy);
+    free(order);
+    return rc;
+}
+
+// Compares two strings in the order STR_SORT_NATURAL sorts them
+int str_natural_compare(const char *a, const char *b) {
+    return sv_natural_compare(sv_from_cstr(a), sv_from_cstr(b));
+}
+
+// Compares two views in the order STR_SORT_NATURAL sorts them
+int sv_natural_compare(str_view a, str_view b) {
+    size_t i = 0, j = 0;
+    while (i < a.len && j < b.len) {
+        int da = ascii_is_digit(a.data[i]), db = ascii_is_digit(b.data[j]);
+        if (da && db) {
+            // Compare digit runs by significant length, then digit by digit
+            while (i < a.len && a.data[i] == '0') i++;
+            while (j < b.len && b.data[j] == '0') j++;
+            size_t ea = i, eb = j;
+            while (ea < a.len && ascii_is_digit(a.data[ea])) ea++;
+            while (eb < b.len && ascii_is_digit(b.data[eb])) eb++;
+            if (ea - i != eb - j) return ea - i < eb - j ? -1 : 1;
+            int r = memcmp(a.data + i, b.data + j, ea - i);
+            if (r != 0) return r;
+            i = ea;
+            j = eb;
+            continue;
+        }
+        // A digit run sorts where its leading '0' would
+        unsigned char ca = da ? '0' : (unsigned char)a.data[i];
+        unsigned char cb = db ? '0' : (unsigned char)b.data[j];
+        if (ca != cb) return ca < cb ? -1 : 1;
+        i++;
+        j++;
+    }
+    if (i < a.len || j < b.len) return i < a.len ? 1 : -1;
+    return sv_compare(a, b);
+}
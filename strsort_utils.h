@@ -0,0 +1,28 @@
+#ifndef STRSORT_UTILS_H
+#define STRSORT_UTILS_H
+
+#include <stddef.h>
+#include "string_utils.h"
+
+// Sort flag: order runs of digits by numeric value ("file2" < "file10").
+// Leading zeros are ignored except to break ties, which fall back to
+// bytewise order ("a01" < "a1").
+#define STR_SORT_NATURAL 0x1
+
+// Sorts n NUL-terminated strings in place, bytewise like str_compare (or
+// natural order with STR_SORT_NATURAL). Uses an MSD radix sort over cached
+// 8-byte prefixes and the shared thread pool for large inputs. The order of
+// equal strings is unspecified. Returns 0 on success, -1 on error.
+int str_sort(char **strs, size_t n, int flags);
+
+// Sorts n views in place like str_sort; a proper prefix sorts first and
+// embedded NUL bytes compare as ordinary bytes
+int sv_sort(str_view *views, size_t n, int flags);
+
+// Compares two strings in the order STR_SORT_NATURAL sorts them
+int str_natural_compare(const char *a, const char *b);
+
+// Compares two views in the order STR_SORT_NATURAL sorts them
+int sv_natural_compare(str_view a, str_view b);
+
+#endif // STRSORT_UTILS_H
@@ -0,0 +1,90 @@
+// test_arena_utils.c - Tests for arena_utils
+#include "arena_utils.h"
+#include "string_utils.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+// Test utility functions
+int test_count = 0;
+int test_passed = 0;
+
+void test_result(const char *test_name, int success) {
+    test_count++;
+    if (success) {
+        test_passed++;
+        printf("✓ %s\n", test_name);
+    } else {
+        printf("✗ %s\n", test_name);
+    }
+}
+
+// Test alignment and chunked growth
+void test_arena_alloc() {
+    arena a;
+    arena_init(&a, 256);
+    int ok = 1;
+    for (int i = 0; i < 100; i++) {
+        char *p = arena_alloc(&a, 7);
+        ok = ok && p && (uintptr_t)p % ARENA_ALIGN == 0;
+        memset(p, 'x', 7);
+    }
+    char *big = arena_alloc(&a, 4096);
+    ok = ok && big && arena_bytes_reserved(&a) >= 4096 + 100 * 7;
+    char *page = arena_alloc_aligned(&a, 10, 4096);
+    ok = ok && page && (uintptr_t)page % 4096 == 0;
+    arena_free(&a);
+    test_result("arena_alloc", ok);
+}
+
+// Test mark/reset releases later allocations only
+void test_arena_mark_reset() {
+    arena a;
+    arena_init(&a, 64);
+    char *keep = str_dup_arena(&a, "keep");
+    arena_mark m = arena_mark_get(&a);
+    size_t used = arena_bytes_used(&a);
+    for (int i = 0; i < 50; i++) str_dup_arena(&a, "temporary string");
+    arena_reset_to(&a, m);
+    int ok = arena_bytes_used(&a) == used && strcmp(keep, "keep") == 0;
+    char *next = str_dup_arena(&a, "next");
+    ok = ok && next == keep + 5;
+    arena_reset(&a);
+    ok = ok && arena_bytes_used(&a) == 0 && arena_bytes_reserved(&a) > 0;
+    arena_free(&a);
+    ok = ok && arena_bytes_reserved(&a) == 0;
+    test_result("arena_mark_reset", ok);
+}
+
+// Test in-place growth and the arena-backed builder
+void test_arena_builder() {
+    arena a;
+    arena_init(&a, 1024);
+    char *p = arena_alloc_aligned(&a, 10, 1);
+    char *q = arena_realloc(&a, p, 10, 100);
+    int ok = p == q;
+
+    str_builder sb;
+    sb_init_arena(&sb, &a);
+    for (int i = 0; i < 200; i++) sb_append(&sb, "token ");
+    size_t len;
+    char *out = sb_detach(&sb, &len);
+    ok = ok && len == 1200 && out[0] == 't' && out[len] == '\0';
+    ok = ok && sb.arena == &a;
+    char *after = arena_alloc_aligned(&a, 1, 1);
+    ok = ok && after == out + len + 1;
+    arena_free(&a);
+    test_result("arena_builder", ok);
+}
+
+int main() {
+    printf("Running arena_utils tests...\n\n");
+
+    test_arena_alloc();
+    test_arena_mark_reset();
+    test_arena_builder();
+
+    printf("\nTests completed: %d passed, %d failed\n",
+           test_passed, test_count - test_passed);
+    return test_passed == test_count ? 0 : 1;
+}
@@ -1,13 +1,374 @@
 // test_array_utils.c - Simple tests for array_utils
 #include "array_utils.h"
+#include "thread_utils.h"
+#include <limits.h>
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Test utility functions
+int test_count = 0;
+int test_passed = 0;
+
+void test_result(const char *test_name, int success) {
+    test_count++;
+    if (success) {
+        test_passed++;
+        printf("✓ %s\n", test_name);
+    } else {
+        printf("✗ %s\n", test_name);
+    }
+}
 
 void print_array(const int *arr, int len) {
     for (int i = 0; i < len; ++i) printf("%d ", arr[i]);
     printf("\n");
 }
 
+static unsigned rng_state = 42;
+
+static int next_rand(void) {
+    rng_state = rng_state * 1103515245 + 12345;
+    return (int)(rng_state ^ (rng_state << 7));
+}
+
+// Test every kernel level against straightforward loops at many lengths
+void test_kernels() {
+    enum { N = 1000 };
+    int *arr = malloc(N * sizeof(int));
+    int *rev = malloc(N * sizeof(int));
+    int ok = 1;
+    for (int level = ARRAY_SIMD_SCALAR; level <= ARRAY_SIMD_AVX2 && ok; level++) {
+        array_set_simd_limit(level);
+        for (int len = 1; len <= N && ok; len += len < 40 ? 1 : 37) {
+            for (int i = 0; i < len; i++) arr[i] = next_rand();
+            arr[len / 2] = INT_MIN;
+            if (len > 3) arr[len - 1] = INT_MAX;
+            unsigned wrap = 0;
+            long long sum = 0;
+            int mn = arr[0], mx = arr[0];
+            for (int i = 0; i < len; i++) {
+                wrap += (unsigned)arr[i];
+                sum += arr[i];
+                if (arr[i] < mn) mn = arr[i];
+                if (arr[i] > mx) mx = arr[i];
+            }
+            ok = array_sum(arr, len) == (int)wrap && array_sum64(arr, len) == sum;
+            ok = ok && array_min(arr, len) == mn && array_max(arr, len) == mx;
+            array_stats_result st;
+            ok = ok && array_stats(arr, len, &st) == 0 && st.sum == sum && st.min == mn && st.max == mx;
+            // Two-pass variance in long double as the reference
+            long double mean = (long double)sum / len, var = 0;
+            for (int i = 0; i < len; i++) var += (arr[i] - mean) * (arr[i] - mean);
+            var /= len;
+            ok = ok && fabsl(st.variance - var) <= var * 1e-12L && st.mean == (double)sum / len;
+            for (int i = 0; i < len; i++) rev[i] = arr[i];
+            array_reverse(rev, len);
+            for (int i = 0; i < len && ok; i++) ok = rev[i] == arr[len - 1 - i];
+        }
+    }
+    array_set_simd_limit(ARRAY_SIMD_AVX2);
+    free(arr);
+    free(rev);
+    test_result("kernels", ok);
+}
+
+// Test the stats edge cases: empty input, overflow of int sums, large means
+void test_stats() {
+    array_stats_result st;
+    int ok = array_stats(NULL, 0, &st) == -1 && st.sum == 0 && st.variance == 0;
+    int big[100];
+    for (int i = 0; i < 100; i++) big[i] = INT_MAX;
+    ok = ok && array_stats(big, 100, &st) == 0 && st.sum == 100LL * INT_MAX && st.variance == 0;
+    ok = ok && array_average(big, 100) == (double)INT_MAX;
+    // A tiny spread on a huge offset: one-pass double formulas lose it
+    for (int i = 0; i < 100; i++) big[i] = 2000000000 + (i % 2);
+    ok = ok && array_stats(big, 100, &st) == 0 && st.variance == 0.25 && st.mean == 2000000000.5;
+    test_result("stats", ok);
+}
+
+// Test the typed kernels at every level, including NaNs and 64-bit extremes
+void test_typed() {
+    enum { N = 300 };
+    int64_t i64[N];
+    uint64_t u64[N], ucopy[N];
+    float f32[N];
+    double f64[N];
+    int ok = 1;
+    for (int level = ARRAY_SIMD_SCALAR; level <= ARRAY_SIMD_AVX2 && ok; level++) {
+        array_set_simd_limit(level);
+        for (size_t len = 1; len <= N && ok; len += len < 20 ? 1 : 31) {
+            uint64_t wrap = 0;
+            long double fsum = 0, dsum = 0;
+            for (size_t i = 0; i < len; i++) {
+                u64[i] = (uint64_t)next_rand() << 33 ^ (uint64_t)next_rand();
+                i64[i] = (int64_t)u64[i];
+                f32[i] = (float)next_rand() / 1024;
+                f64[i] = (double)next_rand() * 1e-3;
+                wrap += u64[i];
+                fsum += f32[i];
+                dsum += f64[i];
+            }
+            ok = ok && (uint64_t)ARRAY_SUM(i64, len) == wrap && ARRAY_SUM(u64, len) == wrap;
+            ok = ok && fabsl(ARRAY_SUM(f32, len) - fsum) <= 1e-6L * len * fabsl(fsum) + 1;
+            ok = ok && fabsl(ARRAY_SUM(f64, len) - dsum) <= 1e-12L * len * fabsl(dsum) + 1;
+            if (len > 2) {
+                i64[len - 1] = INT64_MIN;
+                u64[len - 1] = UINT64_MAX;
+                f32[len / 2] = f64[len / 2] = NAN;
+                f32[0] = f64[0] = NAN;
+            }
+            int64_t imin = i64[len - 1], imax = imin;
+            uint64_t umin = u64[len - 1], umax = umin;
+            float fmn = INFINITY, fmx = -INFINITY;
+            double dmn = INFINITY, dmx = -INFINITY;
+            for (size_t i = 0; i < len; i++) {
+                if (i64[i] < imin) imin = i64[i];
+                if (i64[i] > imax) imax = i64[i];
+                if (u64[i] < umin) umin = u64[i];
+                if (u64[i] > umax) umax = u64[i];
+                if (f32[i] < fmn) fmn = f32[i];
+                if (f32[i] > fmx) fmx = f32[i];
+                if (f64[i] < dmn) dmn = f64[i];
+                if (f64[i] > dmx) dmx = f64[i];
+            }
+            int64_t a, b;
+            uint64_t c, d;
+            float e, f;
+            double g, h;
+            ok = ok && ARRAY_MINMAX(i64, len, &a, &b) == 0 && a == imin && b == imax;
+            ok = ok && ARRAY_MINMAX(u64, len, &c, &d) == 0 && c == umin && d == umax;
+            ok = ok && ARRAY_MINMAX(f32, len, &e, &f) == 0;
+            ok = ok && e == fmn && f == fmx;
+            ok = ok && ARRAY_MINMAX(f64, len, &g, &h) == 0;
+            ok = ok && g == dmn && h == dmx;
+            memcpy(ucopy, u64, len * sizeof(*u64));
+            ARRAY_REVERSE(u64, len);
+            for (size_t i = 0; i < len && ok; i++) ok = u64[i] == ucopy[len - 1 - i];
+        }
+    }
+    array_set_simd_limit(ARRAY_SIMD_AVX2);
+    // All NaN gives NaN; empty input is an error
+    double nans[5] = {NAN, NAN, NAN, NAN, NAN}, lo, hi;
+    ok = ok && array_minmax_f64(nans, 5, &lo, &hi) == 0 && isnan(lo) && isnan(hi);
+    ok = ok && array_minmax_f64(nans, 0, &lo, &hi) == -1;
+    test_result("typed kernels", ok);
+}
+
+static int cmp_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// A 24-byte record, to exercise array_sort's generic element moves
+typedef struct {
+    int key;
+    char pad[20];
+} record;
+
+static int cmp_record(const void *a, const void *b) {
+    return cmp_int(&((const record *)a)->key, &((const record *)b)->key);
+}
+
+// Test the radix sorts and array_sort against qsort on several patterns
+void test_sort() {
+    enum { N = 5000 };
+    int32_t *a = malloc(N * sizeof(int32_t)), *b = malloc(N * sizeof(int32_t));
+    int64_t *c = malloc(N * sizeof(int64_t));
+    record *r = malloc(N * sizeof(record));
+    int ok = 1;
+    for (int pattern = 0; pattern < 6 && ok; pattern++) {
+        for (size_t len = 0; len <= N && ok; len += len < 100 ? 7 : 1631) {
+            for (size_t i = 0; i < len; i++) {
+                switch (pattern) {
+                case 0: a[i] = next_rand(); break;                  // random
+                case 1: a[i] = (int)i; break;                       // sorted
+                case 2: a[i] = (int)(len - i); break;               // reversed
+                case 3: a[i] = next_rand() % 4; break;              // few distinct
+                case 4: a[i] = i % 2 ? INT_MIN : INT_MAX; break;    // extremes
+                default: a[i] = (int)(i % 64) * 3; break;           // sawtooth
+                }
+                b[i] = a[i];
+                c[i] = (int64_t)a[i] * 4000000000LL + (i % 3);
+                r[i].key = a[i];
+            }
+            qsort(b, len, sizeof(int32_t), cmp_int);
+            int32_t *d = malloc((len + 1) * sizeof(int32_t));
+            memcpy(d, a, len * sizeof(int32_t));
+            ok = array_radix_sort_i32(d, len) == 0 && memcmp(d, b, len * sizeof(int32_t)) == 0;
+            memcpy(d, a, len * sizeof(int32_t));
+            ok = ok && array_sort(d, len, sizeof(int32_t), cmp_int) == 0;
+            ok = ok && memcmp(d, b, len * sizeof(int32_t)) == 0;
+            ok = ok && array_sort(r, len, sizeof(record), cmp_record) == 0;
+            ok = ok && array_radix_sort_i64(c, len) == 0;
+            for (size_t i = 0; i < len && ok; i++) ok = r[i].key == b[i];
+            for (size_t i = 1; i < len && ok; i++) ok = c[i - 1] <= c[i];
+            free(d);
+        }
+    }
+    uint32_t u[] = {3000000000u, 5, 0, UINT32_MAX, 7};
+    ok = ok && array_radix_sort_u32(u, 5) == 0 && u[0] == 0 && u[4] == UINT32_MAX && u[3] == 3000000000u;
+    free(a);
+    free(b);
+    free(c);
+    free(r);
+    test_result("sort", ok);
+}
+
+// Test the bounds and the Eytzinger layout against linear scans
+void test_search() {
+    int32_t arr[300] = {0};
+    int ok = 1;
+    for (size_t len = 0; len <= 300 && ok; len += len < 40 ? 1 : 26) {
+        for (size_t i = 0; i < len; i++) arr[i] = (int32_t)(i / 3) * 2;    // runs of three
+        array_eytz t;
+        ok = array_eytz_init(&t, arr, len) == 0;
+        for (int32_t key = -2; key <= (int32_t)len && ok; key++) {
+            size_t lo = 0, hi = 0;
+            while (lo < len && arr[lo] < key) lo++;
+            while (hi < len && arr[hi] <= key) hi++;
+            ok = array_lower_bound_i32(arr, len, key) == lo && array_upper_bound_i32(arr, len, key) == hi;
+            ok = ok && array_eytz_lower_bound(&t, key) == lo;
+        }
+        array_eytz_free(&t);
+    }
+    int64_t big[] = {INT64_MIN, -1, 0, 0, INT64_MAX};
+    ok = ok && array_lower_bound_i64(big, 5, 0) == 2 && array_upper_bound_i64(big, 5, 0) == 4;
+    ok = ok && array_upper_bound_i64(big, 5, INT64_MAX) == 5 && array_lower_bound_i64(big, 5, INT64_MIN) == 0;
+    test_result("search", ok);
+}
+
+static int is_odd(int32_t x, void *ctx) {
+    (void)ctx;
+    return x & 1;
+}
+
+// Test scans, filters and partitions against scalar references, serially
+// at every level and in parallel blocks
+void test_scan_partition() {
+    size_t n = 2 * ((size_t)1 << 18) + 1001;
+    int32_t *src = malloc(n * sizeof(int32_t)), *dst = malloc(n * sizeof(int32_t));
+    int32_t *ref = malloc(n * sizeof(int32_t));
+    int64_t *w = malloc(n * sizeof(int64_t)), *wdst = malloc(n * sizeof(int64_t));
+    for (size_t i = 0; i < n; i++) {
+        src[i] = next_rand();
+        w[i] = (int64_t)src[i] * (1 << 20);
+    }
+    int ok = 1;
+    for (int pass = 0; pass < 4 && ok; pass++) {
+        // Scalar, SSE4.1 and AVX2 on short inputs, then AVX2 in blocks
+        size_t len = pass < 3 ? 1003 : n;
+        array_set_simd_limit(pass < 3 ? pass : ARRAY_SIMD_AVX2);
+        array_set_parallel_threshold(pass < 3 ? (size_t)1 << 22 : 0);
+        uint32_t s32 = 0;
+        uint64_t s64 = 0;
+        array_inclusive_scan_i32(src, dst, len);
+        array_exclusive_scan_i64(w, wdst, len);
+        for (size_t i = 0; i < len && ok; i++) {
+            s32 += (uint32_t)src[i];
+            ok = dst[i] == (int32_t)s32 && wdst[i] == (int64_t)s64;
+            s64 += (uint64_t)w[i];
+        }
+        array_exclusive_scan_i32(src, dst, len);
+        array_inclusive_scan_i64(w, wdst, len);
+        ok = ok && dst[0] == 0 && dst[len - 1] == (int32_t)(s32 - (uint32_t)src[len - 1]);
+        ok = ok && wdst[len - 1] == (int64_t)s64;
+
+        int32_t lo = -1000000000, hi = 500000000;
+        size_t kept = 0, rest = 0;
+        for (size_t i = 0; i < len; i++)
+            if (src[i] >= lo && src[i] <= hi) ref[kept++] = src[i];
+        for (size_t i = 0; i < len; i++)
+            if (!(src[i] >= lo && src[i] <= hi)) ref[kept + rest++] = src[i];
+        ok = ok && array_count_range_i32(src, len, lo, hi) == kept;
+        ok = ok && array_filter_range_i32(src, dst, len, lo, hi) == kept;
+        ok = ok && memcmp(dst, ref, kept * sizeof(int32_t)) == 0;
+        ok = ok && array_partition_range_i32(src, dst, len, lo, hi) == kept;
+        ok = ok && memcmp(dst, ref, len * sizeof(int32_t)) == 0;
+    }
+    array_set_parallel_threshold((size_t)1 << 22);
+    // In place filter, and the predicate versions
+    int32_t a[] = {5, 2, 7, 7, 4, 1, 8}, odd[] = {5, 7, 7, 1, 2, 4, 8}, b[7];
+    ok = ok && array_partition_i32(a, b, 7, is_odd, NULL) == 4 && memcmp(b, odd, sizeof(odd)) == 0;
+    ok = ok && array_filter_i32(a, a, 7, is_odd, NULL) == 4 && memcmp(a, odd, 4 * sizeof(int32_t)) == 0;
+    ok = ok && array_filter_range_i32(b, b, 7, 2, 7) == 5 && b[0] == 5 && b[4] == 4;
+    free(src);
+    free(dst);
+    free(ref);
+    free(w);
+    free(wdst);
+    test_result("scan and partition", ok);
+}
+
+// Test int_vec growth, shrinking and detaching, on the heap and in an arena,
+// and that the kernels take its data directly
+void test_int_vec() {
+    int_vec v;
+    iv_init(&v);
+    int ok = v.len == 0 && v.data == v.inline_buf;
+    for (int i = 0; i < 10; i++) ok = ok && iv_push(&v, i) == 0;
+    ok = ok && v.data == v.inline_buf && v.len == 10;
+    int more[1000];
+    for (int i = 0; i < 1000; i++) more[i] = 1000 - i;
+    ok = ok && iv_append(&v, more, 1000) == 0 && v.len == 1010 && v.data != v.inline_buf;
+    ok = ok && v.data[9] == 9 && v.data[10] == 1000 && v.data[1009] == 1;
+    array_stats_result st;
+    ok = ok && array_stats(v.data, v.len, &st) == 0 && st.sum == 45 + 500500 && st.max == 1000;
+    ok = ok && array_radix_sort_i32(v.data, v.len) == 0 && v.data[0] == 0 && v.data[1009] == 1000;
+    ok = ok && iv_resize(&v, 1200) == 0 && v.data[1199] == 0 && iv_shrink(&v) == 0 && v.cap == 1200;
+    ok = ok && iv_resize(&v, 3) == 0 && iv_shrink(&v) == 0 && v.data == v.inline_buf && v.data[2] == 1;
+    size_t n;
+    int *raw = iv_detach(&v, &n);
+    ok = ok && raw && n == 3 && raw[1] == 1 && v.len == 0;
+    free(raw);
+    iv_free(&v);
+
+    arena a;
+    arena_init(&a, 0);
+    iv_init_arena(&v, &a);
+    char *other = arena_alloc(&a, 3);
+    for (int i = 0; i < 5000; i++) ok = ok && iv_push(&v, i) == 0;
+    ok = ok && other && ((uintptr_t)v.data % sizeof(int)) == 0 && array_sum_i32(v.data, v.len) == 12497500;
+    raw = iv_detach(&v, &n);
+    ok = ok && n == 5000 && raw[4999] == 4999 && iv_detach(&v, &n) == NULL && n == 0;
+    iv_free(&v);
+    arena_free(&a);
+    test_result("int_vec", ok);
+}
+
+// Test that the parallel variants match the serial kernels
+void test_parallel() {
+    size_t n = 3 * ((size_t)1 << 18) + 12345;
+    int *arr = malloc(n * sizeof(int));
+    int *rev = malloc(n * sizeof(int));
+    for (size_t i = 0; i < n; i++) arr[i] = rev[i] = next_rand();
+    arr[n - 7] = INT_MIN;
+    rev[n - 7] = INT_MIN;
+    array_set_parallel_threshold(0);
+    array_stats_result a, b;
+    int mn, mx;
+    int ok = array_sum64_parallel(arr, n) == array_sum64(arr, n);
+    ok = ok && array_minmax_parallel(arr, n, &mn, &mx) == 0 && mn == INT_MIN;
+    ok = ok && mx == array_max(arr, (int)n);
+    ok = ok && array_stats_parallel(arr, n, &a) == 0 && array_stats(arr, n, &b) == 0;
+    ok = ok && a.sum == b.sum && a.min == b.min && a.max == b.max && a.variance == b.variance;
+    ok = ok && array_minmax_parallel(arr, 0, &mn, &mx) == -1;
+    for (size_t len = n; len >= n - 1; len--) {
+        array_reverse_parallel(rev, len);
+        for (size_t i = 0; i < len && ok; i++) ok = rev[i] == arr[len - 1 - i];
+        array_reverse_parallel(rev, len);
+    }
+    array_set_parallel_threshold((size_t)1 << 22);
+    free(arr);
+    free(rev);
+    test_result("parallel", ok);
+}
+
 int main() {
+    // Several threads even on small machines, so the chunked paths run
+    thread_pool_init(4);
+
     int arr[] = {1, 2, 3, 4, 5};
     int len = 5;
     printf("sum: %d\n", array_sum(arr, len));
@@ -16,5 +377,19 @@ int main() {
     printf("max: %d\n", array_max(arr, len));
     array_reverse(arr, len);
     print_array(arr, len);
-    return 0;
+
+    printf("\nRunning array_utils tests...\n\n");
+
+    test_kernels();
+    test_stats();
+    test_typed();
+    test_sort();
+    test_search();
+    test_scan_partition();
+    test_int_vec();
+    test_parallel();
+
+    printf("\nTests completed: %d passed, %d failed\n",
+           test_passed, test_count - test_passed);
+    return test_passed == test_count ? 0 : 1;
 }
@@ -0,0 +1,77 @@
+// test_char_utils.c - Tests for char_utils
+#include "char_utils.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+// Test utility functions
+int test_count = 0;
+int test_passed = 0;
+
+void test_result(const char *test_name, int success) {
+    test_count++;
+    if (success) {
+        test_passed++;
+        printf("✓ %s\n", test_name);
+    } else {
+        printf("✗ %s\n", test_name);
+    }
+}
+
+// Test the class table against <ctype.h> in the C locale
+void test_ascii_table() {
+    int ok = 1;
+    for (int c = 0; c < 256; c++) {
+        char ch = (char)c;
+        ok = ok && !ascii_is_alpha(ch) == !isalpha(c);
+        ok = ok && !ascii_is_digit(ch) == !isdigit(c);
+        ok = ok && !ascii_is_alnum(ch) == !isalnum(c);
+        ok = ok && !ascii_is_space(ch) == !isspace(c);
+        ok = ok && !ascii_is_upper(ch) == !isupper(c);
+        ok = ok && !ascii_is_lower(ch) == !islower(c);
+        ok = ok && !ascii_is_punct(ch) == !ispunct(c);
+        ok = ok && !ascii_is_xdigit(ch) == !isxdigit(c);
+        ok = ok && (unsigned char)ascii_to_upper(ch) == toupper(c);
+        ok = ok && (unsigned char)ascii_to_lower(ch) == tolower(c);
+        ok = ok && !is_alpha(ch) == !ascii_is_alpha(ch);
+    }
+    test_result("ascii_table", ok);
+}
+
+// Test whole-buffer kernels against the single-character helpers
+void test_ascii_buffers() {
+    char buf[300], up[300], low[300];
+    unsigned char cls[300];
+    for (int i = 0; i < 300; i++) buf[i] = (char)(i * 37 + 11);
+    memcpy(up, buf, sizeof(buf));
+    memcpy(low, buf, sizeof(buf));
+    ascii_to_upper_buf(up, sizeof(up));
+    ascii_to_lower_buf(low, sizeof(low));
+    ascii_classify_buf(buf, sizeof(buf), cls);
+    int ok = 1;
+    size_t digits = 0;
+    for (int i = 0; i < 300; i++) {
+        ok = ok && up[i] == ascii_to_upper(buf[i]) && low[i] == ascii_to_lower(buf[i]);
+        ok = ok && cls[i] == ascii_class_table[(unsigned char)buf[i]];
+        digits += ascii_is_digit(buf[i]) != 0;
+    }
+    ok = ok && ascii_count(buf, sizeof(buf), ASCII_DIGIT) == digits;
+
+    const char *line = "20241019abcdefghijklmnopqrstuvwxyz0123456789 tail";
+    ok = ok && ascii_span(line, strlen(line), ASCII_DIGIT) == 8;
+    ok = ok && ascii_span(line, strlen(line), ASCII_ALNUM) == 44;
+    ok = ok && ascii_span(line, 40, ASCII_ALNUM) == 40;
+    ok = ok && ascii_span(line, strlen(line), ASCII_SPACE) == 0;
+    test_result("ascii_buffers", ok);
+}
+
+int main() {
+    printf("Running char_utils tests...\n\n");
+
+    test_ascii_table();
+    test_ascii_buffers();
+
+    printf("\nTests completed: %d passed, %d failed\n",
+           test_passed, test_count - test_passed);
+    return test_passed == test_count ? 0 : 1;
+}
@@ -1,8 +1,151 @@
 // test_float_utils.c - Simple tests for float_utils
 #include "float_utils.h"
+#include <math.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Test utility functions
+int test_count = 0;
+int test_passed = 0;
+
+void test_result(const char *test_name, int success) {
+    test_count++;
+    if (success) {
+        test_passed++;
+        printf("✓ %s\n", test_name);
+    } else {
+        printf("✗ %s\n", test_name);
+    }
+}
+
+static uint64_t rng_state = 88172645463325252ULL;
+
+// Uniform double in [0, 1)
+static double next_unit(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (double)(rng_state >> 11) * 0x1p-53;
+}
+
+// Distance of r from ref in units of the last place of ref
+static double ulp_error(double r, long double ref) {
+    int e;
+    frexp((double)ref, &e);
+    return (double)(fabsl((long double)r - ref) / ldexp(1.0, e - 53));
+}
+
+// Same value, telling NaN == NaN and -0.0 != 0.0
+static int same_double(double a, double b) {
+    return memcmp(&a, &b, sizeof(a)) == 0 || (isnan(a) && isnan(b));
+}
+
+void test_rounding() {
+    static const double edges[] = {
+        -0.0, 0.0, 0.5, -0.5, 1.5, -1.5, 2.5, -2.5, -0.3, 0.49999999999999994,
+        -0.49999999999999994, 4503599627370495.5, -4503599627370497.0, 1e300,
+        4.9e-324, -4.9e-324, INFINITY, -INFINITY, NAN
+    };
+    enum { N = 301 };
+    double src[N], dst[N];
+    size_t ne = sizeof(edges) / sizeof(edges[0]);
+    int ok = 1;
+
+    for (int i = 0; i < N; i++)
+        src[i] = i % 3 == 0 ? edges[i / 3 % ne] : (next_unit() - 0.5) * (i % 3 == 1 ? 10.0 : 1e6);
+    for (size_t n = 0; n <= N; n = n < 20 ? n + 1 : n * 2 + 1) {
+        float_round_array(src, dst, n);
+        for (size_t i = 0; i < n; i++) ok = ok && same_double(dst[i], round(src[i]));
+        float_floor_array(src, dst, n);
+        for (size_t i = 0; i < n; i++) ok = ok && same_double(dst[i], floor(src[i]));
+        float_ceil_array(src, dst, n);
+        for (size_t i = 0; i < n; i++) ok = ok && same_double(dst[i], ceil(src[i]));
+    }
+    // In place
+    memcpy(dst, src, sizeof(src));
+    float_round_array(dst, dst, N);
+    for (int i = 0; i < N; i++) ok = ok && same_double(dst[i], round(src[i]));
+    test_result("round/floor/ceil arrays", ok);
+}
+
+void test_fast_math() {
+    enum { N = 20000 };
+    double *x = malloc(N * sizeof(double)), *y = malloc(N * sizeof(double));
+    double *out = malloc(N * sizeof(double));
+    double worst_exp = 0, worst_log = 0, worst_pow = 0;
+    int ok = 1;
+
+    for (int i = 0; i < N; i++) x[i] = (next_unit() * 2 - 1) * 708;
+    float_exp_array(x, out, N, FLOAT_FAST);
+    for (int i = 0; i < N; i++) worst_exp = fmax(worst_exp, ulp_error(out[i], expl(x[i])));
+    float_exp_array(x, out, N, FLOAT_EXACT);
+    for (int i = 0; i < N; i++) ok = ok && same_double(out[i], exp(x[i]));
+
+    for (int i = 0; i < N; i++) x[i] = i % 2 ? exp((next_unit() * 2 - 1) * 700) : 1 + (next_unit() - 0.5) * 1e-3;
+    float_log_array(x, out, N, FLOAT_FAST);
+    for (int i = 0; i < N; i++) worst_log = fmax(worst_log, ulp_error(out[i], logl(x[i])));
+
+    for (int i = 0; i < N; i++) {
+        x[i] = next_unit() * 100;
+        y[i] = (next_unit() * 2 - 1) * 8;
+    }
+    float_pow_array(x, y, out, N, FLOAT_FAST);
+    for (int i = 0; i < N; i++) {
+        double bound = 2 * (1 + fabs(y[i] * log(x[i])));
+        worst_pow = fmax(worst_pow, ulp_error(out[i], powl(x[i], y[i])) / bound);
+    }
+    printf("fast exp %.2f ULP, log %.2f ULP, pow %.2f of its bound\n", worst_exp, worst_log, worst_pow);
+    ok = ok && worst_exp < 1 && worst_log < 1 && worst_pow <= 1;
+
+    // Special and out-of-range inputs give exactly what libm gives, in
+    // every lane position and when dst aliases the input
+    static const double exp_special[] = { NAN, INFINITY, -INFINITY, 0.0, -0.0, 710.0, -710.0, -745.5, 1e4 };
+    static const double log_special[] = { NAN, INFINITY, -INFINITY, 0.0, -0.0, -1.0, 4.9e-324, 1e-310, 1.0 };
+    static const double pow_base[] = { NAN, INFINITY, -INFINITY, 0.0, -0.0, -1.0, -2.0, 4.9e-324 };
+    static const double pow_exp[] = { NAN, INFINITY, -INFINITY, 0.0, -0.0, 2.0, -1.0, 0.5, 3.0 };
+    enum { S = 9 };
+    double v[S], b[2 * S * S + 4], e[2 * S * S + 4], r[2 * S * S + 4];
+    for (int i = 0; i < S; i++) {
+        memcpy(v, exp_special, sizeof(v));
+        float_exp_array(v + i, v + i, S - i, FLOAT_FAST);
+        for (int j = i; j < S; j++) ok = ok && same_double(v[j], exp(exp_special[j]));
+        memcpy(v, log_special, sizeof(v));
+        float_log_array(v + i, v + i, S - i, FLOAT_FAST);
+        for (int j = i; j < S; j++) ok = ok && same_double(v[j], log(log_special[j]));
+    }
+    // Every special base with every exponent, every non-finite or zero
+    // exponent with ordinary bases, and results that overflow or underflow
+    int np = 0;
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < S; j++) {
+            b[np] = pow_base[i];
+            e[np++] = pow_exp[j];
+            if (j < 5) {
+                b[np] = 0.5 + i;
+                e[np++] = pow_exp[j];
+            }
+        }
+    }
+    b[np] = 10.0; e[np++] = 400.0;
+    b[np] = 10.0; e[np++] = -400.0;
+    b[np] = 0.5; e[np++] = 1074.0;
+    b[np] = 1.0; e[np++] = NAN;
+    float_pow_array(b, e, r, np, FLOAT_FAST);
+    for (int i = 0; i < np; i++) ok = ok && same_double(r[i], pow(b[i], e[i]));
+    float_pow_array(b, e, e, np, FLOAT_FAST);
+    for (int i = 0; i < np; i++) ok = ok && same_double(e[i], r[i]);
+
+    test_result("fast exp/log/pow", ok);
+    free(x);
+    free(y);
+    free(out);
+}
 
 int main() {
+    printf("Running float_utils tests...\n\n");
+
     double a = -3.7, b = 2.5;
     printf("abs: %.2f\n", float_abs(a));
     printf("min: %.2f\n", float_min(a, b));
@@ -10,6 +153,12 @@ int main() {
     printf("round: %.2f\n", float_round(a));
     printf("floor: %.2f\n", float_floor(a));
     printf("ceil: %.2f\n", float_ceil(a));
-    printf("pow: %.2f\n", float_pow(2.0, 3.0));
-    return 0;
+    printf("pow: %.2f\n\n", float_pow(2.0, 3.0));
+
+    test_rounding();
+    test_fast_math();
+
+    printf("\nTests completed: %d passed, %d failed\n",
+           test_passed, test_count - test_passed);
+    return test_passed == test_count ? 0 : 1;
 }
@@ -0,0 +1,215 @@
+// test_hash_utils.c - Tests for hash_utils
+#include "hash_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Test utility functions
+int test_count = 0;
+int test_passed = 0;
+
+void test_result(const char *test_name, int success) {
+    test_count++;
+    if (success) {
+        test_passed++;
+        printf("✓ %s\n", test_name);
+    } else {
+        printf("✗ %s\n", test_name);
+    }
+}
+
+// Test the hash is deterministic, seeded, and reads only len bytes
+void test_hash_bytes() {
+    char buf[128];
+    for (int i = 0; i < 128; i++) buf[i] = (char)(i * 7);
+    int ok = hash_bytes("hello", 5, 0) == hash_cstr("hello", 0);
+    ok = ok && hash_bytes("hello", 5, 0) != hash_bytes("hello", 5, 1);
+    ok = ok && hash_bytes("", 0, 0) != hash_bytes("", 0, 1);
+    // Every length path: a change in any byte changes the hash, and bytes
+    // past len are ignored
+    for (size_t len = 1; len <= 100 && ok; len++) {
+        uint64_t h = hash_bytes(buf, len, 42);
+        buf[len] ^= 1;
+        ok = hash_bytes(buf, len, 42) == h;
+        buf[len] ^= 1;
+        for (size_t i = 0; i < len && ok; i++) {
+            buf[i] ^= 0x10;
+            ok = hash_bytes(buf, len, 42) != h;
+            buf[i] ^= 0x10;
+        }
+    }
+    // Low bits of sequential keys should spread over the buckets
+    int buckets[64] = {0};
+    for (int i = 0; i < 64000; i++) {
+        int n = snprintf(buf, sizeof(buf), "key%d", i);
+        buckets[hash_bytes(buf, (size_t)n, 0) & 63]++;
+    }
+    for (int i = 0; i < 64; i++) ok = ok && buckets[i] > 850 && buckets[i] < 1150;
+    ok = ok && hash_u64(1) != hash_u64(2) && (hash_u64(1) >> 32) != 0;
+    test_result("hash_bytes", ok);
+}
+
+// Test inserts, lookups, updates and growth
+void test_map_basic() {
+    hash_map m;
+    hash_map_init(&m);
+    char key[32];
+    int ok = hash_map_find(&m, SV_LIT("missing")) == NULL;
+    for (int i = 0; i < 10000 && ok; i++) {
+        int n = snprintf(key, sizeof(key), "k%d", i);
+        ok = hash_map_put(&m, sv_make(key, (size_t)n), (uint64_t)i * 3) == 0;
+    }
+    ok = ok && m.count == 10000 && m.count <= m.cap / 8 * 7;
+    for (int i = 0; i < 10000 && ok; i++) {
+        int n = snprintf(key, sizeof(key), "k%d", i);
+        uint64_t v;
+        ok = hash_map_get(&m, sv_make(key, (size_t)n), &v) && v == (uint64_t)i * 3;
+    }
+    int inserted = -1;
+    hash_map_entry *e = hash_map_upsert(&m, SV_LIT("k17"), &inserted);
+    ok = ok && e && !inserted && e->value == 51 && strcmp(e->key, "k17") == 0;
+    e = hash_map_upsert(&m, SV_LIT("new"), &inserted);
+    ok = ok && e && inserted && e->value == 0;
+    e->value++;
+    ok = ok && hash_map_find(&m, SV_LIT("new"))->value == 1;
+    ok = ok && hash_map_find(&m, SV_LIT("k10000")) == NULL;
+    // Empty and binary keys
+    ok = ok && hash_map_put(&m, SV_LIT(""), 5) == 0 && hash_map_find(&m, SV_LIT(""))->value == 5;
+    ok = ok && hash_map_put(&m, sv_make("a\0b", 3), 6) == 0 && hash_map_find(&m, SV_LIT("a")) == NULL;
+    hash_map_free(&m);
+    test_result("map_basic", ok);
+}
+
+// Test that a full table doubles rather than growing further
+void test_map_growth() {
+    hash_map m;
+    hash_map_init(&m);
+    char key[32];
+    int ok = 1;
+    for (int i = 0; i < 14 && ok; i++) {
+        int n = snprintf(key, sizeof(key), "k%d", i);
+        ok = hash_map_put(&m, sv_make(key, (size_t)n), 1) == 0;
+    }
+    ok = ok && m.cap == 16;
+    ok = ok && hash_map_put(&m, SV_LIT("k14"), 1) == 0 && m.cap == 32;
+    for (int i = 15; i < 29 && ok; i++) {
+        int n = snprintf(key, sizeof(key), "k%d", i);
+        ok = hash_map_put(&m, sv_make(key, (size_t)n), 1) == 0;
+    }
+    ok = ok && m.cap == 64 && m.count == 29;
+    hash_map_free(&m);
+    test_result("map_growth", ok);
+}
+
+// Test removal and tombstone reuse against a reference array
+void test_map_remove() {
+    enum { N = 2000 };
+    hash_map m;
+    hash_map_init(&m);
+    char present[N] = {0};
+    char key[16];
+    unsigned seed = 7;
+    int ok = 1;
+    for (int round = 0; round < 200000 && ok; round++) {
+        seed = seed * 1103515245 + 12345;
+        int k = (int)((seed >> 8) % N);
+        int n = snprintf(key, sizeof(key), "%d", k);
+        str_view v = sv_make(key, (size_t)n);
+        if ((seed >> 4) & 1) {
+            ok = hash_map_remove(&m, v) == present[k];
+            present[k] = 0;
+        } else {
+            ok = hash_map_put(&m, v, (uint64_t)k) == 0;
+            present[k] = 1;
+        }
+    }
+    size_t expect = 0;
+    for (int k = 0; k < N && ok; k++) {
+        int n = snprintf(key, sizeof(key), "%d", k);
+        hash_map_entry *e = hash_map_find(&m, sv_make(key, (size_t)n));
+        ok = present[k] ? e && e->value == (uint64_t)k : e == NULL;
+        expect += present[k];
+    }
+    ok = ok && m.count == expect && m.cap <= 4096;
+    test_result("map_remove", ok);
+    hash_map_free(&m);
+}
+
+// Test churn near the load limit rebuilds at the same capacity once
+// tombstones fill the table, instead of growing or shrinking it
+void test_map_tombstones() {
+    enum { LIVE = 55, ROUNDS = 2000 };
+    hash_map m;
+    hash_map_init(&m);
+    int ok = hash_map_reserve(&m, 56) == 0 && m.cap == 64;
+    char key[16];
+    for (int i = 0; i < LIVE; i++) {
+        int n = snprintf(key, sizeof(key), "%d", i);
+        hash_map_put(&m, sv_make(key, (size_t)n), (uint64_t)i);
+    }
+    size_t rebuilds = 0, prev = 0;
+    for (int i = 0; i < ROUNDS && ok; i++) {
+        int n = snprintf(key, sizeof(key), "%d", i);
+        ok = hash_map_remove(&m, sv_make(key, (size_t)n)) == 1;
+        n = snprintf(key, sizeof(key), "%d", i + LIVE);
+        ok = ok && hash_map_put(&m, sv_make(key, (size_t)n), (uint64_t)(i + LIVE)) == 0;
+        ok = ok && m.cap == 64 && m.count == LIVE;
+        if (m.tombstones < prev) rebuilds++;
+        prev = m.tombstones;
+    }
+    for (int i = ROUNDS; i < ROUNDS + LIVE && ok; i++) {
+        int n = snprintf(key, sizeof(key), "%d", i);
+        hash_map_entry *e = hash_map_find(&m, sv_make(key, (size_t)n));
+        ok = e && e->value == (uint64_t)i;
+    }
+    ok = ok && rebuilds > 0;
+    hash_map_free(&m);
+    test_result("map_tombstones", ok);
+}
+
+// Test iteration visits each entry once, and clear/reserve
+void test_map_iterate() {
+    hash_map m;
+    hash_map_init(&m);
+    int ok = hash_map_reserve(&m, 1000) == 0 && m.cap >= 1000;
+    size_t cap = m.cap;
+    char key[16];
+    for (int i = 0; i < 1000; i++) {
+        int n = snprintf(key, sizeof(key), "%d", i);
+        hash_map_put(&m, sv_make(key, (size_t)n), (uint64_t)i);
+    }
+    ok = ok && m.cap == cap;
+    for (int i = 0; i < 1000; i += 2) {
+        int n = snprintf(key, sizeof(key), "%d", i);
+        hash_map_remove(&m, sv_make(key, (size_t)n));
+    }
+    char seen[1000] = {0};
+    size_t pos = 0, visits = 0;
+    hash_map_entry *e;
+    while ((e = hash_map_next(&m, &pos))) {
+        ok = ok && e->value < 1000 && e->value % 2 == 1 && !seen[e->value];
+        seen[e->value] = 1;
+        visits++;
+    }
+    ok = ok && visits == 500;
+    hash_map_clear(&m);
+    pos = 0;
+    ok = ok && m.count == 0 && hash_map_next(&m, &pos) == NULL && m.cap == cap;
+    hash_map_free(&m);
+    test_result("map_iterate", ok);
+}
+
+int main() {
+    printf("Running hash_utils tests...\n\n");
+
+    test_hash_bytes();
+    test_map_basic();
+    test_map_growth();
+    test_map_remove();
+    test_map_tombstones();
+    test_map_iterate();
+
+    printf("\nTests completed: %d passed, %d failed\n",
+           test_passed, test_count - test_passed);
+    return test_passed == test_count ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+// test_intern_utils.c - Tests for intern_utils
+#include "intern_utils.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+// Test utility functions
+int test_count = 0;
+int test_passed = 0;
+
+void test_result(const char *test_name, int success) {
+    test_count++;
+    if (success) {
+        test_passed++;
+        printf("✓ %s\n", test_name);
+    } else {
+        printf("✗ %s\n", test_name);
+    }
+}
+
+// Test that equal strings share one pointer across table growth
+void test_intern_basic() {
+    intern_table t;
+    intern_init(&t);
+    char path[] = "/usr/local/bin";
+    const char *a = intern_cstr(&t, path);
+    path[1] = 'X';
+    int ok = a && strcmp(a, "/usr/local/bin") == 0;
+    char buf[32];
+    for (int i = 0; i < 5000; i++) {
+        snprintf(buf, sizeof(buf), "key%d", i % 1000);
+        intern_cstr(&t, buf);
+    }
+    ok = ok && intern_cstr(&t, "/usr/local/bin") == a;
+    ok = ok && intern_view(&t, sv_make("/usr/local/binary", 14)) == a;
+    ok = ok && intern_lookup(&t, SV_LIT("key999")) != NULL;
+    ok = ok && intern_lookup(&t, SV_LIT("key1000")) == NULL;
+    ok = ok && intern_cstr(&t, "") != NULL && intern_cstr(&t, "") == intern_cstr(&t, "");
+
+    intern_stats st;
+    intern_get_stats(&t, &st);
+    ok = ok && st.unique == 1002 && st.requests == 5006;
+    ok = ok && st.bytes_stored < st.bytes_requested;
+    intern_free(&t);
+    test_result("intern_basic", ok);
+}
+
+static intern_table_mt mt;
+static const char *seen[4][200];
+
+static void *intern_worker(void *arg) {
+    int id = (int)(long)arg;
+    char buf[32];
+    for (int round = 0; round < 50; round++) {
+        for (int i = 0; i < 200; i++) {
+            snprintf(buf, sizeof(buf), "user%d", i);
+            seen[id][i] = intern_mt_cstr(&mt, buf);
+        }
+    }
+    return NULL;
+}
+
+// Test that concurrent interning agrees on canonical pointers
+void test_intern_mt() {
+    int ok = intern_mt_init(&mt) == 0;
+    pthread_t th[4];
+    for (long i = 0; i < 4; i++) pthread_create(&th[i], NULL, intern_worker, (void *)i);
+    for (int i = 0; i < 4; i++) pthread_join(th[i], NULL);
+    for (int i = 0; i < 200; i++) {
+        for (int id = 1; id < 4; id++) ok = ok && seen[id][i] == seen[0][i];
+    }
+    intern_stats st;
+    intern_mt_get_stats(&mt, &st);
+    ok = ok && st.unique == 200 && st.requests == 4 * 50 * 200;
+    intern_mt_free(&mt);
+    test_result("intern_mt", ok);
+}
+
+int main() {
+    printf("Running intern_utils tests...\n\n");
+
+    test_intern_basic();
+    test_intern_mt();
+
+    printf("\nTests completed: %d passed, %d failed\n",
+           test_passed, test_count - test_passed);
+    return test_passed == test_count ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+// test_math_utils.c - Tests for math_utils
+#include "math_utils.h"
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Test utility functions
+int test_count = 0;
+int test_passed = 0;
+
+void test_result(const char *test_name, int success) {
+    test_count++;
+    if (success) {
+        test_passed++;
+        printf("✓ %s\n", test_name);
+    } else {
+        printf("✗ %s\n", test_name);
+    }
+}
+
+static uint64_t rng_state = 88172645463325252ULL;
+
+// Mostly ordinary values, with the edges of int mixed in
+static int next_value(void) {
+    static const int edges[] = { INT_MIN, INT_MIN + 1, -46341, -1, 0, 1, 46341, INT_MAX - 1, INT_MAX };
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    switch (rng_state >> 61) {
+    case 0: return edges[rng_state % (sizeof(edges) / sizeof(edges[0]))];
+    case 1: return (int)(rng_state >> 32);
+    default: return (int)(rng_state % 200001) - 100000;
+    }
+}
+
+void test_scalar() {
+    int v = 0, ok = 1;
+    ok = ok && pow_int(2, 10) == 1024 && pow_int(-3, 3) == -27 && pow_int(7, 0) == 1;
+    ok = ok && pow_int(5, -1) == 1 && pow_int(2, 31) == INT_MIN;
+    ok = ok && pow_int_checked(3, 19, &v) == 0 && v == 1162261467;
+    ok = ok && pow_int_checked(-2, 31, &v) == 0 && v == INT_MIN;
+    ok = ok && pow_int_checked(2, 31, &v) == -1 && v == INT_MIN;
+    ok = ok && pow_int_checked(46341, 2, &v) == -1;
+    ok = ok && pow_int_checked(-1, INT_MAX, &v) == 0 && v == -1;
+    ok = ok && pow_int_checked(2, -1, &v) == -1;
+    ok = ok && abs_val(INT_MIN) == INT_MIN && abs_val(-5) == 5;
+    test_result("pow_int and abs_val", ok);
+}
+
+// Compares every batch kernel to its scalar definition at many lengths
+void test_batch() {
+    enum { N = 1000 };
+    int *a = malloc(N * sizeof(int)), *b = malloc(N * sizeof(int));
+    int *out = malloc(N * sizeof(int)), *inplace = malloc(N * sizeof(int));
+    int ok_add = 1, ok_mul = 1, ok_minmax = 1, ok_unary = 1;
+
+    for (int i = 0; i < N; i++) {
+        a[i] = next_value();
+        b[i] = next_value();
+    }
+
+    for (size_t n = 0; n <= N; n = n < 40 ? n + 1 : n * 3 + 7) {
+        int over = 0, o;
+        add_array(a, b, out, n);
+        for (size_t i = 0; i < n; i++)
+            ok_add = ok_add && out[i] == (int)((unsigned)a[i] + (unsigned)b[i]);
+        add_sat_array(a, b, out, n);
+        for (size_t i = 0; i < n; i++) {
+            int64_t s = (int64_t)a[i] + b[i];
+            ok_add = ok_add && out[i] == (s > INT_MAX ? INT_MAX : s < INT_MIN ? INT_MIN : s);
+        }
+        o = add_checked_array(a, b, out, n);
+        for (size_t i = 0; i < n; i++) {
+            int r;
+            over |= __builtin_add_overflow(a[i], b[i], &r);
+            ok_add = ok_add && out[i] == r;
+        }
+        ok_add = ok_add && o == (over ? -1 : 0);
+
+        over = 0;
+        multiply_array(a, b, out, n);
+        for (size_t i = 0; i < n; i++)
+            ok_mul = ok_mul && out[i] == (int)((unsigned)a[i] * (unsigned)b[i]);
+        multiply_sat_array(a, b, out, n);
+        for (size_t i = 0; i < n; i++) {
+            int64_t p = (int64_t)a[i] * b[i];
+            ok_mul = ok_mul && out[i] == (p > INT_MAX ? INT_MAX : p < INT_MIN ? INT_MIN : p);
+        }
+        o = multiply_checked_array(a, b, out, n);
+        for (size_t i = 0; i < n; i++) {
+            int r;
+            over |= __builtin_mul_overflow(a[i], b[i], &r);
+            ok_mul = ok_mul && out[i] == r;
+        }
+        ok_mul = ok_mul && o == (over ? -1 : 0);
+
+        min_array(a, b, out, n);
+        for (size_t i = 0; i < n; i++) ok_minmax = ok_minmax && out[i] == min(a[i], b[i]);
+        max_array(a, b, out, n);
+        for (size_t i = 0; i < n; i++) ok_minmax = ok_minmax && out[i] == max(a[i], b[i]);
+
+        abs_array(a, out, n);
+        for (size_t i = 0; i < n; i++) ok_unary = ok_unary && out[i] == abs_val(a[i]);
+        sign_array(a, out, n);
+        for (size_t i = 0; i < n; i++) ok_unary = ok_unary && out[i] == sign(a[i]);
+        // Both the usual bounds and inverted ones, where clamp returns min
+        // below min and max everywhere else
+        for (int k = 0; k < 2; k++) {
+            int lo = k ? 500 : -1000, hi = k ? -500 : 1000;
+            for (size_t i = 0; i < n; i++) inplace[i] = a[i];
+            clamp_array(inplace, n, lo, hi);
+            for (size_t i = 0; i < n; i++) ok_unary = ok_unary && inplace[i] == clamp(a[i], lo, hi);
+        }
+    }
+
+    // Checked kernels report overflow only when some element overflows
+    int x[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 }, y[9] = { 1, 1, 1, 1, 1, 1, 1, 1, 1 };
+    ok_add = ok_add && add_checked_array(x, y, out, 9) == 0 && out[8] == 10;
+    x[3] = INT_MAX;
+    ok_add = ok_add && add_checked_array(x, y, out, 9) == -1 && out[3] == INT_MIN;
+    x[3] = 4;
+    x[8] = INT_MAX;
+    ok_mul = ok_mul && multiply_checked_array(x, y, out, 9) == 0;
+    y[8] = 2;
+    ok_mul = ok_mul && multiply_checked_array(x, y, out, 9) == -1 && out[8] == -2;
+
+    // Outputs may alias an input
+    for (int i = 0; i < N; i++) inplace[i] = a[i];
+    add_sat_array(inplace, b, inplace, N);
+    add_sat_array(a, b, out, N);
+    for (int i = 0; i < N; i++) ok_add = ok_add && inplace[i] == out[i];
+
+    test_result("add kernels", ok_add);
+    test_result("multiply kernels", ok_mul);
+    test_result("min/max kernels", ok_minmax);
+    test_result("abs/sign/clamp kernels", ok_unary);
+    free(a);
+    free(b);
+    free(out);
+    free(inplace);
+}
+
+int main() {
+    printf("Running math_utils tests...\n\n");
+
+    test_scalar();
+    test_batch();
+
+    printf("\nTests completed: %d passed, %d failed\n",
+           test_passed, test_count - test_passed);
+    return test_passed == test_count ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+// test_num_utils.c - Tests for num_utils
+#include "num_utils.h"
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Test utility functions
+int test_count = 0;
+int test_passed = 0;
+
+void test_result(const char *test_name, int success) {
+    test_count++;
+    if (success) {
+        test_passed++;
+        printf("✓ %s\n", test_name);
+    } else {
+        printf("✗ %s\n", test_name);
+    }
+}
+
+// Simple deterministic generator for the randomized checks
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t next_rand(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// Reference: number of significant digits in the shortest round-trip %e
+static int shortest_digits(double v) {
+    char tmp[40];
+    for (int prec = 1; prec < 17; prec++) {
+        snprintf(tmp, sizeof(tmp), "%.*e", prec - 1, v);
+        if (strtod(tmp, NULL) == v) return prec;
+    }
+    return 17;
+}
+
+// Counts significant digits in our output
+static int count_sig_digits(const char *s) {
+    int n = 0, started = 0, trailing = 0;
+    for (; *s && *s != 'e'; s++) {
+        if (*s < '0' || *s > '9') continue;
+        if (*s != '0') started = 1;
+        if (!started) continue;
+        n++;
+        trailing = *s == '0' ? trailing + 1 : 0;
+    }
+    return n - trailing;
+}
+
+// Test integer formatting against printf
+void test_format_int() {
+    char buf[NUM_INT_BUFSIZE], ref[32];
+    int ok = 1;
+    num_format_u64(UINT64_MAX, buf);
+    ok = ok && strcmp(buf, "18446744073709551615") == 0;
+    ok = ok && num_format_i64(INT64_MIN, buf) == 20 && strcmp(buf, "-9223372036854775808") == 0;
+    ok = ok && num_format_u64(0, buf) == 1 && strcmp(buf, "0") == 0;
+    for (int i = 0; i < 100000 && ok; i++) {
+        int64_t v = (int64_t)(next_rand() >> (next_rand() % 64));
+        if (i & 1) v = -v;
+        num_format_i64(v, buf);
+        snprintf(ref, sizeof(ref), "%" PRId64, v);
+        ok = strcmp(buf, ref) == 0;
+    }
+    char wide[32];
+    ok = ok && num_format_u64_padded(42, wide, 6, ' ') == 6 && strcmp(wide, "    42") == 0;
+    ok = ok && num_format_u64_padded(7, wide, 3, '0') == 3 && strcmp(wide, "007") == 0;
+    ok = ok && num_format_u64_padded(1234567, wide, 6, ' ') == 7 && strcmp(wide, "1234567") == 0;
+    test_result("format_int", ok);
+}
+
+// Test integer parsing, including the 8-digit blocks and overflow
+void test_parse_int() {
+    int64_t v;
+    uint64_t u;
+    int i32;
+    size_t used;
+    int ok = num_parse_i64("-9223372036854775808", 20, &v, &used) == NUM_OK && v == INT64_MIN && used == 20;
+    ok = ok && num_parse_i64("9223372036854775808", 19, &v, NULL) == NUM_ERANGE;
+    ok = ok && num_parse_u64("18446744073709551615x", 21, &u, &used) == NUM_OK && u == UINT64_MAX && used == 20;
+    ok = ok && num_parse_u64("18446744073709551616", 20, &u, NULL) == NUM_ERANGE;
+    ok = ok && num_parse_u64("000000000000000000000000042", 27, &u, NULL) == NUM_OK && u == 42;
+    ok = ok && num_parse_i64("+12,34", 6, &v, &used) == NUM_OK && v == 12 && used == 3;
+    ok = ok && num_parse_i64("123456789", 4, &v, &used) == NUM_OK && v == 1234 && used == 4;
+    ok = ok && num_parse_i64("-", 1, &v, NULL) == NUM_EINVAL;
+    ok = ok && num_parse_i64(" 1", 2, &v, NULL) == NUM_EINVAL;
+    ok = ok && num_parse_u64("-1", 2, &u, NULL) == NUM_EINVAL;
+    ok = ok && num_parse_int("-2147483648", 11, &i32, NULL) == NUM_OK && i32 == -2147483647 - 1;
+    ok = ok && num_parse_int("2147483648", 10, &i32, NULL) == NUM_ERANGE;
+    char buf[NUM_INT_BUFSIZE];
+    for (int i = 0; i < 100000 && ok; i++) {
+        int64_t x = (int64_t)next_rand() >> (next_rand() % 64);
+        size_t n = num_format_i64(x, buf);
+        ok = num_parse_i64(buf, n, &v, &used) == NUM_OK && v == x && used == n;
+    }
+    test_result("parse_int", ok);
+}
+
+// Test shortest double formatting: round-trip and digit count
+void test_format_double() {
+    char buf[NUM_DOUBLE_BUFSIZE];
+    struct { double v; const char *s; } cases[] = {
+        {0.1, "0.1"}, {0.1 + 0.2, "0.30000000000000004"}, {1.5, "1.5"},
+        {100, "100"}, {-0.0, "-0"}, {1e21, "1e21"}, {1e16, "10000000000000000"},
+        {123456.789, "123456.789"}, {1e-5, "0.00001"}, {1.25e-6, "1.25e-6"},
+        {5e-324, "5e-324"}, {1.7976931348623157e308, "1.7976931348623157e308"},
+        {-2.5, "-2.5"}, {INFINITY, "inf"}, {-INFINITY, "-inf"},
+    };
+    int ok = 1;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        size_t n = num_format_double(cases[i].v, buf);
+        if (strcmp(buf, cases[i].s) != 0 || n != strlen(buf)) {
+            printf("  %.17g formatted as %s\n", cases[i].v, buf);
+            ok = 0;
+        }
+    }
+    ok = ok && num_format_double(NAN, buf) == 3 && strcmp(buf, "nan") == 0;
+    for (int i = 0; i < 200000 && ok; i++) {
+        double v;
+        if (i & 1) {
+            uint64_t bits = next_rand();
+            memcpy(&v, &bits, sizeof(v));
+            if (!isfinite(v)) continue;
+        } else {
+            // Short decimals, the common case for real data
+            v = (double)(next_rand() % 1000000) / pow(10, (double)(next_rand() % 8));
+        }
+        num_format_double(v, buf);
+        double back = strtod(buf, NULL);
+        ok = memcmp(&back, &v, sizeof(v)) == 0 && count_sig_digits(buf) <= shortest_digits(fabs(v));
+        if (!ok) printf("  %.17g formatted as %s\n", v, buf);
+    }
+    test_result("format_double", ok);
+}
+
+// Test double parsing against strtod
+void test_parse_double() {
+    double d;
+    size_t used;
+    int ok = num_parse_double("3.25xyz", 7, &d, &used) == NUM_OK && d == 3.25 && used == 4;
+    ok = ok && num_parse_double("1e", 2, &d, &used) == NUM_OK && d == 1 && used == 1;
+    ok = ok && num_parse_double(".5", 2, &d, NULL) == NUM_OK && d == 0.5;
+    ok = ok && num_parse_double("5.", 2, &d, &used) == NUM_OK && d == 5 && used == 2;
+    ok = ok && num_parse_double(".", 1, &d, NULL) == NUM_EINVAL;
+    ok = ok && num_parse_double("-", 1, &d, NULL) == NUM_EINVAL;
+    ok = ok && num_parse_double(" 1", 2, &d, NULL) == NUM_EINVAL;
+    ok = ok && num_parse_double("1e999", 5, &d, NULL) == NUM_ERANGE;
+    ok = ok && num_parse_double("-inf", 4, &d, &used) == NUM_OK && isinf(d) && d < 0 && used == 4;
+    ok = ok && num_parse_double("nan", 3, &d, NULL) == NUM_OK && isnan(d);
+    ok = ok && num_parse_double("0x10", 4, &d, &used) == NUM_OK && d == 0 && used == 1;
+    ok = ok && num_parse_double("12345678901234567890123e-3", 26, &d, NULL) == NUM_OK &&
+         d == 12345678901234567890.123;
+    ok = ok && num_parse_double("9007199254740993", 16, &d, NULL) == NUM_OK && d == 9007199254740992.0;
+    ok = ok && num_parse_double("123e30", 6, &d, NULL) == NUM_OK && d == 123e30;
+    char buf[64];
+    for (int i = 0; i < 200000 && ok; i++) {
+        int n;
+        switch (i % 3) {
+        case 0:
+            n = snprintf(buf, sizeof(buf), "%.*g", (int)(next_rand() % 20) + 1,
+                         (double)(int64_t)next_rand() * pow(10, (double)((int)(next_rand() % 80) - 40)));
+            break;
+        case 1:
+            n = snprintf(buf, sizeof(buf), "%" PRIu64 ".%" PRIu64, next_rand() % 100000, next_rand() % 1000);
+            break;
+        default:
+            n = snprintf(buf, sizeof(buf), "%" PRIu64 "e%d", next_rand() >> (next_rand() % 64),
+                         (int)(next_rand() % 700) - 350);
+            break;
+        }
+        char *end;
+        double ref = strtod(buf, &end);
+        int rc = num_parse_double(buf, (size_t)n, &d, &used);
+        ok = (rc == NUM_OK || (rc == NUM_ERANGE && isinf(ref))) && d == ref && used == (size_t)(end - buf);
+        if (!ok) printf("  %s parsed as %.17g\n", buf, d);
+    }
+    test_result("parse_double", ok);
+}
+
+int main() {
+    printf("Running num_utils tests...\n\n");
+
+    test_format_int();
+    test_parse_int();
+    test_format_double();
+    test_parse_double();
+
+    printf("\nTests completed: %d passed, %d failed\n",
+           test_passed, test_count - test_passed);
+    return test_passed == test_count ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+// test_quantile_utils.c - Tests for quantile_utils
+#include "quantile_utils.h"
+#include "array_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Test utility functions
+int test_count = 0;
+int test_passed = 0;
+
+void test_result(const char *test_name, int success) {
+    test_count++;
+    if (success) {
+        test_passed++;
+        printf("✓ %s\n", test_name);
+    } else {
+        printf("✗ %s\n", test_name);
+    }
+}
+
+static uint64_t rng_state = 88172645463325252ULL;
+
+// Latency-like samples: mostly small, with a long tail
+static int next_sample(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    int base = (int)(rng_state % 1000);
+    return rng_state >> 60 == 0 ? base * (int)(rng_state >> 40 & 0xffff) : base;
+}
+
+// Exact quantile of a sorted array, using the same rank convention
+static int exact(const int *sorted, size_t n, double q) {
+    size_t r = (size_t)(q * (double)n);
+    return sorted[r < n ? r : n - 1];
+}
+
+static const double qs[] = {0.01, 0.25, 0.5, 0.9, 0.99, 0.999};
+
+// Test histogram quantiles stay within the relative error bound, and that
+// merging per-thread histograms equals one histogram of everything
+void test_hist() {
+    enum { N = 200000 };
+    int *arr = malloc(N * sizeof(int)), *sorted = malloc(N * sizeof(int));
+    for (size_t i = 0; i < N; i++) sorted[i] = arr[i] = next_sample();
+    array_radix_sort_i32(sorted, N);
+    quantile_hist whole, parts[4];
+    int ok = quantile_hist_init(&whole, 7) == 0;
+    quantile_hist_add_array(&whole, arr, N);
+    for (int t = 0; t < 4; t++) {
+        ok = ok && quantile_hist_init(&parts[t], 7) == 0;
+        for (size_t i = t; i < N; i += 4) quantile_hist_add(&parts[t], arr[i]);
+        if (t > 0) ok = ok && quantile_hist_merge(&parts[0], &parts[t]) == 0;
+    }
+    for (size_t i = 0; i < sizeof(qs) / sizeof(qs[0]) && ok; i++) {
+        int64_t a, b;
+        int want = exact(sorted, N, qs[i]);
+        ok = quantile_hist_value(&whole, qs[i], &a) == 0 && quantile_hist_value(&parts[0], qs[i], &b) == 0;
+        ok = ok && a == b && llabs(a - want) <= want / 256 + 1;
+    }
+    int64_t v;
+    ok = ok && quantile_hist_value(&whole, 0, &v) == 0 && v == sorted[0];
+    ok = ok && quantile_hist_value(&whole, 1, &v) == 0 && v == sorted[N - 1];
+    // Negative values land in the zero bucket; extremes stay exact
+    quantile_hist_clear(&whole);
+    ok = ok && quantile_hist_value(&whole, 0.5, &v) == -1;
+    quantile_hist_add(&whole, -5);
+    quantile_hist_add_n(&whole, INT64_MAX, 3);
+    ok = ok && quantile_hist_value(&whole, 0, &v) == 0 && v == -5;
+    ok = ok && quantile_hist_value(&whole, 0.9, &v) == 0 && v >= INT64_MAX - INT64_MAX / 128;
+    quantile_hist_free(&parts[1]);
+    ok = ok && quantile_hist_init(&parts[1], 9) == 0 && quantile_hist_merge(&parts[0], &parts[1]) == -1;
+    quantile_hist_free(&whole);
+    for (int t = 0; t < 4; t++) quantile_hist_free(&parts[t]);
+    free(arr);
+    free(sorted);
+    test_result("histogram", ok);
+}
+
+// Test sketch quantiles land within the rank error bound, memory stays
+// bounded, and merged sketches are as accurate as one
+void test_sketch() {
+    enum { N = 1000000 };
+    int *arr = malloc(N * sizeof(int)), *sorted = malloc(N * sizeof(int));
+    for (size_t i = 0; i < N; i++) sorted[i] = arr[i] = next_sample();
+    array_radix_sort_i32(sorted, N);
+    quantile_sketch whole, parts[4];
+    int ok = quantile_sketch_init(&whole, 200) == 0 && quantile_sketch_add_array(&whole, arr, N) == 0;
+    ok = ok && whole.n == N && whole.retained < 4 * 200;
+    for (int t = 0; t < 4; t++) ok = quantile_sketch_init(&parts[t], 200) == 0 && ok;
+    for (int t = 0; t < 4 && ok; t++) {
+        for (size_t i = t; i < N && ok; i += 4) ok = quantile_sketch_add(&parts[t], arr[i]) == 0;
+        if (t > 0) ok = ok && quantile_sketch_merge(&parts[0], &parts[t]) == 0;
+    }
+    ok = ok && parts[0].n == N && parts[0].retained < 4 * 200;
+    for (size_t i = 0; i < sizeof(qs) / sizeof(qs[0]) && ok; i++) {
+        for (int which = 0; which < 2 && ok; which++) {
+            int64_t v;
+            ok = quantile_sketch_value(which ? &parts[0] : &whole, qs[i], &v) == 0;
+            // Rank of v in the data must be within 2% of the target rank
+            size_t lo = array_lower_bound_i32(sorted, N, (int32_t)v);
+            size_t hi = array_upper_bound_i32(sorted, N, (int32_t)v);
+            double target = qs[i] * N, slack = 0.02 * N;
+            ok = ok && lo <= target + slack && hi + slack >= target;
+        }
+    }
+    int64_t v;
+    ok = ok && quantile_sketch_value(&whole, 0, &v) == 0 && v == sorted[0];
+    ok = ok && quantile_sketch_value(&whole, 1, &v) == 0 && v == sorted[N - 1];
+    quantile_sketch_free(&whole);
+    ok = ok && quantile_sketch_init(&whole, 100) == 0 && quantile_sketch_value(&whole, 0.5, &v) == -1;
+    ok = ok && quantile_sketch_merge(&whole, &parts[0]) == -1;
+    ok = ok && quantile_sketch_init(&whole, 4) == -1;
+    for (int t = 0; t < 4; t++) quantile_sketch_free(&parts[t]);
+    free(arr);
+    free(sorted);
+    test_result("sketch", ok);
+}
+
+int main() {
+    printf("Running quantile_utils tests...\n\n");
+
+    test_hist();
+    test_sketch();
+
+    printf("\nTests completed: %d passed, %d failed\n",
+           test_passed, test_count - test_passed);
+    return test_passed == test_count ? 0 : 1;
+}
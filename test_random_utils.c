@@ -0,0 +1,192 @@
+// test_random_utils.c - Tests for random_utils
+#include "random_utils.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Test utility functions
+int test_count = 0;
+int test_passed = 0;
+
+void test_result(const char *test_name, int success) {
+    test_count++;
+    if (success) {
+        test_passed++;
+        printf("✓ %s\n", test_name);
+    } else {
+        printf("✗ %s\n", test_name);
+    }
+}
+
+void test_xoshiro() {
+    // Reference outputs of xoshiro256** from the state {1, 2, 3, 4}
+    random_xoshiro r = { { 1, 2, 3, 4 } }, a, b;
+    int ok = random_xoshiro_next(&r) == 11520 && random_xoshiro_next(&r) == 0 &&
+             random_xoshiro_next(&r) == 1509978240 && random_xoshiro_next(&r) == 1215971899390074240ULL;
+
+    // Jumps commute with stepping, and streams start where the jumps say
+    random_xoshiro_seed(&a, 7);
+    b = a;
+    random_xoshiro_jump(&a);
+    random_xoshiro_next(&a);
+    random_xoshiro_next(&b);
+    random_xoshiro_jump(&b);
+    for (int i = 0; i < 4; i++) ok = ok && a.s[i] == b.s[i];
+    random_xoshiro_seed(&a, 7);
+    random_xoshiro_jump(&a);
+    random_xoshiro_jump(&a);
+    random_xoshiro_stream(&b, 7, 2);
+    for (int i = 0; i < 4; i++) ok = ok && a.s[i] == b.s[i];
+    random_xoshiro_long_jump(&a);
+    ok = ok && random_xoshiro_next(&a) != random_xoshiro_next(&b);
+    random_xoshiro_seed(&a, 0);
+    ok = ok && (a.s[0] | a.s[1] | a.s[2] | a.s[3]) != 0;
+    test_result("xoshiro256** sequence and jumps", ok);
+}
+
+void test_pcg32() {
+    // First outputs of the reference pcg32-demo (seed 42, stream 54)
+    static const uint32_t expect[6] = {
+        0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b, 0xcbed606e
+    };
+    random_pcg32 r, s;
+    int ok = 1;
+    random_pcg32_seed(&r, 42, 54);
+    for (int i = 0; i < 6; i++) ok = ok && random_pcg32_next(&r) == expect[i];
+
+    // Advancing matches stepping, and wraps around the period
+    random_pcg32_seed(&r, 1, 2);
+    s = r;
+    for (int i = 0; i < 1000; i++) random_pcg32_next(&r);
+    random_pcg32_advance(&s, 1000);
+    ok = ok && r.state == s.state;
+    random_pcg32_advance(&s, (uint64_t)0 - 1000);
+    random_pcg32_seed(&r, 1, 2);
+    ok = ok && r.state == s.state;
+    test_result("pcg32 sequence and advance", ok);
+}
+
+void test_bounded() {
+    random_xoshiro r;
+    random_pcg32 p;
+    int counts[6] = { 0 }, ok = 1;
+    random_xoshiro_seed(&r, 12345);
+    random_pcg32_seed(&p, 12345, 1);
+
+    // Plain modulo would put half of these below 2^30 instead of a third
+    uint32_t bound = 3u << 30;
+    int low_x = 0, low_p = 0;
+    for (int i = 0; i < 300000; i++) {
+        uint64_t x = random_xoshiro_bounded(&r, bound);
+        uint32_t y = random_pcg32_bounded(&p, bound);
+        ok = ok && x < bound && y < bound;
+        low_x += x < (1u << 30);
+        low_p += y < (1u << 30);
+    }
+    ok = ok && abs(low_x - 100000) < 1500 && abs(low_p - 100000) < 1500;
+
+    // Chi-square over a die, 5 degrees of freedom (p = 0.001 at 20.5)
+    for (int i = 0; i < 60000; i++) counts[random_xoshiro_range(&r, 1, 6) - 1]++;
+    double chi2 = 0;
+    for (int i = 0; i < 6; i++) chi2 += (counts[i] - 10000.0) * (counts[i] - 10000.0) / 10000.0;
+    ok = ok && chi2 < 20.5;
+
+    int lo = 0, hi = 0;
+    for (int i = 0; i < 1000; i++) {
+        int v = random_xoshiro_range(&r, -2147483647 - 1, 2147483647);
+        lo |= v < 0;
+        hi |= v > 0;
+        ok = ok && random_xoshiro_range(&r, 5, 5) == 5;
+        double d = random_xoshiro_double(&r);
+        ok = ok && d >= 0 && d < 1;
+    }
+    ok = ok && lo && hi && random_xoshiro_bounded(&r, 0) == 0 && random_pcg32_bounded(&p, 0) == 0;
+    test_result("bounded ranges", ok);
+}
+
+void test_fill() {
+    enum { N = 4099 };
+    uint64_t *u = malloc(N * sizeof(uint64_t));
+    double *d = malloc(N * sizeof(double));
+    int *v = malloc(N * sizeof(int));
+    random_xoshiro r, r2;
+    int ok = 1;
+    random_xoshiro_seed(&r, 99);
+
+    // Every length gives a prefix of the same sequence from the same state
+    for (size_t n = 0; n <= N; n = n < 20 ? n + 1 : n * 4 + 3) {
+        r2 = r;
+        random_fill_u64(&r2, u, N);
+        uint64_t first = u[0], last = n ? u[n - 1] : 0;
+        r2 = r;
+        random_fill_u64(&r2, u, n);
+        ok = ok && (n == 0 || (u[0] == first && u[n - 1] == last));
+    }
+
+    random_fill_double(&r, d, N);
+    double sum = 0;
+    for (int i = 0; i < N; i++) {
+        ok = ok && d[i] >= 0 && d[i] < 1;
+        sum += d[i];
+    }
+    ok = ok && sum / N > 0.48 && sum / N < 0.52;
+
+    // Ranges with heavy rejection, one value, and the full int range
+    static const int ranges[][2] = { { -3, 3 }, { 0, 0 }, { 0, (int)(3u << 29) }, { -2147483647 - 1, 2147483647 } };
+    for (int k = 0; k < 4; k++) {
+        int lo = ranges[k][0], hi = ranges[k][1];
+        long long s = 0;
+        ok = ok && random_fill_int(&r, v, N, lo, hi) == 0;
+        for (int i = 0; i < N; i++) {
+            ok = ok && v[i] >= lo && v[i] <= hi;
+            s += v[i];
+        }
+        double mean = (double)s / N, mid = ((double)lo + hi) / 2, width = (double)hi - lo + 1;
+        ok = ok && mean > mid - width * 0.03 && mean < mid + width * 0.03;
+    }
+    int hits[7] = { 0 };
+    random_fill_int(&r, v, N, -3, 3);
+    for (int i = 0; i < N; i++) hits[v[i] + 3]++;
+    for (int i = 0; i < 7; i++) ok = ok && hits[i] > N / 7 - 100 && hits[i] < N / 7 + 100;
+    ok = ok && random_fill_int(&r, v, N, 1, 0) == -1;
+    test_result("bulk fills", ok);
+    free(u);
+    free(d);
+    free(v);
+}
+
+static void *thread_first_output(void *arg) {
+    random_xoshiro *r = random_thread_rng();
+    uint64_t *out = arg;
+    out[0] = random_xoshiro_next(r);
+    out[1] = random_thread_rng() == r;
+    return NULL;
+}
+
+void test_thread_streams() {
+    pthread_t threads[4];
+    uint64_t out[4][2];
+    random_set_seed(2024);
+    for (int i = 0; i < 4; i++) pthread_create(&threads[i], NULL, thread_first_output, out[i]);
+    for (int i = 0; i < 4; i++) pthread_join(threads[i], NULL);
+    int ok = 1;
+    for (int i = 0; i < 4; i++) {
+        ok = ok && out[i][1];
+        for (int j = 0; j < i; j++) ok = ok && out[i][0] != out[j][0];
+    }
+    test_result("per-thread streams", ok);
+}
+
+int main() {
+    printf("Running random_utils tests...\n\n");
+
+    test_xoshiro();
+    test_pcg32();
+    test_bounded();
+    test_fill();
+    test_thread_streams();
+
+    printf("\nTests completed: %d passed, %d failed\n",
+           test_passed, test_count - test_passed);
+    return test_passed == test_count ? 0 : 1;
+}
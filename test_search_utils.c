@@ -0,0 +1,140 @@
+// test_search_utils.c - Tests for search_utils
+#include "search_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+// Test utility functions
+int test_count = 0;
+int test_passed = 0;
+
+void test_result(const char *test_name, int success) {
+    test_count++;
+    if (success) {
+        test_passed++;
+        printf("✓ %s\n", test_name);
+    } else {
+        printf("✗ %s\n", test_name);
+    }
+}
+
+typedef struct {
+    size_t ids[32];
+    size_t ends[32];
+    int n;
+} match_log;
+
+static int record_match(void *ctx, size_t id, size_t end) {
+    match_log *log = ctx;
+    if (log->n < 32) {
+        log->ids[log->n] = id;
+        log->ends[log->n] = end;
+    }
+    log->n++;
+    return 0;
+}
+
+// Test the classic overlapping he/she/his/hers example
+void test_ac_overlapping() {
+    str_view pats[] = {SV_LIT("he"), SV_LIT("she"), SV_LIT("his"), SV_LIT("hers")};
+    ac_automaton *ac = ac_build(pats, 4, 0);
+    match_log log = {{0}, {0}, 0};
+    ac_cursor cur;
+    ac_cursor_init(&cur);
+    size_t n = ac_scan(ac, &cur, "ushers", 6, record_match, &log);
+    // "she" and "he" end at 4, "hers" ends at 6
+    int ok = ac && n == 3 && log.n == 3;
+    ok = ok && log.ends[0] == 4 && log.ends[1] == 4 && log.ends[2] == 6;
+    ok = ok && ((log.ids[0] == 1 && log.ids[1] == 0) || (log.ids[0] == 0 && log.ids[1] == 1));
+    ok = ok && log.ids[2] == 3;
+    ac_free(ac);
+    test_result("ac_overlapping", ok);
+}
+
+// Test chunked input, case folding and duplicate patterns
+void test_ac_stream_nocase() {
+    str_view pats[] = {SV_LIT("ERROR"), SV_LIT("timeout"), SV_LIT("error"), SV_LIT("")};
+    ac_automaton *ac = ac_build(pats, 4, AC_NOCASE);
+    const char *text = "ok; Error: TimeOut while reading; ok";
+    match_log log = {{0}, {0}, 0};
+    ac_cursor cur;
+    ac_cursor_init(&cur);
+    size_t total = 0;
+    // Feed 3 bytes at a time so matches cross chunk boundaries
+    for (size_t i = 0; i < strlen(text); i += 3) {
+        size_t len = strlen(text) - i < 3 ? strlen(text) - i : 3;
+        total += ac_scan(ac, &cur, text + i, len, record_match, &log);
+    }
+    int ok = ac && total == 3 && log.ends[0] == 9 && log.ends[2] == 18;
+    ok = ok && log.ids[2] == 1 && log.ids[0] + log.ids[1] == 2;
+
+    ac_cursor_init(&cur);
+    ok = ok && ac_scan(ac, &cur, "nothing here", 12, NULL, NULL) == 0;
+    ac_free(ac);
+    test_result("ac_stream_nocase", ok);
+}
+
+static int stop_first(void *ctx, size_t id, size_t end) {
+    (void)id;
+    *(size_t *)ctx = end;
+    return 1;
+}
+
+// Test that a callback can stop the scan
+void test_ac_stop() {
+    str_view pats[] = {SV_LIT("ab")};
+    ac_automaton *ac = ac_build(pats, 1, 0);
+    ac_cursor cur;
+    ac_cursor_init(&cur);
+    size_t end = 0;
+    size_t n = ac_scan(ac, &cur, "xxabxxab", 8, stop_first, &end);
+    int ok = n == 1 && end == 4 && cur.offset == 4;
+    n = ac_scan(ac, &cur, "xxab", 4, NULL, NULL);
+    ok = ok && n == 1;
+    ac_free(ac);
+    test_result("ac_stop", ok);
+}
+
+// Test that the prefiltered buffer scan finds the same matches as the DFA
+void test_ac_scan_buffer() {
+    char text[4000];
+    unsigned seed = 1;
+    for (int i = 0; i < 4000; i++) {
+        seed = seed * 1103515245 + 12345;
+        text[i] = (char)('a' + (seed >> 16) % 4);
+    }
+    int ok = 1;
+    for (int plen = 1; plen <= 5 && ok; plen++) {
+        str_view pats[6];
+        for (int p = 0; p < 6; p++) pats[p] = sv_make(text + 100 * p + p, plen + p % 3);
+        for (int flags = 0; flags <= AC_NOCASE; flags++) {
+            ac_automaton *ac = ac_build(pats, 6, flags);
+            ac_cursor cur;
+            ac_cursor_init(&cur);
+            size_t dfa = ac_scan(ac, &cur, text, sizeof(text), NULL, NULL);
+            size_t buf = ac_scan_buffer(ac, text, sizeof(text), NULL, NULL);
+            ok = ok && ac && dfa > 0 && dfa == buf;
+            ac_free(ac);
+        }
+    }
+    str_view one[] = {SV_LIT("needle")};
+    ac_automaton *ac = ac_build(one, 1, AC_NOCASE);
+    match_log log = {{0}, {0}, 0};
+    ok = ok && ac_scan_buffer(ac, "a NEEDLE, a needle", 18, record_match, &log) == 2;
+    ok = ok && log.ends[0] == 8 && log.ends[1] == 18;
+    ok = ok && ac_scan_buffer(ac, "needl", 5, NULL, NULL) == 0;
+    ac_free(ac);
+    test_result("ac_scan_buffer", ok);
+}
+
+int main() {
+    printf("Running search_utils tests...\n\n");
+
+    test_ac_overlapping();
+    test_ac_stream_nocase();
+    test_ac_stop();
+    test_ac_scan_buffer();
+
+    printf("\nTests completed: %d passed, %d failed\n",
+           test_passed, test_count - test_passed);
+    return test_passed == test_count ? 0 : 1;
+}
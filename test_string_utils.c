@@ -1,7 +1,322 @@
+// test_string_utils.c - Tests for string_utils
 #include "string_utils.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Test utility functions
+int test_count = 0;
+int test_passed = 0;
+
+void test_result(const char *test_name, int success) {
+    test_count++;
+    if (success) {
+        test_passed++;
+        printf("✓ %s\n", test_name);
+    } else {
+        printf("✗ %s\n", test_name);
+    }
+}
+
+// Test view search and comparison
+void test_sv_find_compare() {
+    str_view v = sv_from_cstr("hello, world");
+    int ok = sv_find(v, 'o') == 4 && sv_rfind(v, 'o') == 8 && sv_find(v, 'z') == SV_NPOS;
+    ok = ok && sv_find_view(v, SV_LIT("world")) == 7;
+    ok = ok && sv_find_view(v, SV_LIT("worlds")) == SV_NPOS;
+    ok = ok && sv_find_view(v, SV_LIT("")) == 0;
+    ok = ok && sv_count_char(v, 'l') == 3;
+    ok = ok && sv_compare(SV_LIT("abc"), SV_LIT("abd")) < 0;
+    ok = ok && sv_compare(SV_LIT("ab"), SV_LIT("abc")) < 0;
+    ok = ok && sv_compare(SV_LIT("abc"), SV_LIT("abc")) == 0;
+    ok = ok && sv_equal(sv_substr(v, 7, 100), SV_LIT("world"));
+    test_result("sv_find_compare", ok);
+}
+
+// Test prefix/suffix checks and stripping
+void test_sv_affix_strip() {
+    str_view v = SV_LIT("  report.txt \n");
+    str_view s = sv_strip(v);
+    int ok = sv_equal(s, SV_LIT("report.txt"));
+    ok = ok && sv_starts_with(s, SV_LIT("rep")) && !sv_starts_with(s, SV_LIT("txt"));
+    ok = ok && sv_ends_with(s, SV_LIT(".txt")) && !sv_ends_with(s, SV_LIT("report.txt.gz"));
+    ok = ok && sv_strip(SV_LIT(" \t ")).len == 0;
+    ok = ok && v.data[0] == ' ';
+    test_result("sv_affix_strip", ok);
+}
+
+// Test splitting into fields
+void test_sv_split() {
+    str_view rest = SV_LIT("a,bb,,c,");
+    const char *expected[] = {"a", "bb", "", "c", ""};
+    str_view field;
+    int n = 0, ok = 1;
+    while (sv_split(&rest, ',', &field)) {
+        ok = ok && n < 5 && sv_equal(field, sv_from_cstr(expected[n]));
+        n++;
+    }
+    char buf[4];
+    sv_to_cstr(SV_LIT("truncate"), buf, sizeof(buf));
+    test_result("sv_split", ok && n == 5 && str_compare(buf, "tru") == 0);
+}
+
+// Test builder appends, growth and detach
+void test_str_builder() {
+    str_builder sb;
+    sb_init(&sb);
+    sb_append(&sb, "id=");
+    sb_append_int(&sb, -42);
+    sb_append_char(&sb, ' ');
+    sb_append_pad_left(&sb, SV_LIT("7"), 3, '0');
+    sb_append_char(&sb, '|');
+    sb_append_pad_right(&sb, SV_LIT("ab"), 4, '.');
+    sb_append_uint(&sb, 18446744073709551615ULL);
+    int ok = str_compare(sb_cstr(&sb), "id=-42 007|ab..18446744073709551615") == 0;
+    ok = ok && sb.data == sb.inline_buf;
+
+    sb_clear(&sb);
+    for (int i = 0; i < 1000; i++) sb_append_repeat(&sb, 'x', 10);
+    ok = ok && sb.len == 10000 && sb.data[9999] == 'x' && sb.data[10000] == '\0';
+    ok = ok && sb.cap < 20000 * 2;
+
+    size_t len;
+    char *heap_data = sb.data;
+    char *out = sb_detach(&sb, &len);
+    ok = ok && out == heap_data && len == 10000 && sb.len == 0;
+    free(out);
+
+    sb_append(&sb, "small");
+    out = sb_detach(&sb, NULL);
+    ok = ok && str_compare(out, "small") == 0;
+    free(out);
+    sb_free(&sb);
+    test_result("str_builder", ok);
+}
+
+// Test substring search, including SIMD block and tail paths
+void test_substring_search() {
+    char hay[200];
+    for (int i = 0; i < 199; i++) hay[i] = 'a' + i % 7;
+    hay[199] = '\0';
+    int ok = str_find_str("hello world", "o w") != NULL;
+    ok = ok && str_find_str("hello world", "world!") == NULL;
+    const char *greeting = "Hello WORLD";
+    ok = ok && str_find_str_nocase(greeting, "lo wOr") == greeting + 3;
+    // Brute-force cross-check at every offset and length
+    for (int len = 1; len <= 12 && ok; len++) {
+        for (int pos = 0; pos + len <= 199 && ok; pos += 5) {
+            str_view needle = sv_make(hay + pos, len);
+            size_t expect = SV_NPOS;
+            for (int i = 0; i + len <= 199; i++) {
+                if (sv_equal(sv_make(hay + i, len), needle)) {
+                    expect = i;
+                    break;
+                }
+            }
+            ok = sv_find_view(sv_make(hay, 199), needle) == expect;
+        }
+    }
+    ok = ok && sv_find_view_nocase(SV_LIT("xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxFooBar"), SV_LIT("FOOBAR")) == 40;
+    ok = ok && sv_find_view_nocase(SV_LIT("a[b"), SV_LIT("{")) == SV_NPOS;
+    test_result("substring_search", ok);
+}
+
+// Test the zero-copy split iterators
+void test_splitter() {
+    str_splitter it;
+    str_view f;
+    str_delims d;
+    str_delims_init(&d, ",;");
+    const char *csv = "a,b;;c,";
+    const char *fields[] = {"a", "b", "", "c", ""};
+    int n = 0, ok = 1;
+    str_split_init(&it, sv_from_cstr(csv), &d, 0);
+    while (str_split_next(&it, &f)) ok = ok && n < 5 && sv_equal(f, sv_from_cstr(fields[n++]));
+    ok = ok && n == 5;
+
+    n = 0;
+    str_split_init(&it, sv_from_cstr(csv), &d, STR_SPLIT_SKIP_EMPTY);
+    while (str_split_next(&it, &f)) n++;
+    ok = ok && n == 3;
+
+    // Long enough to exercise the SIMD blocks; the input is never written
+    const char *text = "  alpha\tbeta\n\n gamma   delta-epsilon-zeta-eta-theta-iota-kappa  \r\n";
+    const char *words[] = {"alpha", "beta", "gamma", "delta-epsilon-zeta-eta-theta-iota-kappa"};
+    n = 0;
+    str_split_ws_init(&it, sv_from_cstr(text));
+    while (str_split_next(&it, &f)) ok = ok && n < 4 && sv_equal(f, sv_from_cstr(words[n++]));
+    ok = ok && n == 4;
+
+    str_delims_init(&d, "-");
+    str_view long_field = SV_LIT("0123456789012345678901234567890123456789-x");
+    ok = ok && str_delims_find(&d, long_field) == 40;
+    ok = ok && str_delims_skip(&d, SV_LIT("----------------------------------ab")) == 34;
+    str_delims_init(&d, "\xff");
+    ok = ok && !d.simd_ok && str_delims_find(&d, SV_LIT("0123456789012345678901234567890123\xff")) == 34;
+
+    const char *lines[] = {"one", "", "three", "four"};
+    n = 0;
+    str_split_lines_init(&it, SV_LIT("one\n\r\nthree\r\nfour"));
+    while (str_split_next(&it, &f)) ok = ok && n < 4 && sv_equal(f, sv_from_cstr(lines[n++]));
+    ok = ok && n == 4;
+    n = 0;
+    str_split_lines_init(&it, SV_LIT("x\ny\n"));
+    while (str_split_next(&it, &f)) n++;
+    test_result("splitter", ok && n == 2);
+}
+
+// Reference base64 encoder: one 6-bit group at a time
+static size_t ref_base64(const unsigned char *s, size_t n, char *d, int flags) {
+    const char *chars = flags & STR_BASE64_URL
+        ? "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+        : "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t len = 0;
+    for (size_t bit = 0; bit < n * 8; bit += 6) {
+        unsigned v = 0;
+        for (size_t b = bit; b < bit + 6; b++) {
+            v = v << 1 | (b < n * 8 ? (s[b / 8] >> (7 - b % 8)) & 1 : 0);
+        }
+        d[len++] = chars[v];
+    }
+    while (!(flags & STR_BASE64_NOPAD) && len % 4) d[len++] = '=';
+    return len;
+}
+
+// Test base64 against the reference, round trips, strictness and streaming
+void test_base64() {
+    unsigned char data[300], back[300];
+    char enc[420], ref[420];
+    unsigned seed = 99;
+    for (int i = 0; i < 300; i++) {
+        seed = seed * 1103515245 + 12345;
+        data[i] = (unsigned char)(seed >> 16);
+    }
+    int ok = 1;
+    int modes[] = {0, STR_BASE64_URL, STR_BASE64_NOPAD, STR_BASE64_URL | STR_BASE64_NOPAD};
+    for (int m = 0; m < 4 && ok; m++) {
+        int flags = modes[m];
+        for (size_t n = 0; n <= 300 && ok; n++) {
+            size_t len = str_base64_encode(data, n, enc, flags);
+            ok = len == ref_base64(data, n, ref, flags) && memcmp(enc, ref, len) == 0;
+            ok = ok && len == str_base64_encoded_len(n, flags);
+            size_t out;
+            ok = ok && str_base64_decode(enc, len, back, &out, flags) == 0 && out == n;
+            ok = ok && memcmp(back, data, n) == 0 && out <= str_base64_decoded_max(len);
+        }
+        // A bad character anywhere, including inside SIMD blocks, is rejected
+        size_t len = str_base64_encode(data, 300, enc, flags);
+        for (size_t i = 0; i < len && ok; i += 7) {
+            char saved = enc[i];
+            enc[i] = (flags & STR_BASE64_URL) ? '+' : (i % 2 ? '\xc3' : '_');
+            size_t out;
+            ok = str_base64_decode(enc, len, back, &out, flags) == -1;
+            enc[i] = saved;
+        }
+        // Streaming in uneven chunks matches the one-shot result
+        str_base64_encoder e;
+        str_base64_encoder_init(&e, flags);
+        size_t slen = 0;
+        for (size_t i = 0; i < 300; i += i % 5 + 1) {
+            size_t chunk = i % 5 + 1 < 300 - i ? i % 5 + 1 : 300 - i;
+            slen += str_base64_encode_update(&e, data + i, chunk, ref + slen);
+        }
+        slen += str_base64_encode_finish(&e, ref + slen);
+        ok = ok && slen == len && memcmp(ref, enc, len) == 0;
+        str_base64_decoder d;
+        str_base64_decoder_init(&d, flags);
+        size_t total = 0, out;
+        for (size_t i = 0; i < len && ok; i += 61) {
+            size_t chunk = len - i < 61 ? len - i : 61;
+            ok = str_base64_decode_update(&d, enc + i, chunk, back + total, &out) == 0;
+            total += out;
+        }
+        ok = ok && str_base64_decode_finish(&d, back + total, &out) == 0;
+        ok = ok && total + out == 300 && memcmp(back, data, 300) == 0;
+    }
+    // Every byte value inside a SIMD-sized block: only the alphabet decodes
+    size_t out;
+    for (int c = 0; c < 256 && ok; c++) {
+        for (int url = 0; url < 2 && ok; url++) {
+            memset(enc, 'A', 64);
+            enc[21] = (char)c;
+            const char *alpha = url ? "-_" : "+/";
+            int valid = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+                        c == alpha[0] || c == alpha[1];
+            int rc = str_base64_decode(enc, 64, back, &out, url ? STR_BASE64_URL : 0);
+            ok = rc == (valid ? 0 : -1);
+        }
+    }
+    ok = ok && str_base64_decode("Zm9vYg==", 8, back, &out, 0) == 0 && out == 4 && memcmp(back, "foob", 4) == 0;
+    ok = ok && str_base64_decode("Zm9vYg", 6, back, &out, 0) == -1;
+    ok = ok && str_base64_decode("Zm9vYg", 6, back, &out, STR_BASE64_NOPAD) == 0 && out == 4;
+    ok = ok && str_base64_decode("Zm9vYh==", 8, back, &out, 0) == -1;  // nonzero unused bits
+    ok = ok && str_base64_decode("Zm9=Zm9v", 8, back, &out, 0) == -1;  // padding mid-stream
+    ok = ok && str_base64_decode("Zg=a", 4, back, &out, 0) == -1;
+    ok = ok && str_base64_decode("Z===", 4, back, &out, 0) == -1;
+    ok = ok && str_base64_decode("Zm9v\n", 5, back, &out, 0) == -1;
+    str_base64_decoder d;
+    str_base64_decoder_init(&d, 0);
+    ok = ok && str_base64_decode_update(&d, "Zg==", 4, back, &out) == 0 && out == 1;
+    ok = ok && str_base64_decode_update(&d, "Zg==", 4, back, &out) == -1;
+    test_result("base64", ok);
+}
+
+// Test hex encoding and strict decoding, one-shot and streamed
+void test_hex() {
+    unsigned char data[200], back[200];
+    char enc[400];
+    for (int i = 0; i < 200; i++) data[i] = (unsigned char)(i * 37 + 11);
+    int ok = 1;
+    for (size_t n = 0; n <= 200 && ok; n++) {
+        int flags = n % 2 ? STR_HEX_UPPER : 0;
+        size_t len = str_hex_encode(data, n, enc, flags);
+        for (size_t i = 0; i < n && ok; i++) {
+            char two[3];
+            snprintf(two, sizeof(two), flags ? "%02X" : "%02x", data[i]);
+            ok = enc[2 * i] == two[0] && enc[2 * i + 1] == two[1];
+        }
+        ok = ok && len == 2 * n && str_hex_decode(enc, len, back) == 0;
+        ok = ok && memcmp(back, data, n) == 0;
+    }
+    size_t len = str_hex_encode(data, 200, enc, 0);
+    const char bad[] = {'g', 'G', '/', ':', '@', '`', ' ', '\x80'};
+    for (size_t i = 0; i < len && ok; i += 3) {
+        char saved = enc[i];
+        enc[i] = bad[i % sizeof(bad)];
+        ok = str_hex_decode(enc, len, back) == -1;
+        enc[i] = saved;
+    }
+    ok = ok && str_hex_decode("abc", 3, back) == -1;
+    str_hex_decoder d;
+    str_hex_decoder_init(&d);
+    size_t total = 0, out;
+    for (size_t i = 0; i < len && ok; i += 33) {
+        size_t chunk = len - i < 33 ? len - i : 33;
+        ok = str_hex_decode_update(&d, enc + i, chunk, back + total, &out) == 0;
+        total += out;
+    }
+    ok = ok && str_hex_decode_finish(&d) == 0 && total == 200 && memcmp(back, data, 200) == 0;
+    str_hex_decoder_init(&d);
+    ok = ok && str_hex_decode_update(&d, "abc", 3, back, &out) == 0 && out == 1;
+    ok = ok && str_hex_decode_finish(&d) == -1;
+    test_result("hex", ok);
+}
 
 int main() {
     printf("Length of 'hello': %d\n", str_length("hello"));
-    return 0;
+
+    printf("Running string_utils tests...\n\n");
+
+    test_sv_find_compare();
+    test_sv_affix_strip();
+    test_sv_split();
+    test_str_builder();
+    test_substring_search();
+    test_splitter();
+    test_base64();
+    test_hex();
+
+    printf("\nTests completed: %d passed, %d failed\n",
+           test_passed, test_count - test_passed);
+    return test_passed == test_count ? 0 : 1;
 }
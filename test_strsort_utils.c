@@ -0,0 +1,172 @@
+// test_strsort_utils.c - Tests for strsort_utils
+#include "strsort_utils.h"
+#include "thread_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Test utility functions
+int test_count = 0;
+int test_passed = 0;
+
+void test_result(const char *test_name, int success) {
+    test_count++;
+    if (success) {
+        test_passed++;
+        printf("✓ %s\n", test_name);
+    } else {
+        printf("✗ %s\n", test_name);
+    }
+}
+
+static unsigned rng_state = 12345;
+
+static unsigned next_rand(void) {
+    rng_state = rng_state * 1103515245 + 12345;
+    return rng_state >> 8;
+}
+
+static int cmp_cstr(const void *a, const void *b) {
+    return str_compare(*(char *const *)a, *(char *const *)b);
+}
+
+static int cmp_natural(const void *a, const void *b) {
+    return str_natural_compare(*(char *const *)a, *(char *const *)b);
+}
+
+static int cmp_view(const void *a, const void *b) {
+    return sv_compare(*(const str_view *)a, *(const str_view *)b);
+}
+
+// Builds n path-like strings with long shared prefixes, duplicates and
+// numbered names
+static char **make_strings(size_t n) {
+    static const char *dirs[] = {"/usr/lib/", "/usr/lib64/", "/var/log/app/", "/home/user/src/", ""};
+    char **strs = malloc(n * sizeof(*strs));
+    char buf[96];
+    for (size_t i = 0; i < n; i++) {
+        unsigned r = next_rand();
+        if (r % 10 == 0 && i > 0) {
+            strs[i] = strdup(strs[next_rand() % i]);
+            continue;
+        }
+        int len = snprintf(buf, sizeof(buf), "%sfile%u%s", dirs[r % 5], next_rand() % (r % 3 ? 100 : 100000),
+                           r % 4 ? ".txt" : "");
+        // Occasionally a long tail to reach several key refills
+        if (r % 7 == 0) snprintf(buf + len, sizeof(buf) - (size_t)len, "/%s", "deeper/and/deeper");
+        strs[i] = strdup(buf);
+    }
+    return strs;
+}
+
+static void free_strings(char **strs, size_t n) {
+    for (size_t i = 0; i < n; i++) free(strs[i]);
+    free(strs);
+}
+
+// Internal helper: 1 if str_sort(flags) puts strs into the same order as qsort(cmp)
+static int sorts_like_qsort(size_t n, int flags, int (*cmp)(const void *, const void *)) {
+    char **a = make_strings(n);
+    char **b = malloc(n * sizeof(*b));
+    memcpy(b, a, n * sizeof(*b));
+    int ok = str_sort(a, n, flags) == 0;
+    qsort(b, n, sizeof(*b), cmp);
+    for (size_t i = 0; i < n && ok; i++) ok = cmp(&a[i], &b[i]) == 0;
+    free(b);
+    free_strings(a, n);
+    return ok;
+}
+
+// Test bytewise sorting against qsort at several sizes
+void test_str_sort() {
+    int ok = 1;
+    size_t sizes[] = {0, 1, 2, 31, 33, 1000, 20000, 200000};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]) && ok; i++) {
+        ok = sorts_like_qsort(sizes[i], 0, cmp_cstr);
+    }
+    // Many exact duplicates and prefixes of each other
+    char *dups[3000];
+    for (int i = 0; i < 3000; i++) dups[i] = i % 3 == 0 ? "aaaaaaaaaaaaaaaa" : i % 3 == 1 ? "aaaaaaaa" : "aaaaaaaaa";
+    ok = ok && str_sort(dups, 3000, 0) == 0;
+    for (int i = 0; i < 3000 && ok; i++) ok = strlen(dups[i]) == (i < 1000 ? 8u : i < 2000 ? 9u : 16u);
+    test_result("str_sort", ok);
+}
+
+// Test natural order, both the comparator and the sort
+void test_natural() {
+    const char *ordered[] = {"", "a", "a!", "a0", "a00", "a01", "a1", "a2", "a10", "a10b", "a10c1",
+                             "a10c02", "a10c2", "a99999999999999999999", "a100000000000000000000",
+                             "a100000000000000000000z", "ab"};
+    size_t n = sizeof(ordered) / sizeof(ordered[0]);
+    int ok = 1;
+    for (size_t i = 0; i < n && ok; i++) {
+        for (size_t j = 0; j < n && ok; j++) {
+            int r = str_natural_compare(ordered[i], ordered[j]);
+            ok = (i < j) ? r < 0 : (i > j) ? r > 0 : r == 0;
+            if (!ok) printf("  %s vs %s: %d\n", ordered[i], ordered[j], r);
+        }
+    }
+    char *shuffled[sizeof(ordered) / sizeof(ordered[0])];
+    for (size_t i = 0; i < n; i++) shuffled[i] = (char *)ordered[(i * 7) % n];
+    ok = ok && str_sort(shuffled, n, STR_SORT_NATURAL) == 0;
+    for (size_t i = 0; i < n && ok; i++) ok = shuffled[i] == ordered[i];
+    // Digit runs longer than 255 digits use the long length form
+    char big1[400], big2[400];
+    memset(big1, '9', 300);
+    big1[300] = '\0';
+    memset(big2, '1', 301);
+    big2[301] = '\0';
+    ok = ok && str_natural_compare(big1, big2) < 0 && str_natural_compare("5", big1) < 0;
+    ok = ok && sorts_like_qsort(50000, STR_SORT_NATURAL, cmp_natural);
+    test_result("natural", ok);
+}
+
+// Test views, including embedded NUL bytes and prefixes
+void test_sv_sort() {
+    enum { N = 5000 };
+    static char pool[N][24];
+    str_view a[N], b[N];
+    for (int i = 0; i < N; i++) {
+        size_t len = next_rand() % 20;
+        for (size_t k = 0; k < len; k++) pool[i][k] = "\0\001ab"[next_rand() % 4];
+        a[i] = b[i] = sv_make(pool[i], len);
+    }
+    int ok = sv_sort(a, N, 0) == 0;
+    qsort(b, N, sizeof(b[0]), cmp_view);
+    for (int i = 0; i < N && ok; i++) ok = sv_equal(a[i], b[i]);
+    test_result("sv_sort", ok);
+}
+
+// Test the thread pool directly and a sort large enough to run in parallel
+static void add_square(void *ctx, size_t i) {
+    unsigned long *out = ctx;
+    out[i] = (unsigned long)(i * i);
+}
+
+void test_parallel() {
+    int ok = thread_pool_size() == 4 && thread_pool_init(2) == -1;
+    unsigned long out[1000];
+    thread_parallel_for(1000, add_square, out);
+    for (size_t i = 0; i < 1000 && ok; i++) ok = out[i] == i * i;
+    ok = ok && sorts_like_qsort(300000, 0, cmp_cstr);
+    ok = ok && sorts_like_qsort(100000, STR_SORT_NATURAL, cmp_natural);
+    test_result("parallel", ok);
+}
+
+int main() {
+    printf("Running strsort_utils tests...\n\n");
+
+    // Force several threads even on a single-CPU machine; this must precede
+    // the first parallel loop, which would start the pool at the CPU count
+    int pool_ok = thread_pool_init(4) == 0;
+
+    test_str_sort();
+    test_natural();
+    test_sv_sort();
+    test_parallel();
+    test_result("pool_init", pool_ok);
+
+    printf("\nTests completed: %d passed, %d failed\n",
+           test_passed, test_count - test_passed);
+    return test_passed == test_count ? 0 : 1;
+}
@@ -1,8 +1,232 @@
 // test_time_utils.c - Simple tests for time_utils
 #include "time_utils.h"
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Test utility functions
+int test_count = 0;
+int test_passed = 0;
+
+void test_result(const char *test_name, int success) {
+    test_count++;
+    if (success) {
+        test_passed++;
+        printf("✓ %s\n", test_name);
+    } else {
+        printf("✗ %s\n", test_name);
+    }
+}
+
+// Checks a UTC calendar against its own Unix time, so a snapshot mixing
+// two seconds cannot pass
+static int calendar_consistent(const time_calendar *c) {
+    long long days = c->sec / 86400, secs = c->sec % 86400;
+    return c->hour * 3600 + c->minute * 60 + c->second == secs &&
+           (days + 4) % 7 == c->weekday && c->utc_offset == 0 &&
+           c->nsec >= 0 && c->nsec < 1000000000;
+}
+
+void test_calendar() {
+    time_calendar c;
+    struct tm tm_info;
+    int ok = time_now_calendar(&c) == 0;
+    gmtime_r(&c.sec, &tm_info);
+    ok = ok && c.year == tm_info.tm_year + 1900 && c.month == tm_info.tm_mon + 1 &&
+         c.day == tm_info.tm_mday && c.yearday == tm_info.tm_yday && calendar_consistent(&c);
+    // A second call in the same second comes from the cache
+    time_calendar d;
+    ok = ok && time_now_calendar(&d) == 0 && (d.sec != c.sec || (d.day == c.day && d.hour == c.hour));
+    ok = ok && get_current_year() == c.year && get_current_month() == c.month;
+    test_result("calendar snapshot", ok);
+}
+
+static void *calendar_worker(void *arg) {
+    int *ok = arg;
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    do {
+        for (int i = 0; i < 1000; i++) {
+            time_calendar c;
+            if (time_now_calendar(&c) != 0 || !calendar_consistent(&c)) *ok = 0;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while (now.tv_sec - start.tv_sec < 2);
+    return NULL;
+}
+
+void test_calendar_threads() {
+    // Long enough to cross at least one second, so threads race to refresh
+    pthread_t threads[4];
+    int ok[4] = { 1, 1, 1, 1 };
+    for (int i = 0; i < 4; i++) pthread_create(&threads[i], NULL, calendar_worker, &ok[i]);
+    for (int i = 0; i < 4; i++) pthread_join(threads[i], NULL);
+    test_result("calendar across threads", ok[0] && ok[1] && ok[2] && ok[3]);
+}
+
+// Expected output of time_format, built with strftime
+static int expected_format(time_t sec, long nsec, int flags, char *buf, size_t buflen) {
+    static const int digits_for[4] = { 0, 3, 6, 9 };
+    static const long divisor_for[4] = { 1, 1000000, 1000, 1 };
+    struct tm tm_info;
+    int precision = (flags & TIME_FORMAT_NS) >> 4;
+    if (flags & TIME_FORMAT_UTC) gmtime_r(&sec, &tm_info);
+    else localtime_r(&sec, &tm_info);
+    size_t len = strftime(buf, buflen, flags & TIME_FORMAT_T ? "%Y-%m-%dT%H:%M:%S" : "%Y-%m-%d %H:%M:%S", &tm_info);
+    if (precision) len += sprintf(buf + len, ".%0*ld", digits_for[precision], nsec / divisor_for[precision]);
+    if (flags & TIME_FORMAT_ZONE) {
+        if (flags & TIME_FORMAT_UTC) len += sprintf(buf + len, "Z");
+        else len += strftime(buf + len, buflen - len, "%z", &tm_info);
+    }
+    return (int)len;
+}
+
+// Runs times near start through every layout, comparing with strftime
+static int format_matches(time_t start, int count) {
+    char got[64], want[64];
+    int ok = 1;
+    for (int i = 0; i < count; i++) {
+        // Mostly consecutive seconds, so both cache hits and misses occur
+        time_t sec = start + (i % 7 == 0 ? i * 104729L : i / 3);
+        long nsec = (long)((unsigned long)i * 2654435761u % 1000000000);
+        for (int flags = 0; flags < 0x40; flags++) {
+            if (flags & 0x08) continue;
+            int n = time_format(sec, nsec, flags, got, sizeof(got));
+            ok = ok && n == expected_format(sec, nsec, flags, want, sizeof(want)) && strcmp(got, want) == 0;
+        }
+    }
+    return ok;
+}
+
+void test_format() {
+    char buf[TIME_FORMAT_MAX];
+    int ok = format_matches(1700000000, 3000) && format_matches(-300000000, 500) &&
+         format_matches(253402300790, 30) && format_matches(400000000000, 30);
+
+    // Half-hour offsets, and negative offsets across a DST change
+    setenv("TZ", "IST-5:30", 1);
+    tzset();
+    ok = ok && format_matches(1600000000, 500);
+    setenv("TZ", "EST5EDT,M3.2.0,M11.1.0", 1);
+    tzset();
+    ok = ok && format_matches(1710053900, 500) && format_matches(1730613500, 500);
+    setenv("TZ", "UTC", 1);
+    tzset();
+
+    // Exactly full and one byte short
+    int n = time_format(1700000000, 5, TIME_FORMAT_NS | TIME_FORMAT_ZONE | TIME_FORMAT_UTC, buf, sizeof(buf));
+    ok = ok && n == 30 && strcmp(buf, "2023-11-14 22:13:20.000000005Z") == 0;
+    ok = ok && time_format(1700000000, 5, TIME_FORMAT_NS, buf, 30) == 29;
+    ok = ok && time_format(1700000000, 5, TIME_FORMAT_NS, buf, 29) == -1;
+    ok = ok && time_format(1700000000, 1000000000, 0, buf, sizeof(buf)) == -1;
+    ok = ok && time_format(1700000000, -1, 0, buf, sizeof(buf)) == -1;
+    ok = ok && strcmp(format_time(1700000000, buf, sizeof(buf)), "2023-11-14 22:13:20") == 0;
+    ok = ok && format_time(1700000000, buf, 5)[0] == '\0';
+    ok = ok && time_format_now(TIME_FORMAT_T | TIME_FORMAT_MS, buf, sizeof(buf)) == 23 && buf[10] == 'T';
+    test_result("time_format matches strftime", ok);
+}
+
+static void sleep_ms(long ms) {
+    struct timespec ts = { ms / 1000, ms % 1000 * 1000000 };
+    nanosleep(&ts, NULL);
+}
+
+void test_clocks() {
+    uint64_t t0 = time_now_ns(), c0 = time_cycles();
+    sleep_ms(20);
+    uint64_t t1 = time_now_ns(), c1 = time_cycles();
+    uint64_t by_cycles = time_cycles_to_ns(c1 - c0);
+    printf("cycles per ns: %.3f\n", time_cycles_per_ns());
+    // The sleep may overrun but never undershoot; the two clocks agree
+    int ok = t1 - t0 >= 20000000 && t1 - t0 < 200000000 && time_cycles_per_ns() > 0 &&
+             by_cycles > (t1 - t0) * 9 / 10 && by_cycles < (t1 - t0) * 11 / 10;
+
+    time_stopwatch sw;
+    time_stopwatch_reset(&sw);
+    time_stopwatch_start(&sw);
+    sleep_ms(10);
+    time_stopwatch_stop(&sw);
+    sleep_ms(30);
+    {
+        TIME_STOPWATCH_SCOPE(&sw);
+        sleep_ms(10);
+    }
+    uint64_t ns = time_stopwatch_ns(&sw);
+    ok = ok && !sw.running && ns >= 19000000 && ns < 39000000;
+    time_stopwatch_start(&sw);
+    ok = ok && time_stopwatch_ns(&sw) >= ns;
+    test_result("monotonic clock, cycles and stopwatch", ok);
+}
+
+static void *trace_worker(void *arg) {
+    (void)arg;
+    for (int i = 0; i < 3000; i++) {
+        TIME_REGION("worker");
+        {
+            TIME_REGION("inner");
+        }
+    }
+    return NULL;
+}
+
+// Counts regions in a written trace, and whether text appears in it
+static long trace_count(FILE *f, const char *text, int *found) {
+    char line[256];
+    long n = 0;
+    rewind(f);
+    *found = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (strstr(line, "\"ph\":\"X\"")) n++;
+        if (strstr(line, text)) *found = 1;
+    }
+    return n;
+}
+
+void test_trace() {
+    FILE *f = tmpfile();
+    int found, ok = f != NULL;
+
+    // Nothing is recorded until enabled
+    time_region_begin("off");
+    time_region_end();
+    ok = ok && time_trace_write(f) == 0 && trace_count(f, "off", &found) == 0;
+
+    time_trace_enable(1);
+    {
+        TIME_REGION("quote\"and\\slash");
+        pthread_t threads[3];
+        for (int i = 0; i < 3; i++) pthread_create(&threads[i], NULL, trace_worker, NULL);
+        for (int i = 0; i < 3; i++) pthread_join(threads[i], NULL);
+    }
+    // Regions past the depth limit are dropped, and the ends still pair up
+    for (int i = 0; i < 70; i++) time_region_begin("deep");
+    for (int i = 0; i < 71; i++) time_region_end();
+    time_region_begin("open");
+    time_trace_enable(0);
+
+    rewind(f);
+    long n = time_trace_write(f);
+    fflush(f);
+    ok = ok && n == 1 + 3 * 6000 + 64 && trace_count(f, "\"quote\\\"and\\\\slash\"", &found) == n && found;
+    time_region_end();
+
+    ok = ok && time_trace_save("/nonexistent-dir/trace.json") == -1;
+    time_trace_clear();
+    fclose(f);
+    f = tmpfile();
+    ok = ok && f && time_trace_write(f) == 0;
+    if (f) fclose(f);
+    test_result("region trace", ok);
+}
 
 int main() {
+    printf("Running time_utils tests...\n\n");
+
+    // UTC makes every field checkable from the Unix time
+    setenv("TZ", "UTC", 1);
+    tzset();
+
     printf("Current time: %ld\n", get_current_time());
     char buf[32];
     printf("Formatted: %s\n", format_time(get_current_time(), buf, sizeof(buf)));
@@ -12,6 +236,15 @@ int main() {
     printf("Current month: %d\n", get_current_month());
     printf("Current day: %d\n", get_current_day());
     printf("Current weekday: %d\n", get_current_weekday());
-    printf("Unix timestamp: %ld\n", get_unix_timestamp());
-    return 0;
+    printf("Unix timestamp: %ld\n\n", get_unix_timestamp());
+
+    test_calendar();
+    test_calendar_threads();
+    test_format();
+    test_clocks();
+    test_trace();
+
+    printf("\nTests completed: %d passed, %d failed\n",
+           test_passed, test_count - test_passed);
+    return test_passed == test_count ? 0 : 1;
 }
@@ -0,0 +1,138 @@
+// test_utf8_utils.c - Tests for utf8_utils
+#include "utf8_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+// Test utility functions
+int test_count = 0;
+int test_passed = 0;
+
+void test_result(const char *test_name, int success) {
+    test_count++;
+    if (success) {
+        test_passed++;
+        printf("✓ %s\n", test_name);
+    } else {
+        printf("✗ %s\n", test_name);
+    }
+}
+
+// Reference validator: decode one sequence at a time
+static size_t slow_find_invalid(const char *s, size_t len) {
+    size_t i = 0;
+    uint32_t cp;
+    while (i < len) {
+        size_t n = utf8_decode(s + i, len - i, &cp);
+        if (n == 0) return i;
+        i += n;
+    }
+    return len;
+}
+
+// Test known valid and invalid sequences
+void test_utf8_vectors() {
+    struct { const char *s; size_t bad; } cases[] = {
+        {"plain ascii", 11},
+        {"caf\xc3\xa9", 5},
+        {"\xe2\x82\xac \xf0\x9f\x98\x80", 8},
+        {"\xc0\xaf", 0},                  // overlong 2-byte
+        {"\xe0\x80\xaf", 0},              // overlong 3-byte
+        {"\xf0\x80\x80\xaf", 0},          // overlong 4-byte
+        {"ok\xed\xa0\x80", 2},            // surrogate
+        {"\xf4\x90\x80\x80", 0},          // above U+10FFFF
+        {"ab\x80", 2},                    // stray continuation
+        {"ab\xe2\x82", 2},                // truncated at end
+        {"\xe2\x82x", 0},                 // truncated mid-text
+        {"\xf5\x80\x80\x80", 0},
+    };
+    int ok = 1;
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        size_t len = strlen(cases[c].s);
+        size_t expect = cases[c].bad;
+        ok = ok && utf8_find_invalid(cases[c].s, len) == expect;
+        ok = ok && utf8_is_valid(cases[c].s, len) == (expect == len);
+    }
+    uint32_t cp = 0;
+    ok = ok && utf8_decode("\xf0\x9f\x98\x80", 4, &cp) == 4 && cp == 0x1f600;
+    test_result("utf8_vectors", ok);
+}
+
+// Test the vectorized path against the reference on mutated long inputs
+void test_utf8_fuzz() {
+    const char *unit = "h\xc3\xa9llo \xe2\x82\xac w\xf0\x9f\x98\x80rld \xe4\xb8\xad\xe6\x96\x87 ";
+    char buf[400];
+    size_t ulen = strlen(unit), len = 0;
+    while (len + ulen <= sizeof(buf)) {
+        memcpy(buf + len, unit, ulen);
+        len += ulen;
+    }
+    int ok = utf8_is_valid(buf, len);
+    unsigned seed = 99;
+    static const unsigned char junk[] = {0x80, 0xbf, 0xc0, 0xc2, 0xe0, 0xed, 0xef, 0xf0, 0xf4, 0xf5, 0xff, 'a'};
+    for (int round = 0; round < 3000 && ok; round++) {
+        char m[400];
+        memcpy(m, buf, len);
+        for (int k = 0; k < 1 + round % 3; k++) {
+            seed = seed * 1103515245 + 12345;
+            size_t pos = (seed >> 8) % len;
+            seed = seed * 1103515245 + 12345;
+            m[pos] = (char)junk[(seed >> 16) % sizeof(junk)];
+        }
+        size_t cut = len - round % 5;
+        ok = utf8_find_invalid(m, cut) == slow_find_invalid(m, cut);
+    }
+    test_result("utf8_fuzz", ok);
+}
+
+// Test streaming validation with the input split at every position
+void test_utf8_stream() {
+    const char *good = "\xe4\xb8\xad\xe6\x96\x87 text \xf0\x9f\x98\x80 more text to pass a block";
+    const char *bad = "valid prefix \xe4\xb8\xad\xe6\x96 then junk";
+    size_t glen = strlen(good), blen = strlen(bad);
+    int ok = 1;
+    for (size_t cut = 0; cut <= glen; cut++) {
+        utf8_validator v;
+        utf8_validator_init(&v);
+        utf8_validator_update(&v, good, cut);
+        utf8_validator_update(&v, good + cut, glen - cut);
+        ok = ok && utf8_validator_finish(&v) == 0;
+    }
+    for (size_t cut = 0; cut <= blen; cut++) {
+        utf8_validator v;
+        utf8_validator_init(&v);
+        utf8_validator_update(&v, bad, cut);
+        utf8_validator_update(&v, bad + cut, blen - cut);
+        ok = ok && utf8_validator_finish(&v) == -1 && v.error_offset == 16;
+    }
+    utf8_validator v;
+    utf8_validator_init(&v);
+    utf8_validator_update(&v, "abc\xe2\x82", 5);
+    ok = ok && utf8_validator_finish(&v) == -1 && v.error_offset == 3;
+    test_result("utf8_stream", ok);
+}
+
+// Test code point counting and display width
+void test_utf8_width() {
+    const char *s = "a\xc3\xa9\xe4\xb8\xad\xf0\x9f\x98\x80" "e\xcc\x81";
+    size_t len = strlen(s);
+    int ok = utf8_count_codepoints(s, len) == 6;
+    ok = ok && utf8_display_width(s, len) == 1 + 1 + 2 + 2 + 1 + 0;
+    char long_buf[100];
+    memset(long_buf, 'x', sizeof(long_buf));
+    ok = ok && utf8_count_codepoints(long_buf, sizeof(long_buf)) == 100;
+    ok = ok && utf8_codepoint_width('\t') == 0 && utf8_codepoint_width(0xff21) == 2;
+    test_result("utf8_width", ok);
+}
+
+int main() {
+    printf("Running utf8_utils tests...\n\n");
+
+    test_utf8_vectors();
+    test_utf8_fuzz();
+    test_utf8_stream();
+    test_utf8_width();
+
+    printf("\nTests completed: %d passed, %d failed\n",
+           test_passed, test_count - test_passed);
+    return test_passed == test_count ? 0 : 1;
+}
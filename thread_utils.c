@@ -0,0 +1,132 @@
+#include "thread_utils.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// The shared pool. Workers live for the rest of the process and sleep on
+// work_cv between loops; one loop runs at a time.
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t work_cv;
+    pthread_cond_t done_cv;
+    pthread_mutex_t busy;       // held by the thread running a loop
+    int started;
+    int nworkers;
+    unsigned long generation;   // bumped for every loop
+    int running;                // workers still inside the current loop
+    void (*fn)(void *ctx, size_t i);
+    void *ctx;
+    size_t n;
+    atomic_size_t next;
+} thread_pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .work_cv = PTHREAD_COND_INITIALIZER,
+    .done_cv = PTHREAD_COND_INITIALIZER,
+    .busy = PTHREAD_MUTEX_INITIALIZER,
+};
+
+// Set while a thread executes loop tasks, so nested loops run inline
+static _Thread_local int thread_in_task = 0;
+
+// Returns the number of online CPUs (at least 1)
+int thread_cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+// Internal helper: claims and runs indices of the current loop until none remain
+static void thread_run_tasks(void (*fn)(void *, size_t), void *ctx, size_t n) {
+    thread_in_task = 1;
+    size_t i;
+    while ((i = atomic_fetch_add(&thread_pool.next, 1)) < n) fn(ctx, i);
+    thread_in_task = 0;
+}
+
+// Internal helper: worker thread body
+static void *thread_worker(void *arg) {
+    (void)arg;
+    unsigned long seen = 0;
+    pthread_mutex_lock(&thread_pool.lock);
+    for (;;) {
+        while (thread_pool.generation == seen) {
+            pthread_cond_wait(&thread_pool.work_cv, &thread_pool.lock);
+        }
+        seen = thread_pool.generation;
+        void (*fn)(void *, size_t) = thread_pool.fn;
+        void *ctx = thread_pool.ctx;
+        size_t n = thread_pool.n;
+        pthread_mutex_unlock(&thread_pool.lock);
+
+        thread_run_tasks(fn, ctx, n);
+
+        pthread_mutex_lock(&thread_pool.lock);
+        if (--thread_pool.running == 0) pthread_cond_signal(&thread_pool.done_cv);
+    }
+    return NULL;
+}
+
+// Internal helper: starts the workers; the caller holds thread_pool.lock
+static int thread_pool_start(int nthreads) {
+    if (nthreads <= 0) nthreads = thread_cpu_count();
+    thread_pool.started = 1;
+    thread_pool.nworkers = 0;
+    pthread_attr_t attr;
+    if (pthread_attr_init(&attr) != 0) return -1;
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int rc = 0;
+    for (int i = 1; i < nthreads; i++) {
+        pthread_t t;
+        if (pthread_create(&t, &attr, thread_worker, NULL) != 0) {
+            // Run with the workers that did start
+            rc = -1;
+            break;
+        }
+        thread_pool.nworkers++;
+    }
+    pthread_attr_destroy(&attr);
+    return rc;
+}
+
+// Starts the shared worker pool with nthreads threads in total
+int thread_pool_init(int nthreads) {
+    pthread_mutex_lock(&thread_pool.lock);
+    int rc = thread_pool.started ? -1 : thread_pool_start(nthreads);
+    pthread_mutex_unlock(&thread_pool.lock);
+    return rc;
+}
+
+// Returns the number of threads parallel loops use, counting the caller
+int thread_pool_size(void) {
+    pthread_mutex_lock(&thread_pool.lock);
+    if (!thread_pool.started) thread_pool_start(0);
+    int n = thread_pool.nworkers + 1;
+    pthread_mutex_unlock(&thread_pool.lock);
+    return n;
+}
+
+// Runs fn(ctx, i) for every i in [0, n) on the pool and the calling thread
+void thread_parallel_for(size_t n, void (*fn)(void *ctx, size_t i), void *ctx) {
+    if (n == 0) return;
+    if (n == 1 || thread_in_task || thread_pool_size() == 1 ||
+        pthread_mutex_trylock(&thread_pool.busy) != 0) {
+        for (size_t i = 0; i < n; i++) fn(ctx, i);
+        return;
+    }
+    pthread_mutex_lock(&thread_pool.lock);
+    thread_pool.fn = fn;
+    thread_pool.ctx = ctx;
+    thread_pool.n = n;
+    atomic_store(&thread_pool.next, 0);
+    thread_pool.running = thread_pool.nworkers;
+    thread_pool.generation++;
+    pthread_cond_broadcast(&thread_pool.work_cv);
+    pthread_mutex_unlock(&thread_pool.lock);
+
+    thread_run_tasks(fn, ctx, n);
+
+    pthread_mutex_lock(&thread_pool.lock);
+    while (thread_pool.running > 0) pthread_cond_wait(&thread_pool.done_cv, &thread_pool.lock);
+    pthread_mutex_unlock(&thread_pool.lock);
+    pthread_mutex_unlock(&thread_pool.busy);
+}
@@ -0,0 +1,24 @@
+#ifndef THREAD_UTILS_H
+#define THREAD_UTILS_H
+
+#include <stddef.h>
+
+// Returns the number of online CPUs (at least 1)
+int thread_cpu_count(void);
+
+// Starts the shared worker pool so that parallel loops use nthreads threads
+// in total, counting the caller; 0 selects thread_cpu_count(). The pool
+// starts implicitly on first use, so call this first to override the size.
+// Returns 0 on success, -1 if the pool is already running or on error.
+int thread_pool_init(int nthreads);
+
+// Returns the number of threads parallel loops use, counting the caller
+int thread_pool_size(void);
+
+// Runs fn(ctx, i) for every i in [0, n) on the pool and the calling thread
+// and returns once all calls have finished. Tasks are handed out one index
+// at a time, so uneven tasks balance themselves. A call made from inside a
+// task, or while another thread's loop is running, runs inline.
+void thread_parallel_for(size_t n, void (*fn)(void *ctx, size_t i), void *ctx);
+
+#endif // THREAD_UTILS_H
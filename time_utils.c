@@ -1,16 +1,36 @@
 #include "time_utils.h"
 #include <time.h>
 #include <stdio.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define TIME_X86 1
+#endif
 
 // Time utility function implementations will go here
 
+// The calendar of the most recent second anyone asked for, published with
+// a seqlock: seq is odd while a writer updates the fields, and readers
+// retry if it was odd or changed while they copied. The fields are relaxed
+// atomics so the racy copy a reader may throw away is still well defined.
+static struct {
+    atomic_uint seq;
+    atomic_llong sec;
+    atomic_int year, month, day, hour, minute, second;
+    atomic_int weekday, yearday, is_dst;
+    atomic_long utc_offset;
+} time_cache = { .sec = -1 };
+
 time_t get_current_time() {
     return time(NULL);
 }
 
 char *format_time(time_t t, char *buf, size_t buflen) {
-    struct tm *tm_info = localtime(&t);
-    strftime(buf, buflen, "%Y-%m-%d %H:%M:%S", tm_info);
+    if (time_format(t, 0, 0, buf, buflen) < 0 && buflen > 0) buf[0] = '\0';
     return buf;
 }
 
@@ -26,29 +46,512 @@ int days_in_month(int year, int month) {
 }
 
 int get_current_year() {
-    time_t t = time(NULL);
-    struct tm *tm_info = localtime(&t);
-    return tm_info->tm_year + 1900;
+    time_calendar c;
+    time_now_calendar(&c);
+    return c.year;
 }
 
 int get_current_month() {
-    time_t t = time(NULL);
-    struct tm *tm_info = localtime(&t);
-    return tm_info->tm_mon + 1;
+    time_calendar c;
+    time_now_calendar(&c);
+    return c.month;
 }
 
 int get_current_day() {
-    time_t t = time(NULL);
-    struct tm *tm_info = localtime(&t);
-    return tm_info->tm_mday;
+    time_calendar c;
+    time_now_calendar(&c);
+    return c.day;
 }
 
 int get_current_weekday() {
-    time_t t = time(NULL);
-    struct tm *tm_info = localtime(&t);
-    return tm_info->tm_wday;
+    time_calendar c;
+    time_now_calendar(&c);
+    return c.weekday;
 }
 
 long get_unix_timestamp() {
     return (long)time(NULL);
 }
+
+// Internal helper: copies the cached calendar if it holds second sec
+static int time_cache_read(time_t sec, time_calendar *out) {
+    unsigned seq;
+    do {
+        seq = atomic_load_explicit(&time_cache.seq, memory_order_acquire);
+        if (seq & 1) return -1;
+        if (atomic_load_explicit(&time_cache.sec, memory_order_relaxed) != sec) return -1;
+        out->year = atomic_load_explicit(&time_cache.year, memory_order_relaxed);
+        out->month = atomic_load_explicit(&time_cache.month, memory_order_relaxed);
+        out->day = atomic_load_explicit(&time_cache.day, memory_order_relaxed);
+        out->hour = atomic_load_explicit(&time_cache.hour, memory_order_relaxed);
+        out->minute = atomic_load_explicit(&time_cache.minute, memory_order_relaxed);
+        out->second = atomic_load_explicit(&time_cache.second, memory_order_relaxed);
+        out->weekday = atomic_load_explicit(&time_cache.weekday, memory_order_relaxed);
+        out->yearday = atomic_load_explicit(&time_cache.yearday, memory_order_relaxed);
+        out->is_dst = atomic_load_explicit(&time_cache.is_dst, memory_order_relaxed);
+        out->utc_offset = atomic_load_explicit(&time_cache.utc_offset, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+    } while (atomic_load_explicit(&time_cache.seq, memory_order_relaxed) != seq);
+    return 0;
+}
+
+// Internal helper: publishes the calendar of second sec unless another
+// thread is already writing or the cache holds a later second. Losing the
+// race is harmless, since the caller already has its own copy.
+static void time_cache_write(time_t sec, const time_calendar *c) {
+    unsigned seq = atomic_load_explicit(&time_cache.seq, memory_order_relaxed);
+    if (seq & 1) return;
+    if (atomic_load_explicit(&time_cache.sec, memory_order_relaxed) >= sec) return;
+    if (!atomic_compare_exchange_strong_explicit(&time_cache.seq, &seq, seq + 1,
+                                                 memory_order_acquire, memory_order_relaxed))
+        return;
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&time_cache.sec, sec, memory_order_relaxed);
+    atomic_store_explicit(&time_cache.year, c->year, memory_order_relaxed);
+    atomic_store_explicit(&time_cache.month, c->month, memory_order_relaxed);
+    atomic_store_explicit(&time_cache.day, c->day, memory_order_relaxed);
+    atomic_store_explicit(&time_cache.hour, c->hour, memory_order_relaxed);
+    atomic_store_explicit(&time_cache.minute, c->minute, memory_order_relaxed);
+    atomic_store_explicit(&time_cache.second, c->second, memory_order_relaxed);
+    atomic_store_explicit(&time_cache.weekday, c->weekday, memory_order_relaxed);
+    atomic_store_explicit(&time_cache.yearday, c->yearday, memory_order_relaxed);
+    atomic_store_explicit(&time_cache.is_dst, c->is_dst, memory_order_relaxed);
+    atomic_store_explicit(&time_cache.utc_offset, c->utc_offset, memory_order_relaxed);
+    atomic_store_explicit(&time_cache.seq, seq + 2, memory_order_release);
+}
+
+// Returns the current local time, broken down
+int time_now_calendar(time_calendar *out) {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_REALTIME, &ts) != 0) return -1;
+    out->sec = ts.tv_sec;
+    out->nsec = ts.tv_nsec;
+    if (time_cache_read(ts.tv_sec, out) == 0) return 0;
+
+    struct tm tm_info;
+    if (localtime_r(&ts.tv_sec, &tm_info) == NULL) return -1;
+    out->year = tm_info.tm_year + 1900;
+    out->month = tm_info.tm_mon + 1;
+    out->day = tm_info.tm_mday;
+    out->hour = tm_info.tm_hour;
+    out->minute = tm_info.tm_min;
+    out->second = tm_info.tm_sec;
+    out->weekday = tm_info.tm_wday;
+    out->yearday = tm_info.tm_yday;
+    out->is_dst = tm_info.tm_isdst;
+    out->utc_offset = tm_info.tm_gmtoff;
+    time_cache_write(ts.tv_sec, out);
+    return 0;
+}
+
+// The formatted date and time of one second, as strftime
+// "%Y-%m-%d %H:%M:%S" would write it, and the zone suffix for that second
+typedef struct {
+    int valid;
+    time_t sec;
+    int len;
+    int zone_len;
+    char text[48];
+    char zone[8];
+} time_format_entry;
+
+// Each thread's last formatted second, for local time [0] and UTC [1]
+static _Thread_local time_format_entry time_format_cache[2];
+
+static const char time_digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Internal helper: writes v as exactly n decimal digits, two at a time
+static void time_put_digits(char *p, unsigned long v, int n) {
+    while (n >= 2) {
+        n -= 2;
+        memcpy(p + n, time_digit_pairs + v % 100 * 2, 2);
+        v /= 100;
+    }
+    if (n) p[0] = (char)('0' + v % 10);
+}
+
+// Internal helper: formats second sec into e
+static int time_format_fill(time_format_entry *e, time_t sec, int utc) {
+    struct tm tm_info;
+    if ((utc ? gmtime_r(&sec, &tm_info) : localtime_r(&sec, &tm_info)) == NULL) return -1;
+    int year = tm_info.tm_year + 1900;
+    if (year >= 0 && year <= 9999) {
+        char *p = e->text;
+        time_put_digits(p, (unsigned long)year, 4);
+        p[4] = '-';
+        time_put_digits(p + 5, (unsigned long)tm_info.tm_mon + 1, 2);
+        p[7] = '-';
+        time_put_digits(p + 8, (unsigned long)tm_info.tm_mday, 2);
+        p[10] = ' ';
+        time_put_digits(p + 11, (unsigned long)tm_info.tm_hour, 2);
+        p[13] = ':';
+        time_put_digits(p + 14, (unsigned long)tm_info.tm_min, 2);
+        p[16] = ':';
+        time_put_digits(p + 17, (unsigned long)tm_info.tm_sec, 2);
+        e->len = 19;
+    } else {
+        // Wider or negative years are rare enough to leave to strftime
+        e->len = (int)strftime(e->text, sizeof(e->text), "%Y-%m-%d %H:%M:%S", &tm_info);
+        if (e->len == 0) return -1;
+    }
+    if (utc) {
+        e->zone[0] = 'Z';
+        e->zone_len = 1;
+    } else {
+        // strftime %z: sign, then hours and minutes, dropping seconds
+        long off = tm_info.tm_gmtoff;
+        e->zone[0] = off < 0 ? '-' : '+';
+        off = (off < 0 ? -off : off) / 60;
+        time_put_digits(e->zone + 1, (unsigned long)(off / 60 * 100 + off % 60), 4);
+        e->zone_len = 5;
+    }
+    e->sec = sec;
+    e->valid = 1;
+    return 0;
+}
+
+// Formats a time with the given layout flags
+int time_format(time_t sec, long nsec, int flags, char *buf, size_t buflen) {
+    static const int digits_for[4] = { 0, 3, 6, 9 };
+    static const long divisor_for[4] = { 1, 1000000, 1000, 1 };
+    int utc = (flags & TIME_FORMAT_UTC) != 0;
+    int precision = (flags & TIME_FORMAT_NS) >> 4;
+    int digits = digits_for[precision];
+    time_format_entry *e = &time_format_cache[utc];
+
+    if (nsec < 0 || nsec >= 1000000000) return -1;
+    if (!e->valid || e->sec != sec) {
+        if (time_format_fill(e, sec, utc) != 0) {
+            e->valid = 0;
+            return -1;
+        }
+    }
+    size_t len = (size_t)e->len + (digits ? (size_t)digits + 1 : 0) +
+                 (flags & TIME_FORMAT_ZONE ? (size_t)e->zone_len : 0);
+    if (len >= buflen) return -1;
+
+    memcpy(buf, e->text, (size_t)e->len);
+    // The date and time are separated 9 characters before the end
+    if (flags & TIME_FORMAT_T) buf[e->len - 9] = 'T';
+    char *p = buf + e->len;
+    if (digits) {
+        *p++ = '.';
+        time_put_digits(p, (unsigned long)(nsec / divisor_for[precision]), digits);
+        p += digits;
+    }
+    if (flags & TIME_FORMAT_ZONE) {
+        memcpy(p, e->zone, (size_t)e->zone_len);
+        p += e->zone_len;
+    }
+    *p = '\0';
+    return (int)len;
+}
+
+// Formats the current time with the given layout flags
+int time_format_now(int flags, char *buf, size_t buflen) {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_REALTIME, &ts) != 0) return -1;
+    return time_format(ts.tv_sec, ts.tv_nsec, flags, buf, buflen);
+}
+
+// Returns monotonic nanoseconds
+uint64_t time_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Cycle counter sources for time_cycles
+#define TIME_SOURCE_UNKNOWN 0
+#define TIME_SOURCE_CLOCK   1
+#define TIME_SOURCE_RDTSC   2
+#define TIME_SOURCE_RDTSCP  3
+
+static atomic_int time_source = TIME_SOURCE_UNKNOWN;
+static pthread_once_t time_calibrate_once = PTHREAD_ONCE_INIT;
+static double time_ticks_per_ns = 1.0;
+
+// Internal helper: picks the counter; only an invariant TSC (constant
+// rate, running in every C-state) can be used
+static int time_detect_source(void) {
+#ifdef TIME_X86
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) && eax >= 0x80000007) {
+        __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+        if (edx & (1u << 8)) {
+            __get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx);
+            return edx & (1u << 27) ? TIME_SOURCE_RDTSCP : TIME_SOURCE_RDTSC;
+        }
+    }
+#endif
+    return TIME_SOURCE_CLOCK;
+}
+
+// Returns the current cycle count
+uint64_t time_cycles(void) {
+    int source = atomic_load_explicit(&time_source, memory_order_relaxed);
+    if (source == TIME_SOURCE_UNKNOWN) {
+        source = time_detect_source();
+        atomic_store_explicit(&time_source, source, memory_order_relaxed);
+    }
+#ifdef TIME_X86
+    if (source == TIME_SOURCE_RDTSCP) {
+        unsigned aux;
+        return __rdtscp(&aux);
+    }
+    if (source == TIME_SOURCE_RDTSC) {
+        // Without the fence RDTSC may run before earlier instructions
+        _mm_lfence();
+        return __rdtsc();
+    }
+#endif
+    return time_now_ns();
+}
+
+// Internal helper: measures the counter rate against the monotonic clock
+static void time_calibrate(void) {
+    uint64_t c0 = time_cycles(), t0 = time_now_ns(), t1;
+    if (atomic_load(&time_source) == TIME_SOURCE_CLOCK) return;
+    while ((t1 = time_now_ns()) - t0 < 10000000) {
+    }
+    uint64_t c1 = time_cycles();
+    time_ticks_per_ns = (double)(c1 - c0) / (double)(t1 - t0);
+}
+
+// Returns counter ticks per nanosecond
+double time_cycles_per_ns(void) {
+    pthread_once(&time_calibrate_once, time_calibrate);
+    return time_ticks_per_ns;
+}
+
+// Converts counter ticks to nanoseconds
+uint64_t time_cycles_to_ns(uint64_t cycles) {
+    return (uint64_t)((double)cycles / time_cycles_per_ns());
+}
+
+// Clears a stopwatch
+void time_stopwatch_reset(time_stopwatch *sw) {
+    sw->start = 0;
+    sw->elapsed = 0;
+    sw->running = 0;
+}
+
+// Starts a stopwatch; does nothing if it is running
+void time_stopwatch_start(time_stopwatch *sw) {
+    if (sw->running) return;
+    sw->running = 1;
+    sw->start = time_cycles();
+}
+
+// Stops a stopwatch, adding the interval since start
+void time_stopwatch_stop(time_stopwatch *sw) {
+    if (!sw->running) return;
+    sw->elapsed += time_cycles() - sw->start;
+    sw->running = 0;
+}
+
+// Returns the stopwatch total in nanoseconds
+uint64_t time_stopwatch_ns(const time_stopwatch *sw) {
+    uint64_t cycles = sw->elapsed;
+    if (sw->running) cycles += time_cycles() - sw->start;
+    return time_cycles_to_ns(cycles);
+}
+
+#define TIME_TRACE_CHUNK 4096
+#define TIME_TRACE_DEPTH 64
+
+typedef struct {
+    const char *name;
+    uint64_t start;
+    uint64_t end;
+} time_trace_event;
+
+// Events never move once written, so a reader can walk the chunks while
+// the owner appends: count and next are published with release stores
+typedef struct time_trace_chunk {
+    struct time_trace_chunk *_Atomic next;
+    atomic_size_t count;
+    time_trace_event events[TIME_TRACE_CHUNK];
+} time_trace_chunk;
+
+// One thread's recorded regions
+typedef struct time_trace_buffer {
+    struct time_trace_buffer *next;     // list of all buffers, under time_trace_lock
+    int tid;
+    atomic_int exited;
+    time_trace_chunk *_Atomic head;
+    time_trace_chunk *tail;             // only touched by the owning thread
+} time_trace_buffer;
+
+static atomic_int time_trace_on = 0;
+static atomic_ullong time_trace_epoch = 0;
+static pthread_mutex_t time_trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static time_trace_buffer *time_trace_buffers = NULL;
+static int time_trace_next_tid = 1;
+static pthread_once_t time_trace_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t time_trace_key;
+
+// Open regions of this thread, recorded or not, so ends always pair up
+static _Thread_local struct {
+    const char *name;
+    uint64_t start;
+    int recording;
+} time_region_stack[TIME_TRACE_DEPTH];
+static _Thread_local int time_region_depth = 0;
+static _Thread_local time_trace_buffer *time_trace_self = NULL;
+
+// Internal helper: marks a buffer's thread as gone, so that
+// time_trace_clear can free it
+static void time_trace_thread_exit(void *buffer) {
+    atomic_store(&((time_trace_buffer *)buffer)->exited, 1);
+}
+
+static void time_trace_make_key(void) {
+    pthread_key_create(&time_trace_key, time_trace_thread_exit);
+}
+
+// Internal helper: the calling thread's buffer, registered on first use
+static time_trace_buffer *time_trace_buffer_self(void) {
+    if (time_trace_self) return time_trace_self;
+    time_trace_buffer *b = calloc(1, sizeof(*b));
+    if (!b) return NULL;
+    pthread_once(&time_trace_key_once, time_trace_make_key);
+    pthread_setspecific(time_trace_key, b);
+    pthread_mutex_lock(&time_trace_lock);
+    b->tid = time_trace_next_tid++;
+    b->next = time_trace_buffers;
+    time_trace_buffers = b;
+    pthread_mutex_unlock(&time_trace_lock);
+    time_trace_self = b;
+    return b;
+}
+
+// Internal helper: appends one finished region to this thread's buffer
+static void time_trace_append(const char *name, uint64_t start, uint64_t end) {
+    time_trace_buffer *b = time_trace_buffer_self();
+    if (!b) return;
+    time_trace_chunk *c = b->tail;
+    size_t n = c ? atomic_load_explicit(&c->count, memory_order_relaxed) : TIME_TRACE_CHUNK;
+    if (n == TIME_TRACE_CHUNK) {
+        time_trace_chunk *fresh = malloc(sizeof(*fresh));
+        if (!fresh) return;
+        atomic_init(&fresh->next, NULL);
+        atomic_init(&fresh->count, 0);
+        if (c) atomic_store_explicit(&c->next, fresh, memory_order_release);
+        else atomic_store_explicit(&b->head, fresh, memory_order_release);
+        b->tail = c = fresh;
+        n = 0;
+    }
+    c->events[n].name = name;
+    c->events[n].start = start;
+    c->events[n].end = end;
+    atomic_store_explicit(&c->count, n + 1, memory_order_release);
+}
+
+// Turns region recording on or off
+void time_trace_enable(int on) {
+    if (on) {
+        // Calibrate now rather than inside the first timed region
+        time_cycles_per_ns();
+        unsigned long long expected = 0;
+        atomic_compare_exchange_strong(&time_trace_epoch, &expected, time_cycles());
+    }
+    atomic_store(&time_trace_on, on != 0);
+}
+
+// Opens a region on the calling thread
+void time_region_begin(const char *name) {
+    int d = time_region_depth++;
+    if (d >= TIME_TRACE_DEPTH) return;
+    int on = atomic_load_explicit(&time_trace_on, memory_order_relaxed);
+    time_region_stack[d].name = name;
+    time_region_stack[d].recording = on;
+    time_region_stack[d].start = on ? time_cycles() : 0;
+}
+
+// Closes the innermost open region on the calling thread
+void time_region_end(void) {
+    if (time_region_depth == 0) return;
+    int d = --time_region_depth;
+    if (d >= TIME_TRACE_DEPTH || !time_region_stack[d].recording) return;
+    time_trace_append(time_region_stack[d].name, time_region_stack[d].start, time_cycles());
+}
+
+// Internal helper: writes s as a JSON string
+static int time_json_string(FILE *f, const char *s) {
+    if (fputc('"', f) == EOF) return -1;
+    for (; *s; s++) {
+        unsigned char ch = (unsigned char)*s;
+        int r;
+        if (ch == '"' || ch == '\\') r = fprintf(f, "\\%c", ch);
+        else if (ch < 0x20) r = fprintf(f, "\\u%04x", ch);
+        else r = fputc(ch, f) == EOF ? -1 : 1;
+        if (r < 0) return -1;
+    }
+    return fputc('"', f) == EOF ? -1 : 0;
+}
+
+// Writes all recorded regions as Chrome trace JSON
+long time_trace_write(FILE *f) {
+    double per_us = time_cycles_per_ns() * 1000.0;
+    uint64_t epoch = atomic_load(&time_trace_epoch);
+    long written = 0;
+    int err = fputs("{\"traceEvents\":[", f) == EOF;
+
+    pthread_mutex_lock(&time_trace_lock);
+    for (time_trace_buffer *b = time_trace_buffers; b && !err; b = b->next) {
+        time_trace_chunk *c = atomic_load_explicit(&b->head, memory_order_acquire);
+        for (; c && !err; c = atomic_load_explicit(&c->next, memory_order_acquire)) {
+            size_t n = atomic_load_explicit(&c->count, memory_order_acquire);
+            for (size_t i = 0; i < n && !err; i++) {
+                const time_trace_event *e = &c->events[i];
+                err = fputs(written ? ",\n{\"name\":" : "\n{\"name\":", f) == EOF ||
+                      time_json_string(f, e->name) != 0 ||
+                      fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                              b->tid, (double)(int64_t)(e->start - epoch) / per_us,
+                              (double)(e->end - e->start) / per_us) < 0;
+                written++;
+            }
+        }
+    }
+    pthread_mutex_unlock(&time_trace_lock);
+
+    if (err || fputs("\n]}\n", f) == EOF) return -1;
+    return written;
+}
+
+// Writes the trace to a file
+long time_trace_save(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+    long written = time_trace_write(f);
+    if (fclose(f) != 0) return -1;
+    return written;
+}
+
+// Frees every recorded region
+void time_trace_clear(void) {
+    pthread_mutex_lock(&time_trace_lock);
+    time_trace_buffer **link = &time_trace_buffers;
+    while (*link) {
+        time_trace_buffer *b = *link;
+        time_trace_chunk *c = atomic_load(&b->head);
+        while (c) {
+            time_trace_chunk *next = atomic_load(&c->next);
+            free(c);
+            c = next;
+        }
+        atomic_store(&b->head, NULL);
+        b->tail = NULL;
+        if (atomic_load(&b->exited)) {
+            *link = b->next;
+            free(b);
+        } else {
+            link = &b->next;
+        }
+    }
+    pthread_mutex_unlock(&time_trace_lock);
+}
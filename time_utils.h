@@ -1,7 +1,9 @@
 #ifndef TIME_UTILS_H
 #define TIME_UTILS_H
 
-#include <ctime> // Include ctime for time_t definition
+#include <time.h> // Include time.h for time_t definition
+#include <stdint.h>
+#include <stdio.h>
 
 // Time utility function prototypes will go here
 
@@ -15,4 +17,126 @@ int get_current_day();
 int get_current_weekday();
 long get_unix_timestamp();
 
+// The current local date and time, broken down
+typedef struct {
+    time_t sec;         // Unix time, whole seconds
+    long nsec;          // nanoseconds past sec
+    int year;           // e.g. 2024
+    int month;          // 1-12
+    int day;            // 1-31
+    int hour;           // 0-23
+    int minute;         // 0-59
+    int second;         // 0-60 (60 only for a leap second)
+    int weekday;        // 0-6, Sunday = 0
+    int yearday;        // 0-365, January 1 = 0
+    int is_dst;         // > 0 during daylight saving time
+    long utc_offset;    // seconds east of UTC
+} time_calendar;
+
+// Fills out with the current local time. The broken-down fields are
+// computed with localtime_r once per second and shared between threads
+// through a lock-free cache, so most calls cost one vDSO clock_gettime
+// plus a few loads. Like localtime_r, the cache does not notice a changed
+// TZ until tzset() is called; the next second picks it up. Returns 0, or
+// -1 if the clock or the time zone conversion fails.
+int time_now_calendar(time_calendar *out);
+
+// Layout flags for time_format, ORed together. The default is local time
+// as strftime "%Y-%m-%d %H:%M:%S", the layout of format_time.
+#define TIME_FORMAT_UTC     0x01    // UTC instead of local time
+#define TIME_FORMAT_T       0x02    // 'T' between date and time, as ISO-8601
+#define TIME_FORMAT_ZONE    0x04    // append "Z" in UTC, else strftime "%z"
+#define TIME_FORMAT_MS      0x10    // append ".mmm"
+#define TIME_FORMAT_US      0x20    // append ".uuuuuu"
+#define TIME_FORMAT_NS      0x30    // append ".nnnnnnnnn"
+
+// Buffer size that fits every layout for years 0 to 9999
+#define TIME_FORMAT_MAX 40
+
+// Formats sec plus nsec nanoseconds into buf as flags describe; the date
+// and time match strftime, followed by truncated sub-second digits. Each
+// thread keeps the formatted date and time of the last second it
+// formatted, so repeated calls within a second only copy it and append
+// digits; a TZ change shows from the next second a thread formats. nsec
+// must be in [0, 999999999]. Returns the length written (not counting the
+// terminating NUL), or -1 if buf is too small, nsec is out of range or
+// the time cannot be converted.
+int time_format(time_t sec, long nsec, int flags, char *buf, size_t buflen);
+
+// time_format for the current time (clock_gettime CLOCK_REALTIME)
+int time_format_now(int flags, char *buf, size_t buflen);
+
+// Nanoseconds on the monotonic clock (CLOCK_MONOTONIC); only differences
+// between two readings are meaningful
+uint64_t time_now_ns(void);
+
+// Reads the cycle counter: RDTSCP (or LFENCE + RDTSC) on x86 CPUs whose
+// TSC ticks at a constant rate in every power state, time_now_ns()
+// everywhere else. Usually cheaper than time_now_ns(), though virtual
+// machines that trap the TSC narrow the gap. Counts are only comparable
+// on the same machine and boot.
+uint64_t time_cycles(void);
+// Counter ticks per nanosecond; 1.0 for the time_now_ns fallback. The
+// first call measures the TSC against the monotonic clock for about 10 ms.
+double time_cycles_per_ns(void);
+// Converts a difference of time_cycles() readings to nanoseconds
+uint64_t time_cycles_to_ns(uint64_t cycles);
+
+// Accumulating stopwatch over time_cycles(); zero-initialize or reset
+typedef struct {
+    uint64_t start;     // time_cycles() at the last start
+    uint64_t elapsed;   // cycles accumulated by completed start/stop pairs
+    int running;
+} time_stopwatch;
+
+void time_stopwatch_reset(time_stopwatch *sw);
+void time_stopwatch_start(time_stopwatch *sw);
+void time_stopwatch_stop(time_stopwatch *sw);
+// Total time so far in nanoseconds, including a running interval
+uint64_t time_stopwatch_ns(const time_stopwatch *sw);
+
+// Internal helper for TIME_STOPWATCH_SCOPE
+static inline void time_stopwatch_scope_end(time_stopwatch **sw) {
+    time_stopwatch_stop(*sw);
+}
+
+// Starts sw (a time_stopwatch *) and stops it when the enclosing block
+// exits, however it exits. Use at most once per block.
+#define TIME_STOPWATCH_SCOPE(sw) \
+    __attribute__((cleanup(time_stopwatch_scope_end))) time_stopwatch *time_scope_sw_ = (sw); \
+    time_stopwatch_start(time_scope_sw_)
+
+// Region recorder: each thread appends named, nested begin/end intervals
+// to its own buffer without locking, and time_trace_write exports every
+// thread's regions as Chrome trace JSON (chrome://tracing, Perfetto).
+// Recording is off until time_trace_enable(1); while off, a begin/end pair
+// costs a few loads. Names must stay valid until the trace is written or
+// cleared (string literals are typical). Regions nest up to 64 deep per
+// thread; deeper ones are not recorded.
+void time_trace_enable(int on);
+void time_region_begin(const char *name);
+void time_region_end(void);
+
+// Internal helper for TIME_REGION
+static inline void time_region_scope_end(int *unused) {
+    (void)unused;
+    time_region_end();
+}
+
+// Records a region named name covering the rest of the enclosing block.
+// Use at most once per block.
+#define TIME_REGION(name) \
+    __attribute__((cleanup(time_region_scope_end))) int time_region_scope_ = (time_region_begin(name), 0)
+
+// Writes the recorded regions of all threads, including exited ones, as a
+// Chrome trace JSON object. Regions still open are left out. Safe while
+// other threads record; their newest regions may be missed. Returns the
+// number of regions written, or -1 on a write error.
+long time_trace_write(FILE *f);
+// time_trace_write to a new file at path
+long time_trace_save(const char *path);
+// Drops all recorded regions and frees their memory. No thread may be
+// recording during the call.
+void time_trace_clear(void);
+
 #endif // TIME_UTILS_H
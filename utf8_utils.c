@@ -0,0 +1,373 @@
+#include "utf8_utils.h"
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Internal helper: checks the sequence at p with avail bytes available.
+// Returns its length if valid, 0 if invalid, or -1 if every available byte
+// is valid so far but the sequence needs more (truncated).
+static int utf8_check_seq(const unsigned char *p, size_t avail) {
+    unsigned c = p[0];
+    int n;
+    unsigned lo = 0x80, hi = 0xbf;
+    if (c < 0x80) return 1;
+    if (c < 0xc2) return 0;
+    if (c < 0xe0) {
+        n = 2;
+    } else if (c < 0xf0) {
+        n = 3;
+        if (c == 0xe0) lo = 0xa0;         // overlong
+        if (c == 0xed) hi = 0x9f;         // surrogates
+    } else if (c < 0xf5) {
+        n = 4;
+        if (c == 0xf0) lo = 0x90;         // overlong
+        if (c == 0xf4) hi = 0x8f;         // above U+10FFFF
+    } else {
+        return 0;
+    }
+    if (avail > 1 && (p[1] < lo || p[1] > hi)) return 0;
+    for (int k = 2; k < n && (size_t)k < avail; k++) {
+        if ((p[k] & 0xc0) != 0x80) return 0;
+    }
+    return avail < (size_t)n ? -1 : n;
+}
+
+// Decodes one code point from s into *cp
+size_t utf8_decode(const char *s, size_t len, uint32_t *cp) {
+    const unsigned char *p = (const unsigned char *)s;
+    if (len == 0) return 0;
+    int n = utf8_check_seq(p, len);
+    if (n <= 0) return 0;
+    switch (n) {
+    case 1: *cp = p[0]; break;
+    case 2: *cp = (uint32_t)(p[0] & 0x1f) << 6 | (p[1] & 0x3f); break;
+    case 3: *cp = (uint32_t)(p[0] & 0x0f) << 12 | (uint32_t)(p[1] & 0x3f) << 6 | (p[2] & 0x3f); break;
+    default:
+        *cp = (uint32_t)(p[0] & 0x07) << 18 | (uint32_t)(p[1] & 0x3f) << 12 |
+              (uint32_t)(p[2] & 0x3f) << 6 | (p[3] & 0x3f);
+    }
+    return (size_t)n;
+}
+
+// Internal helper: scalar validation of s[i..len). Returns the offset of the
+// first invalid sequence, or len; a truncated sequence at the very end is
+// not an error but its start is stored in *tail (len if there is none).
+static size_t utf8_scan_scalar(const unsigned char *s, size_t i, size_t len, size_t *tail) {
+    *tail = len;
+    while (i < len) {
+        // Eight ASCII bytes at a time
+        if (i + 8 <= len) {
+            uint64_t w;
+            memcpy(&w, s + i, 8);
+            if (!(w & 0x8080808080808080ULL)) {
+                i += 8;
+                continue;
+            }
+        }
+        if (s[i] < 0x80) {
+            i++;
+            continue;
+        }
+        int n = utf8_check_seq(s + i, len - i);
+        if (n == 0) return i;
+        if (n < 0) {
+            *tail = i;
+            return len;
+        }
+        i += (size_t)n;
+    }
+    return len;
+}
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+// Vectorized validation after Keiser and Lemire, "Validating UTF-8 In Less
+// Than One Instruction Per Byte" (the algorithm simdjson uses). Three nibble
+// lookups classify every (previous byte, current byte) pair into error
+// bits; continuation bytes required by 3- and 4-byte leads two or three
+// positions back cancel the two-continuations bit.
+#define U8_TOO_SHORT      (1 << 0)
+#define U8_TOO_LONG       (1 << 1)
+#define U8_OVERLONG_3     (1 << 2)
+#define U8_TOO_LARGE      (1 << 3)
+#define U8_SURROGATE      (1 << 4)
+#define U8_OVERLONG_2     (1 << 5)
+#define U8_TOO_LARGE_1000 (1 << 6)
+#define U8_OVERLONG_4     (1 << 6)
+#define U8_TWO_CONTS      (1 << 7)
+#define U8_CARRY          (U8_TOO_SHORT | U8_TOO_LONG | U8_TWO_CONTS)
+#define U8_LARGE          (U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000)
+
+static const unsigned char u8_byte1_high[16] = {
+    U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG,
+    U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG,
+    U8_TWO_CONTS, U8_TWO_CONTS, U8_TWO_CONTS, U8_TWO_CONTS,
+    U8_TOO_SHORT | U8_OVERLONG_2,
+    U8_TOO_SHORT,
+    U8_TOO_SHORT | U8_OVERLONG_3 | U8_SURROGATE,
+    U8_TOO_SHORT | U8_TOO_LARGE | U8_TOO_LARGE_1000 | U8_OVERLONG_4,
+};
+
+static const unsigned char u8_byte1_low[16] = {
+    U8_CARRY | U8_OVERLONG_3 | U8_OVERLONG_2 | U8_OVERLONG_4,
+    U8_CARRY | U8_OVERLONG_2,
+    U8_CARRY,
+    U8_CARRY,
+    U8_CARRY | U8_TOO_LARGE,
+    U8_LARGE, U8_LARGE, U8_LARGE,
+    U8_LARGE, U8_LARGE, U8_LARGE, U8_LARGE, U8_LARGE,
+    U8_LARGE | U8_SURROGATE,
+    U8_LARGE, U8_LARGE,
+};
+
+static const unsigned char u8_byte2_high[16] = {
+    U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT,
+    U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT,
+    U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_OVERLONG_3 | U8_TOO_LARGE_1000 | U8_OVERLONG_4,
+    U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_OVERLONG_3 | U8_TOO_LARGE,
+    U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_SURROGATE | U8_TOO_LARGE,
+    U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_SURROGATE | U8_TOO_LARGE,
+    U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT,
+};
+
+// The last block byte may not start a sequence needing more bytes than remain
+static const unsigned char u8_incomplete_max[32] = {
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1,
+};
+
+#if defined(__AVX2__)
+typedef __m256i u8vec;
+#define U8_VEC 32
+#define u8_load(p) _mm256_loadu_si256((const __m256i *)(p))
+#define u8_table(t) _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(t)))
+#define u8_lookup(t, idx) _mm256_shuffle_epi8((t), (idx))
+#define u8_and _mm256_and_si256
+#define u8_or _mm256_or_si256
+#define u8_xor _mm256_xor_si256
+#define u8_subs _mm256_subs_epu8
+#define u8_set1(c) _mm256_set1_epi8((char)(c))
+#define u8_zero() _mm256_setzero_si256()
+#define u8_shr4(v) _mm256_and_si256(_mm256_srli_epi16((v), 4), u8_set1(0x0f))
+#define u8_prev(in, prev, n) \
+    _mm256_alignr_epi8((in), _mm256_permute2x128_si256((prev), (in), 0x21), 16 - (n))
+#define u8_is_ascii(v) (_mm256_movemask_epi8(v) == 0)
+#define u8_any(v) (!_mm256_testz_si256((v), (v)))
+#else
+typedef __m128i u8vec;
+#define U8_VEC 16
+#define u8_load(p) _mm_loadu_si128((const __m128i *)(p))
+#define u8_table(t) _mm_loadu_si128((const __m128i *)(t))
+#define u8_lookup(t, idx) _mm_shuffle_epi8((t), (idx))
+#define u8_and _mm_and_si128
+#define u8_or _mm_or_si128
+#define u8_xor _mm_xor_si128
+#define u8_subs _mm_subs_epu8
+#define u8_set1(c) _mm_set1_epi8((char)(c))
+#define u8_zero() _mm_setzero_si128()
+#define u8_shr4(v) _mm_and_si128(_mm_srli_epi16((v), 4), u8_set1(0x0f))
+#define u8_prev(in, prev, n) _mm_alignr_epi8((in), (prev), 16 - (n))
+#define u8_is_ascii(v) (_mm_movemask_epi8(v) == 0)
+#define u8_any(v) (_mm_movemask_epi8(_mm_cmpeq_epi8((v), _mm_setzero_si128())) != 0xffff)
+#endif
+
+// Internal helper: vectorized pass over whole blocks. Returns the offset of
+// the first block that failed, or of the first byte not processed.
+static size_t utf8_scan_simd(const unsigned char *s, size_t len) {
+    const u8vec t1h = u8_table(u8_byte1_high), t1l = u8_table(u8_byte1_low);
+    const u8vec t2h = u8_table(u8_byte2_high);
+    const u8vec max = u8_load(u8_incomplete_max + 32 - U8_VEC);
+    const u8vec nib = u8_set1(0x0f);
+    u8vec prev = u8_zero(), prev_incomplete = u8_zero();
+    size_t i = 0;
+    for (; i + U8_VEC <= len; i += U8_VEC) {
+        u8vec in = u8_load(s + i);
+        u8vec err;
+        if (u8_is_ascii(in)) {
+            err = prev_incomplete;
+        } else {
+            u8vec prev1 = u8_prev(in, prev, 1);
+            u8vec sc = u8_and(u8_and(u8_lookup(t1h, u8_shr4(prev1)),
+                                     u8_lookup(t1l, u8_and(prev1, nib))),
+                              u8_lookup(t2h, u8_shr4(in)));
+            u8vec third = u8_subs(u8_prev(in, prev, 2), u8_set1(0xe0 - 0x80));
+            u8vec fourth = u8_subs(u8_prev(in, prev, 3), u8_set1(0xf0 - 0x80));
+            u8vec must23 = u8_and(u8_or(third, fourth), u8_set1(0x80));
+            err = u8_xor(must23, sc);
+            prev_incomplete = u8_subs(in, max);
+        }
+        if (u8_any(err)) break;
+        prev = in;
+    }
+    return i;
+}
+#endif
+
+// Internal helper: full validation with the truncated-tail convention of
+// utf8_scan_scalar
+static size_t utf8_scan(const unsigned char *s, size_t len, size_t *tail) {
+    size_t i = 0;
+#if defined(__AVX2__) || defined(__SSSE3__)
+    i = utf8_scan_simd(s, len);
+    // Step back to the lead byte of a sequence running into byte i; the
+    // scalar pass then pinpoints the first error or finishes the tail
+    for (size_t k = 1; k <= 3 && k <= i; k++) {
+        unsigned char c = s[i - k];
+        if (c < 0x80) break;
+        if (c >= 0xc0) {
+            size_t need = c >= 0xf0 ? 4 : c >= 0xe0 ? 3 : 2;
+            if (need > k) i -= k;
+            break;
+        }
+    }
+#endif
+    return utf8_scan_scalar(s, i, len, tail);
+}
+
+// Returns 1 if the len bytes of s are valid UTF-8, 0 otherwise
+int utf8_is_valid(const char *s, size_t len) {
+    return utf8_find_invalid(s, len) == len;
+}
+
+// Returns the offset of the first invalid or truncated sequence, or len
+size_t utf8_find_invalid(const char *s, size_t len) {
+    size_t tail;
+    size_t err = utf8_scan((const unsigned char *)s, len, &tail);
+    return err < len ? err : tail;
+}
+
+// Counts the bytes that are not continuation bytes (0x80-0xbf)
+size_t utf8_count_codepoints(const char *s, size_t len) {
+    size_t count = 0, i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+        __m256i lead = _mm256_cmpgt_epi8(v, _mm256_set1_epi8((char)0xbf));
+        count += (size_t)__builtin_popcount((unsigned)_mm256_movemask_epi8(lead));
+    }
+#elif defined(__SSE2__)
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+        __m128i lead = _mm_cmpgt_epi8(v, _mm_set1_epi8((char)0xbf));
+        count += (size_t)__builtin_popcount((unsigned)_mm_movemask_epi8(lead));
+    }
+#endif
+    for (; i < len; i++) count += (signed char)s[i] > (signed char)0xbf;
+    return count;
+}
+
+// Ranges of zero-width code points (combining marks and format characters)
+static const uint32_t utf8_zero_width[][2] = {
+    {0x0300, 0x036f}, {0x0483, 0x0489}, {0x0591, 0x05bd}, {0x0610, 0x061a},
+    {0x064b, 0x065f}, {0x0e31, 0x0e31}, {0x0e34, 0x0e3a}, {0x1ab0, 0x1aff},
+    {0x1dc0, 0x1dff}, {0x200b, 0x200f}, {0x202a, 0x202e}, {0x2060, 0x2064},
+    {0x20d0, 0x20ff}, {0xfe00, 0xfe0f}, {0xfe20, 0xfe2f}, {0xfeff, 0xfeff},
+    {0xe0100, 0xe01ef},
+};
+
+// Ranges of East Asian wide/fullwidth code points and emoji
+static const uint32_t utf8_wide[][2] = {
+    {0x1100, 0x115f}, {0x231a, 0x231b}, {0x2329, 0x232a}, {0x23e9, 0x23ec},
+    {0x2614, 0x2615}, {0x2e80, 0x303e}, {0x3041, 0x33ff}, {0x3400, 0x4dbf},
+    {0x4e00, 0x9fff}, {0xa000, 0xa4cf}, {0xa960, 0xa97f}, {0xac00, 0xd7a3},
+    {0xf900, 0xfaff}, {0xfe10, 0xfe19}, {0xfe30, 0xfe6f}, {0xff00, 0xff60},
+    {0xffe0, 0xffe6}, {0x1f300, 0x1f64f}, {0x1f900, 0x1f9ff}, {0x20000, 0x3fffd},
+};
+
+// Internal helper: 1 if cp falls in one of n sorted ranges
+static int utf8_in_ranges(uint32_t cp, const uint32_t (*r)[2], size_t n) {
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (cp > r[mid][1]) lo = mid + 1;
+        else if (cp < r[mid][0]) hi = mid;
+        else return 1;
+    }
+    return 0;
+}
+
+// Returns the terminal column width of a code point
+int utf8_codepoint_width(uint32_t cp) {
+    if (cp >= 0x20 && cp < 0x7f) return 1;
+    if (cp < 0x20 || (cp >= 0x7f && cp < 0xa0)) return 0;
+    if (utf8_in_ranges(cp, utf8_zero_width, sizeof(utf8_zero_width) / sizeof(utf8_zero_width[0]))) {
+        return 0;
+    }
+    if (utf8_in_ranges(cp, utf8_wide, sizeof(utf8_wide) / sizeof(utf8_wide[0]))) return 2;
+    return 1;
+}
+
+// Returns the terminal column width of valid UTF-8 text; an invalid byte is
+// counted as one column and skipped
+size_t utf8_display_width(const char *s, size_t len) {
+    const unsigned char *p = (const unsigned char *)s;
+    size_t width = 0, i = 0;
+    while (i < len) {
+        if (p[i] >= 0x20 && p[i] < 0x7f) {
+            width++;
+            i++;
+            continue;
+        }
+        uint32_t cp;
+        size_t n = utf8_decode(s + i, len - i, &cp);
+        if (n == 0) {
+            width++;
+            i++;
+            continue;
+        }
+        width += (size_t)utf8_codepoint_width(cp);
+        i += n;
+    }
+    return width;
+}
+
+// Starts validating a new stream
+void utf8_validator_init(utf8_validator *v) {
+    v->npending = 0;
+    v->offset = 0;
+    v->failed = 0;
+    v->error_offset = 0;
+}
+
+// Internal helper: records the first error
+static int utf8_validator_fail(utf8_validator *v, size_t offset) {
+    v->failed = 1;
+    v->error_offset = offset;
+    return -1;
+}
+
+// Feeds the next chunk
+int utf8_validator_update(utf8_validator *v, const char *data, size_t len) {
+    const unsigned char *p = (const unsigned char *)data;
+    size_t i = 0;
+    if (v->failed) return -1;
+    // Complete a sequence carried over from the previous chunk
+    while (v->npending && i < len) {
+        v->pending[v->npending++] = p[i++];
+        int n = utf8_check_seq(v->pending, (size_t)v->npending);
+        if (n == 0) return utf8_validator_fail(v, v->offset - (size_t)(v->npending - (int)i));
+        if (n > 0) v->npending = 0;
+    }
+    if (v->npending) {
+        v->offset += len;
+        return 0;
+    }
+    size_t tail;
+    size_t err = utf8_scan(p + i, len - i, &tail);
+    if (err < len - i) return utf8_validator_fail(v, v->offset + i + err);
+    for (size_t k = i + tail; k < len; k++) v->pending[v->npending++] = p[k];
+    v->offset += len;
+    return 0;
+}
+
+// Ends the stream
+int utf8_validator_finish(utf8_validator *v) {
+    if (v->failed) return -1;
+    if (v->npending) return utf8_validator_fail(v, v->offset - (size_t)v->npending);
+    return 0;
+}
@@ -0,0 +1,51 @@
+#ifndef UTF8_UTILS_H
+#define UTF8_UTILS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Incremental validator for UTF-8 arriving in chunks. A sequence split
+// across two chunks is carried over in pending.
+typedef struct {
+    unsigned char pending[4];
+    int npending;
+    size_t offset;          // bytes consumed so far
+    int failed;             // 1 once an invalid sequence has been seen
+    size_t error_offset;    // offset of the first invalid sequence
+} utf8_validator;
+
+// Decodes one code point from s into *cp, returns the bytes consumed or 0 if
+// the sequence at s is invalid or truncated
+size_t utf8_decode(const char *s, size_t len, uint32_t *cp);
+
+// Returns 1 if the len bytes of s are valid UTF-8, 0 otherwise
+int utf8_is_valid(const char *s, size_t len);
+
+// Returns the offset of the first invalid (or truncated) sequence in s,
+// or len if all of s is valid UTF-8
+size_t utf8_find_invalid(const char *s, size_t len);
+
+// Counts the code points in s (the bytes that are not continuation bytes);
+// s is assumed to be valid UTF-8
+size_t utf8_count_codepoints(const char *s, size_t len);
+
+// Returns the terminal column width of a code point: 0 for combining marks,
+// zero-width and control characters, 2 for East Asian wide and fullwidth
+// characters and emoji, 1 otherwise
+int utf8_codepoint_width(uint32_t cp);
+
+// Returns the terminal column width of valid UTF-8 text
+size_t utf8_display_width(const char *s, size_t len);
+
+// Starts validating a new stream
+void utf8_validator_init(utf8_validator *v);
+
+// Feeds the next chunk, returns 0 if the stream is still valid, -1 if an
+// invalid sequence has been seen (its offset is in v->error_offset)
+int utf8_validator_update(utf8_validator *v, const char *data, size_t len);
+
+// Ends the stream, returns 0 if it was valid UTF-8, -1 otherwise; a
+// sequence left unfinished at the end counts as invalid
+int utf8_validator_finish(utf8_validator *v);
+
+#endif // UTF8_UTILS_H